@@ -0,0 +1,111 @@
+/** @file
+  Dump the SD/MMC block I/O trace ring as CSV.
+
+  The ring is published by SdMmcDxe when PcdBlockIoTraceEnable is set.
+  Redirect the output to a file from the shell, e.g.
+    BlockIoTraceDump.efi > fs0:\biotrace.csv
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Guid/BlockIoTrace.h>
+
+STATIC CONST CHAR16 *mOpNames[] = {
+    L"read",
+    L"write",
+    L"flush",
+    L"bread"
+};
+
+STATIC
+UINT64
+TicksToMicroseconds(
+    IN UINT64   Ticks,
+    IN UINT64   Frequency
+)
+{
+    UINT64 Remainder;
+    UINT64 Seconds;
+
+    // Split to avoid overflowing Ticks * 1000000 on long uptimes
+    Seconds = DivU64x64Remainder(Ticks, Frequency, &Remainder);
+    return MultU64x32(Seconds, 1000000) +
+        DivU64x64Remainder(MultU64x32(Remainder, 1000000), Frequency, NULL);
+}
+
+EFI_STATUS
+EFIAPI
+BlockIoTraceDumpEntry(
+    IN EFI_HANDLE           ImageHandle,
+    IN EFI_SYSTEM_TABLE     *SystemTable
+)
+{
+    EFI_STATUS Status;
+    BLOCK_IO_TRACE_HEADER *Header;
+    BLOCK_IO_TRACE_RECORD *Records;
+    BLOCK_IO_TRACE_RECORD Record;
+    UINT32 Head;
+    UINT32 First;
+    UINT32 Index;
+    UINT64 StartUs;
+    UINT64 EndUs;
+
+    Status = EfiGetSystemConfigurationTable(&gNintendoSwitchBlockIoTraceTableGuid, (VOID **) &Header);
+    if (EFI_ERROR(Status))
+    {
+        Print(L"Block I/O trace is not enabled in this firmware\n");
+        return EFI_NOT_FOUND;
+    }
+
+    if (Header->Signature != BLOCK_IO_TRACE_SIGNATURE ||
+        Header->Version != BLOCK_IO_TRACE_VERSION ||
+        Header->RecordSize != sizeof(BLOCK_IO_TRACE_RECORD) ||
+        Header->TimerFrequency == 0)
+    {
+        Print(L"Unrecognized block I/O trace table\n");
+        return EFI_INCOMPATIBLE_VERSION;
+    }
+
+    Records = BLOCK_IO_TRACE_RECORDS(Header);
+    Head = Header->Head;
+    First = (Head > Header->RecordCount) ? Head - Header->RecordCount : 0;
+
+    Print(L"seq,op,lba,blocks,start_us,end_us,duration_us,retries,bounce,error\n");
+
+    for (Index = First; Index != Head; Index++)
+    {
+        // Take a copy and drop it if the slot got recycled in the meantime
+        Record = Records[Index & (Header->RecordCount - 1)];
+        if (Record.Sequence != Index + 1)
+        {
+            continue;
+        }
+
+        StartUs = TicksToMicroseconds(Record.StartTicks, Header->TimerFrequency);
+        EndUs = TicksToMicroseconds(Record.EndTicks, Header->TimerFrequency);
+
+        Print(
+            L"%u,%s,%lu,%u,%lu,%lu,%lu,%u,%u,%u\n",
+            Index,
+            (Record.Op < sizeof(mOpNames) / sizeof(mOpNames[0])) ? mOpNames[Record.Op] : L"?",
+            Record.Lba,
+            Record.Blocks,
+            StartUs,
+            EndUs,
+            EndUs - StartUs,
+            Record.Retries,
+            (Record.Flags & BLOCK_IO_TRACE_FLAG_BOUNCE) ? 1 : 0,
+            (Record.Flags & BLOCK_IO_TRACE_FLAG_ERROR) ? 1 : 0
+        );
+    }
+
+    if (Head > Header->RecordCount)
+    {
+        Print(L"# %u older records were overwritten\n", Head - Header->RecordCount);
+    }
+
+    return EFI_SUCCESS;
+}
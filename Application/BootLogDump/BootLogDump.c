@@ -0,0 +1,249 @@
+/** @file
+  Print the persistent boot log.
+
+  The log is published by BootLogDxe when PcdBootLogEnable is set and keeps
+  the output of earlier boots across warm resets. By default only the
+  current boot is printed, pass -a to print every boot still in the log.
+  Redirect the output to a file from the shell, e.g.
+    BootLogDump.efi -a > fs0:\bootlog.txt
+
+  Binary records (PcdDebugBinaryLog) are formatted here as long as the
+  module that wrote them is still loaded. The rest can be decoded offline
+  with Tools/BootLogDecode.py from a copy of the log and the build output.
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/LoadedImage.h>
+#include <Guid/BootLog.h>
+
+STATIC
+BOOLEAN
+WantAllBoots(
+    IN EFI_HANDLE   ImageHandle
+)
+{
+    EFI_STATUS Status;
+    EFI_LOADED_IMAGE_PROTOCOL *LoadedImage;
+    CHAR16 *Options;
+
+    Status = gBS->HandleProtocol(ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **) &LoadedImage);
+    if (EFI_ERROR(Status) || LoadedImage->LoadOptions == NULL)
+    {
+        return FALSE;
+    }
+
+    Options = LoadedImage->LoadOptions;
+    return StrStr(Options, L"-a") != NULL;
+}
+
+typedef struct {
+    UINTN   Base;
+    UINTN   Size;
+} IMAGE_RANGE;
+
+#define MAX_MODULES 256
+
+STATIC IMAGE_RANGE *mImages = NULL;
+STATIC UINTN mImageCount = 0;
+
+STATIC
+VOID
+CollectLoadedImages(
+    VOID
+)
+{
+    EFI_STATUS Status;
+    EFI_HANDLE *Handles;
+    UINTN HandleCount;
+    UINTN Index;
+    EFI_LOADED_IMAGE_PROTOCOL *LoadedImage;
+
+    Status = gBS->LocateHandleBuffer(ByProtocol, &gEfiLoadedImageProtocolGuid, NULL, &HandleCount, &Handles);
+    if (EFI_ERROR(Status))
+    {
+        return;
+    }
+
+    mImages = AllocatePool(HandleCount * sizeof(IMAGE_RANGE));
+    if (mImages != NULL)
+    {
+        for (Index = 0; Index < HandleCount; Index++)
+        {
+            Status = gBS->HandleProtocol(Handles[Index], &gEfiLoadedImageProtocolGuid, (VOID **) &LoadedImage);
+            if (!EFI_ERROR(Status))
+            {
+                mImages[mImageCount].Base = (UINTN) LoadedImage->ImageBase;
+                mImages[mImageCount].Size = (UINTN) LoadedImage->ImageSize;
+                mImageCount++;
+            }
+        }
+    }
+
+    FreePool(Handles);
+}
+
+/*
+ * Function: FormatIsLoaded
+ * Flow    : A format string can only be dereferenced while the image that
+ *           logged it is still in memory, which is checked against the
+ *           loaded image list.
+ */
+STATIC
+BOOLEAN
+FormatIsLoaded(
+    IN UINT64   Format
+)
+{
+    UINTN Index;
+
+    for (Index = 0; Index < mImageCount; Index++)
+    {
+        if (Format >= mImages[Index].Base &&
+            Format < mImages[Index].Base + mImages[Index].Size)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+STATIC
+UINTN
+FormatBinaryRecord(
+    IN  BOOT_LOG_HEADER     *Log,
+    IN  BOOT_LOG_RECORD     *Record,
+    IN  CONST CHAR8         *ModuleName,
+    OUT CHAR8               *Text,
+    IN  UINTN               TextSize
+)
+{
+    BOOT_LOG_BINARY *Binary = (BOOT_LOG_BINARY *) (Record + 1);
+
+    if (Record->Boot == Log->BootCount && FormatIsLoaded(Binary->Format))
+    {
+        return AsciiBSPrint(Text, TextSize, (CONST CHAR8 *) (UINTN) Binary->Format, (BASE_LIST) (Binary + 1));
+    }
+
+    return AsciiSPrint(
+        Text,
+        TextSize,
+        "<%a: format 0x%lx, %d arguments, decode offline>\n",
+        (ModuleName != NULL) ? ModuleName : "unknown module",
+        Binary->Format,
+        Binary->ArgumentCount
+    );
+}
+
+EFI_STATUS
+EFIAPI
+BootLogDumpEntry(
+    IN EFI_HANDLE           ImageHandle,
+    IN EFI_SYSTEM_TABLE     *SystemTable
+)
+{
+    EFI_STATUS Status;
+    BOOT_LOG_HEADER *Log;
+    BOOT_LOG_RECORD *Record;
+    CHAR8 Text[512];
+    BOOLEAN AllBoots;
+    UINT32 Offset;
+    UINT32 Length;
+    UINT64 Frequency;
+    UINT64 Seconds;
+    UINT64 Remainder;
+    CONST CHAR8 *ModuleNames[MAX_MODULES];
+    UINT32 ModuleBoot;
+
+    Status = EfiGetSystemConfigurationTable(&gNintendoSwitchBootLogTableGuid, (VOID **) &Log);
+    if (EFI_ERROR(Status))
+    {
+        Print(L"Boot log is not enabled in this firmware\n");
+        return EFI_NOT_FOUND;
+    }
+
+    if (Log->Signature != BOOT_LOG_SIGNATURE ||
+        Log->Version != BOOT_LOG_VERSION ||
+        Log->HeaderSize != sizeof(BOOT_LOG_HEADER))
+    {
+        Print(L"Unrecognized boot log table\n");
+        return EFI_INCOMPATIBLE_VERSION;
+    }
+
+    if (!Log->Used)
+    {
+        return EFI_SUCCESS;
+    }
+
+    AllBoots = WantAllBoots(ImageHandle);
+    Frequency = (Log->TimerFrequency != 0) ? Log->TimerFrequency : 1;
+    CollectLoadedImages();
+
+    ZeroMem(ModuleNames, sizeof(ModuleNames));
+    ModuleBoot = MAX_UINT32;
+
+    Offset = Log->First;
+    do
+    {
+        Record = BOOT_LOG_RECORD_AT(Log, Offset);
+
+        // Module indices start over with every boot
+        if (Record->Length != 0 && Record->Boot != ModuleBoot)
+        {
+            ZeroMem(ModuleNames, sizeof(ModuleNames));
+            ModuleBoot = Record->Boot;
+        }
+
+        if (Record->Length != 0 && Record->Type == BOOT_LOG_TYPE_MODULE)
+        {
+            if (Record->Module < MAX_MODULES)
+            {
+                ModuleNames[Record->Module] = (CONST CHAR8 *) ((BOOT_LOG_MODULE *) (Record + 1) + 1);
+            }
+        }
+        else if (Record->Length != 0 && (AllBoots || Record->Boot == Log->BootCount))
+        {
+            if (Record->Type == BOOT_LOG_TYPE_BINARY)
+            {
+                FormatBinaryRecord(
+                    Log,
+                    Record,
+                    (Record->Module < MAX_MODULES) ? ModuleNames[Record->Module] : NULL,
+                    Text,
+                    sizeof(Text)
+                );
+            }
+            else
+            {
+                Length = MIN(Record->TextLength, sizeof(Text) - 1);
+                CopyMem(Text, Record + 1, Length);
+                Text[Length] = '\0';
+            }
+
+            Seconds = DivU64x64Remainder(Record->Timestamp, Frequency, &Remainder);
+            Print(
+                L"[%u %lu.%06lu] %a",
+                Record->Boot,
+                Seconds,
+                DivU64x64Remainder(MultU64x32(Remainder, 1000000), Frequency, NULL),
+                Text
+            );
+        }
+
+        Offset = BOOT_LOG_NEXT_OFFSET(Log, Offset);
+    } while (Offset != Log->Next);
+
+    if (mImages != NULL)
+    {
+        FreePool(mImages);
+    }
+
+    return EFI_SUCCESS;
+}
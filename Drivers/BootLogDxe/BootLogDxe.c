@@ -0,0 +1,278 @@
+/* BootLogDxe: Publish the persistent boot log as a configuration table */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Protocol/VariableArch.h>
+#include <Guid/BootLog.h>
+
+// 100ns units, a change made in the shell applies within a second
+#define BOOT_LOG_LEVEL_POLL_PERIOD          10000000
+
+#define BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE    2048
+
+STATIC VOID *mVariableRegistration;
+STATIC EFI_EVENT mLevelPollTimer;
+
+STATIC UINT8 mLevelData[BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE];
+STATIC UINT8 mLastLevelData[BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE];
+STATIC UINTN mLevelDataSize;
+STATIC BOOLEAN mLevelDataTooLarge;
+
+STATIC
+BOOLEAN
+IsLevelSeparator(
+    IN CHAR8    Char
+)
+{
+    return Char == ' ' || Char == ',' || Char == ';' || Char == '\t' ||
+        Char == '\r' || Char == '\n';
+}
+
+/*
+ * Function: ParseDebugLevels
+ * Flow    : Split the variable into Name=Level pairs. Level is decimal or
+ *           0x prefixed hex, malformed pairs are skipped.
+ */
+STATIC
+UINT32
+ParseDebugLevels(
+    IN  CHAR8                   *Text,
+    OUT BOOT_LOG_LEVEL_ENTRY    *Entries
+)
+{
+    UINT32 Count = 0;
+    CHAR8 *Name;
+    CHAR8 *Value;
+    UINTN NameLength;
+
+    while (*Text != '\0' && Count < BOOT_LOG_LEVEL_MAX_ENTRIES)
+    {
+        while (IsLevelSeparator(*Text)) Text++;
+        if (*Text == '\0') break;
+
+        Name = Text;
+        while (*Text != '\0' && *Text != '=' && !IsLevelSeparator(*Text)) Text++;
+        NameLength = Text - Name;
+        if (*Text != '=')
+        {
+            continue;
+        }
+
+        Value = ++Text;
+        while (*Text != '\0' && !IsLevelSeparator(*Text)) Text++;
+        if (*Text != '\0') *Text++ = '\0';
+
+        if (NameLength == 0 || NameLength >= BOOT_LOG_LEVEL_NAME_LENGTH || *Value == '\0')
+        {
+            continue;
+        }
+
+        ZeroMem(&Entries[Count], sizeof(BOOT_LOG_LEVEL_ENTRY));
+        CopyMem(Entries[Count].Name, Name, NameLength);
+        Entries[Count].ErrorLevel = (UINT32) ((Value[0] == '0' && (Value[1] == 'x' || Value[1] == 'X')) ?
+            AsciiStrHexToUintn(Value) : AsciiStrDecimalToUintn(Value));
+        Count++;
+    }
+
+    return Count;
+}
+
+/*
+ * Function: PublishDebugLevels
+ * Flow    : The table is placed in reserved memory because runtime drivers
+ *           keep consulting it, and the generation is bumped last so the
+ *           debug library of every module picks it up on its next DEBUG().
+ *           A replaced table is not freed, a module interrupted by the
+ *           timer may still be walking it.
+ */
+STATIC
+VOID
+PublishDebugLevels(
+    IN CHAR8    *Text
+)
+{
+    BOOT_LOG_HEADER *Log = (BOOT_LOG_HEADER *) (UINTN) FixedPcdGet64(PcdBootLogBase);
+    BOOT_LOG_LEVEL_TABLE *Table;
+
+    Table = AllocateReservedPool(sizeof(BOOT_LOG_LEVEL_TABLE) + BOOT_LOG_LEVEL_MAX_ENTRIES * sizeof(BOOT_LOG_LEVEL_ENTRY));
+    if (Table == NULL)
+    {
+        return;
+    }
+
+    Table->Count = ParseDebugLevels(Text, (BOOT_LOG_LEVEL_ENTRY *) (Table + 1));
+    Table->Reserved = 0;
+
+    Log->LevelTable = (UINT64) (UINTN) Table;
+    MemoryFence();
+    Log->LevelGeneration++;
+
+    DEBUG((EFI_D_INFO, "BootLogDxe: %d per-module debug levels\n", Table->Count));
+}
+
+/*
+ * Function: PublishDefaultDebugLevels
+ * Flow    : PcdDebugModuleLevels applies from the start of DXE and whenever
+ *           the variable is deleted again.
+ */
+STATIC
+VOID
+PublishDefaultDebugLevels(VOID)
+{
+    CHAR8 Text[BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE + 1];
+
+    AsciiStrnCpyS(Text, sizeof(Text), (CHAR8 *) FixedPcdGetPtr(PcdDebugModuleLevels), sizeof(Text) - 1);
+    PublishDebugLevels(Text);
+}
+
+/*
+ * Function: CheckDebugLevels
+ * Flow    : EmuVariableRuntimeDxe keeps the variable in memory only, so it
+ *           can appear at any time from the shell. Poll it and rebuild the
+ *           table whenever the contents differ from the last poll.
+ */
+STATIC
+VOID
+EFIAPI
+CheckDebugLevels(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    EFI_STATUS Status;
+    CHAR8 Text[BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE + 1];
+    UINTN DataSize;
+    UINTN Index;
+
+    DataSize = sizeof(mLevelData);
+    Status = gRT->GetVariable(BOOT_LOG_LEVEL_VARIABLE, &gNintendoSwitchDebugLevelsVariableGuid, NULL, &DataSize, mLevelData);
+    if (EFI_ERROR(Status))
+    {
+        if (Status == EFI_BUFFER_TOO_SMALL && !mLevelDataTooLarge)
+        {
+            DEBUG((EFI_D_ERROR, "BootLogDxe: DebugLevels is larger than %d bytes\n", BOOT_LOG_LEVEL_VARIABLE_MAX_SIZE));
+        }
+        mLevelDataTooLarge = (Status == EFI_BUFFER_TOO_SMALL);
+
+        if (mLevelDataSize != 0)
+        {
+            mLevelDataSize = 0;
+            PublishDefaultDebugLevels();
+        }
+        return;
+    }
+    mLevelDataTooLarge = FALSE;
+
+    if (DataSize == mLevelDataSize && CompareMem(mLevelData, mLastLevelData, DataSize) == 0)
+    {
+        return;
+    }
+    CopyMem(mLastLevelData, mLevelData, DataSize);
+    mLevelDataSize = DataSize;
+
+    // Accept both what "setvar ... =\"text\"" and "=L\"text\"" store
+    if (DataSize >= 2 && (DataSize % 2) == 0 && mLevelData[1] == 0)
+    {
+        for (Index = 0; Index < DataSize / 2 && mLevelData[Index * 2] != 0; Index++)
+        {
+            Text[Index] = (CHAR8) mLevelData[Index * 2];
+        }
+    }
+    else
+    {
+        for (Index = 0; Index < DataSize && mLevelData[Index] != 0; Index++)
+        {
+            Text[Index] = (CHAR8) mLevelData[Index];
+        }
+    }
+    Text[Index] = '\0';
+
+    PublishDebugLevels(Text);
+}
+
+/*
+ * Function: StartDebugLevelPoll
+ * Flow    : Runs once the variable services are up. The timer stops by
+ *           itself at ExitBootServices, the last table stays in effect for
+ *           the runtime drivers.
+ */
+STATIC
+VOID
+EFIAPI
+StartDebugLevelPoll(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    EFI_STATUS Status;
+    VOID *Protocol;
+
+    Status = gBS->LocateProtocol(&gEfiVariableArchProtocolGuid, NULL, &Protocol);
+    if (EFI_ERROR(Status))
+    {
+        return;
+    }
+    gBS->CloseEvent(Event);
+
+    CheckDebugLevels(NULL, NULL);
+
+    Status = gBS->CreateEvent(
+        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        CheckDebugLevels,
+        NULL,
+        &mLevelPollTimer
+    );
+    if (!EFI_ERROR(Status))
+    {
+        gBS->SetTimer(mLevelPollTimer, TimerPeriodic, BOOT_LOG_LEVEL_POLL_PERIOD);
+    }
+}
+
+EFI_STATUS
+EFIAPI
+BootLogDxeInitialize
+(
+    IN EFI_HANDLE         ImageHandle,
+    IN EFI_SYSTEM_TABLE   *SystemTable
+)
+{
+    BOOT_LOG_HEADER *Log = (BOOT_LOG_HEADER *) (UINTN) FixedPcdGet64(PcdBootLogBase);
+
+    if (!FeaturePcdGet(PcdBootLogEnable))
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    /* The header is set up in SEC, nothing to publish if that did not happen */
+    if (Log->Signature != BOOT_LOG_SIGNATURE || Log->Version != BOOT_LOG_VERSION)
+    {
+        DEBUG((EFI_D_ERROR, "BootLogDxe: No boot log at 0x%p\n", Log));
+        return EFI_NOT_FOUND;
+    }
+
+    DEBUG((EFI_D_INFO, "BootLogDxe: Boot %d, log at 0x%p (%d bytes)\n",
+        Log->BootCount, Log, Log->DataSize));
+
+    if (FeaturePcdGet(PcdDebugModuleLevelEnable))
+    {
+        PublishDefaultDebugLevels();
+
+        EfiCreateProtocolNotifyEvent(
+            &gEfiVariableArchProtocolGuid,
+            TPL_CALLBACK,
+            StartDebugLevelPoll,
+            NULL,
+            &mVariableRegistration
+        );
+    }
+
+    return gBS->InstallConfigurationTable(&gNintendoSwitchBootLogTableGuid, Log);
+}
@@ -11,6 +11,7 @@
 #include <Library/BaseLib.h>
 #include <Library/CacheMaintenanceLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Foundation/Types.h>
 #include <Device/T210.h>
@@ -88,6 +89,10 @@ SdMmcClockConfigSource
     UINT32 Value
 );
 
+//
+// The legacy protocol goes through ClockLib, which writes the CAR behind
+// the clock tree's back, so each of these drops the cached nodes.
+//
 STATIC TEGRA210_CLOCK_MGMT_PROTOCOL mClockProto = {
     EnableUart,
     EnableI2c,
@@ -108,7 +113,10 @@ TEGRA210_UBOOT_CLOCK_MANAGEMENT_PROTOCOL mUbootClockProto = {
     UbResetDeassert,
     UbResetPeriph,
     UbGetOscFreq,
-    UbStartPll
+    UbStartPll,
+    UbHoldPeriphs,
+    UbReleasePeriphs,
+    UbSolvePll
 };
 
 STATIC
@@ -120,6 +128,7 @@ EnableClDvfs
 )
 {
     clock_enable_cl_dvfs();
+    UbClockTreeInvalidate();
     return EFI_SUCCESS;
 }
 
@@ -133,6 +142,7 @@ EnableI2c
 {
     if (DeviceIndex < 0 || DeviceIndex > 5) return EFI_INVALID_PARAMETER;
     clock_enable_i2c(DeviceIndex);
+    UbClockTreeInvalidate();
     return EFI_SUCCESS; 
 }
 
@@ -146,6 +156,7 @@ EnableUart
 {
     if (DeviceIndex < 0 || DeviceIndex > 4) return EFI_INVALID_PARAMETER;
     clock_enable_uart(DeviceIndex);
+    UbClockTreeInvalidate();
     return EFI_SUCCESS; 
 }
 
@@ -184,6 +195,7 @@ SdMmcClockEnable
 )
 {
     clock_sdmmc_enable(Index, Clock);
+    UbClockTreeInvalidate();
     return EFI_SUCCESS;
 }
 
@@ -196,6 +208,7 @@ SdMmcClockDisable
 )
 {
     clock_sdmmc_disable(Index);
+    UbClockTreeInvalidate();
     return EFI_SUCCESS;
 }
 
@@ -210,6 +223,7 @@ SdMmcClockConfigSource
 )
 {
     clock_sdmmc_config_clock_source(pOut, DeviceId, Value);
+    UbClockTreeInvalidate();
     return EFI_SUCCESS;
 }
 
@@ -224,7 +238,9 @@ ClockManagementDxeInitialize
     EFI_STATUS Status;
     EFI_HANDLE ProtoHandle = NULL;
 
+    PERF_START(ImageHandle, "ClockInit", NULL, 0);
     UbInitialize();
+    PERF_END(ImageHandle, "ClockInit", NULL, 0);
 
     Status = gBS->InstallMultipleProtocolInterfaces(
         &ProtoHandle,
@@ -0,0 +1,60 @@
+/*
+ * Peripheral clock divider and PLL solver.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __CLOCK_SOLVER_H__
+#define __CLOCK_SOLVER_H__
+
+/* Largest second-stage divisor is 1 << CLOCK_SOLVER_MAX_SHIFT */
+#define CLOCK_SOLVER_MAX_SHIFT	8
+
+/**
+ * Work out the 7.1 (or 15.1) format divider which gives the highest rate
+ * not above the required one. If the caller has a second-stage divisor
+ * (powers of 2 from 1 to 256), it is taken into account as well.
+ *
+ * @param divider_bits	number of divider bits (8 or 16)
+ * @param parent_rate	clock rate of parent clock in Hz
+ * @param rate		required clock rate for this clock
+ * @param extra_div	NULL if there is no second-stage divisor, else set to
+ *			its value (not set if this function returns -1)
+ * @return divider which should be used, or -1 if nothing is valid
+ */
+int clock_solve_divider(unsigned divider_bits, unsigned long parent_rate,
+			unsigned long rate, int *extra_div);
+
+/*
+ * Operating range of a PLL: the reference it accepts, the comparison
+ * frequency (reference / M) and the VCO (comparison * N), plus the largest
+ * M, N and P its register fields hold. The output is VCO >> P.
+ */
+struct clock_pll_limits {
+	unsigned long min_input, max_input;
+	unsigned long min_cf, max_cf;
+	unsigned long min_vco, max_vco;
+	unsigned max_m, max_n, max_p;
+};
+
+/* PLLU on T210 */
+extern const struct clock_pll_limits clock_pllu_limits;
+
+/**
+ * Work out the M/N/P of a PLL which give the highest output rate not above
+ * the required one, keeping within the PLL's limits. Among equal rates the
+ * smallest M (highest comparison frequency) wins, then the smallest P.
+ *
+ * @param limits	operating range of the PLL
+ * @param parent_rate	reference clock rate in Hz
+ * @param rate		required output rate
+ * @param divm		set to M (not set if this function returns 0)
+ * @param divn		set to N (likewise)
+ * @param divp		set to P (likewise)
+ * @return output rate of the solution, or 0 if nothing is valid
+ */
+unsigned long clock_solve_pll(const struct clock_pll_limits *limits,
+			      unsigned long parent_rate, unsigned long rate,
+			      unsigned *divm, unsigned *divn, unsigned *divp);
+
+#endif
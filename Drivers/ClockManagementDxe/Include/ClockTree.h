@@ -0,0 +1,64 @@
+/*
+ * In-memory model of the Tegra210 peripheral clock tree.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __CLOCK_TREE_H__
+#define __CLOCK_TREE_H__
+
+/* Read every peripheral's source register and enable bit once */
+void clock_tree_init(void);
+
+/*
+ * Forget what we know about a peripheral (or all of them), for code which
+ * writes the CAR directly. The node is read back on next use.
+ */
+void clock_tree_invalidate(enum periph_id periph_id);
+void clock_tree_invalidate_all(void);
+
+/*
+ * Return the last value of a peripheral's clock source register, reading it
+ * only if the node has not been loaded yet.
+ */
+u32 clock_tree_get_source(enum periph_id periph_id);
+
+/*
+ * Clear and set bits in a peripheral's clock source register. The register
+ * is written from the cached value, without reading it back.
+ */
+void clock_tree_write_source(enum periph_id periph_id, u32 clear, u32 set);
+
+/* Return the cached parent and rate of a peripheral */
+enum clock_id clock_tree_get_parent(enum periph_id periph_id);
+unsigned long clock_tree_get_rate(enum periph_id periph_id);
+
+/*
+ * Set a peripheral's rate from its current parent. Asking again for the
+ * rate that was last set returns the cached result without touching the
+ * hardware, as long as neither the peripheral nor its parent has changed.
+ *
+ * @return effective rate, or -1U on error
+ */
+unsigned clock_tree_set_rate(enum periph_id periph_id, unsigned rate);
+
+/* Record that a PLL was reprogrammed, so rates derived from it are stale */
+void clock_tree_pll_changed(enum clock_id clkid);
+
+/*
+ * Reference counted clock enable. The enable register is only written when
+ * the count goes from 0 to 1 (and the clock is not already running) or from
+ * 1 to 0.
+ */
+void clock_tree_enable(enum periph_id periph_id);
+void clock_tree_disable(enum periph_id periph_id);
+
+/*
+ * Take an enable reference without writing the enable register, for callers
+ * which batch the writes themselves.
+ *
+ * @return 1 if the caller must set the enable bit, 0 if it is already set
+ */
+int clock_tree_enable_ref(enum periph_id periph_id);
+
+#endif
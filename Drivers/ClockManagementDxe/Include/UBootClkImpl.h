@@ -69,6 +69,32 @@ UbStartPll
     u32 lfcon
 );
 
+VOID
+EFIAPI
+UbHoldPeriphs
+(
+    IN CONST UINT64 *PeriphIds,
+    IN UINTN Count
+);
+
+VOID
+EFIAPI
+UbReleasePeriphs
+(
+    IN CONST UINT64 *PeriphIds,
+    IN UINTN Count,
+    IN int Delay
+);
+
+unsigned long
+EFIAPI
+UbSolvePll
+(
+    enum clock_id clkid,
+    unsigned long rate,
+    u32 *divm, u32 *divn, u32 *divp
+);
+
 VOID
 EFIAPI
 UbInitialize
@@ -76,4 +102,11 @@ UbInitialize
     VOID
 );
 
+VOID
+EFIAPI
+UbClockTreeInvalidate
+(
+    VOID
+);
+
 #endif
\ No newline at end of file
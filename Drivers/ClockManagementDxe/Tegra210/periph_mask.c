@@ -0,0 +1,84 @@
+/*
+ * Tegra210 clock enable and reset banks, written for a group of
+ * peripherals at once.
+ *
+ * SPDX-License-Identifier:     GPL-2.0+
+ */
+
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Protocol/Utc/Tegra210/Tegra.h>
+#include <Protocol/Utc/Tegra210/Clock.h>
+#include <Protocol/Utc/ClkRst.h>
+#include <Library/IoLib.h>
+#include <Foundation/Types.h>
+#include <Shim/DebugLib.h>
+
+void periph_mask_add(u32 *mask, enum periph_id periph_id)
+{
+	int bank;
+
+	assert(clock_periph_id_isvalid(periph_id));
+	if ((int)periph_id < (int)PERIPH_ID_X_FIRST) {
+		/* PERIPH_REG() counts V/W from 0 again */
+		bank = PERIPH_REG(periph_id);
+		if ((int)periph_id >= (int)PERIPH_ID_VW_FIRST)
+			bank += PERIPH_BANK_V;
+	} else if ((int)periph_id < (int)PERIPH_ID_Y_FIRST) {
+		bank = PERIPH_BANK_X;
+	} else {
+		bank = PERIPH_BANK_Y;
+	}
+
+	mask[bank] |= PERIPH_MASK(periph_id);
+}
+
+/*
+ * Write a bank mask to the SET (or CLR) register of each bank. These only
+ * change the bits which are written as 1, so there is no read, and banks
+ * with nothing to change are not written at all.
+ */
+static void periph_mask_write(const u32 *mask, struct clk_set_clr *lhu,
+			      struct clk_set_clr *vw, uint *x, uint *y,
+			      int enable)
+{
+	int i;
+
+	for (i = 0; i < TEGRA_CLK_REGS; i++) {
+		if (mask[PERIPH_BANK_L + i])
+			writel(mask[PERIPH_BANK_L + i],
+			       enable ? &lhu[i].set : &lhu[i].clr);
+	}
+	for (i = 0; i < TEGRA_CLK_REGS_VW; i++) {
+		if (mask[PERIPH_BANK_V + i])
+			writel(mask[PERIPH_BANK_V + i],
+			       enable ? &vw[i].set : &vw[i].clr);
+	}
+	/* In X and Y the SET register is followed by the CLR register */
+	if (mask[PERIPH_BANK_X])
+		writel(mask[PERIPH_BANK_X], enable ? x : x + 1);
+	if (mask[PERIPH_BANK_Y])
+		writel(mask[PERIPH_BANK_Y], enable ? y : y + 1);
+}
+
+void clock_set_enable_mask(const u32 *mask, int enable)
+{
+	struct clk_rst_ctlr *clkrst =
+		(struct clk_rst_ctlr *)NV_PA_CLK_RST_BASE;
+
+	periph_mask_write(mask, clkrst->crc_clk_enb_ex,
+			  clkrst->crc_clk_enb_ex_vw,
+			  &clkrst->crc_clk_enb_x_set,
+			  &clkrst->crc_clk_enb_y_set, enable);
+}
+
+void reset_set_enable_mask(const u32 *mask, int enable)
+{
+	struct clk_rst_ctlr *clkrst =
+		(struct clk_rst_ctlr *)NV_PA_CLK_RST_BASE;
+
+	periph_mask_write(mask, clkrst->crc_rst_dev_ex,
+			  clkrst->crc_rst_dev_ex_vw,
+			  &clkrst->crc_rst_dev_x_set,
+			  &clkrst->crc_rst_dev_y_set, enable);
+}
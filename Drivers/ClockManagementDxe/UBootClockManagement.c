@@ -11,11 +11,14 @@
 #include <Library/BaseLib.h>
 #include <Library/CacheMaintenanceLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Foundation/Types.h>
 #include <Protocol/Utc/Clock.h>
 #include <Protocol/UBootClockManagement.h>
 #include "Include/UBootClkImpl.h"
+#include "Include/ClockSolver.h"
+#include "Include/ClockTree.h"
 
 VOID
 EFIAPI
@@ -24,7 +27,7 @@ UbEnableClk
     IN UINT64 ClkId
 )
 {
-    clock_enable(ClkId);
+    clock_tree_enable(ClkId);
 }
 
 VOID
@@ -34,7 +37,7 @@ UbDisableClk
     IN UINT64 ClkId
 )
 {
-    clock_disable(ClkId);
+    clock_tree_disable(ClkId);
 }
 
 UINT64
@@ -44,9 +47,7 @@ UbClkGetRate
     IN UINT64 ClkId
 )
 {
-    enum clock_id parent;
-	parent = clock_get_periph_parent(ClkId);
-	return clock_get_periph_rate(ClkId, parent);
+    return clock_tree_get_rate(ClkId);
 }
 
 UINT64
@@ -57,9 +58,7 @@ UbClkSetRate
     IN UINT64 Rate
 )
 {
-    enum clock_id parent;
-	parent = clock_get_periph_parent(ClkId);
-	return clock_adjust_periph_pll_div(ClkId, parent, Rate, NULL);
+    return clock_tree_set_rate(ClkId, Rate);
 }
 
 VOID
@@ -93,6 +92,29 @@ UbResetPeriph
     reset_periph(PeriphId, Delay);
 }
 
+VOID
+EFIAPI
+UbHoldPeriphs
+(
+    IN CONST UINT64 *PeriphIds,
+    IN UINTN Count
+)
+{
+    periph_hold_set(PeriphIds, Count);
+}
+
+VOID
+EFIAPI
+UbReleasePeriphs
+(
+    IN CONST UINT64 *PeriphIds,
+    IN UINTN Count,
+    IN int Delay
+)
+{
+    periph_release_set(PeriphIds, Count, Delay);
+}
+
 enum clock_osc_freq
 EFIAPI
 UbGetOscFreq
@@ -113,7 +135,31 @@ UbStartPll
     u32 lfcon
 )
 {
-    return clock_start_pll(clkid, divm, divn, divp, cpcon, lfcon);
+    unsigned long Rate;
+
+    // Includes the wait for PLL lock
+    PERF_START(gImageHandle, "PllLock", NULL, 0);
+    Rate = clock_start_pll(clkid, divm, divn, divp, cpcon, lfcon);
+    PERF_END(gImageHandle, "PllLock", NULL, 0);
+
+    return Rate;
+}
+
+unsigned long
+EFIAPI
+UbSolvePll
+(
+    enum clock_id clkid,
+    unsigned long rate,
+    u32 *divm, u32 *divn, u32 *divp
+)
+{
+    // Only PLLU has its limits written down
+    if (clkid != CLOCK_ID_USB)
+        return 0;
+
+    return clock_solve_pll(&clock_pllu_limits, clock_get_rate(CLOCK_ID_OSC),
+        rate, divm, divn, divp);
 }
 
 VOID
@@ -123,6 +169,18 @@ UbInitialize
     VOID
 )
 {
+    // Load the clock tree first so clock_init() updates it without reads
+    clock_tree_init();
     clock_init();
     clock_verify();
+}
+
+VOID
+EFIAPI
+UbClockTreeInvalidate
+(
+    VOID
+)
+{
+    clock_tree_invalidate_all();
 }
\ No newline at end of file
@@ -19,6 +19,9 @@
 #include <Shim/TimerLib.h>
 #include <Shim/UBootIo.h>
 
+#include "Include/ClockSolver.h"
+#include "Include/ClockTree.h"
+
 /*
  * This is our record of the current clock rate of each clock. We don't
  * fill all of these in since we are only really interested in clocks which
@@ -158,6 +161,11 @@ unsigned long clock_start_pll(enum clock_id clkid, u32 divm, u32 divn,
 		writel(data, &simple_pll->pll_base);
 	}
 
+	if (pll) {
+		pll_rate[clkid] = clock_get_rate(clkid);
+		clock_tree_pll_changed(clkid);
+	}
+
 	/* calculate the stable time */
 	return (GetTimeInNanoSecond(GetPerformanceCounter()) / 1000) + CLOCK_PLL_STABLE_DELAY_US;
 }
@@ -165,38 +173,28 @@ unsigned long clock_start_pll(enum clock_id clkid, u32 divm, u32 divn,
 void clock_ll_set_source_divisor(enum periph_id periph_id, unsigned source,
 			unsigned divisor)
 {
-	u32 *reg = get_periph_source_reg(periph_id);
-	u32 value;
-
-	value = readl(reg);
-
-	value &= ~OUT_CLK_SOURCE_31_30_MASK;
-	value |= source << OUT_CLK_SOURCE_31_30_SHIFT;
-
-	value &= ~OUT_CLK_DIVISOR_MASK;
-	value |= divisor << OUT_CLK_DIVISOR_SHIFT;
-
-	writel(value, reg);
+	clock_tree_write_source(periph_id,
+				OUT_CLK_SOURCE_31_30_MASK | OUT_CLK_DIVISOR_MASK,
+				(source << OUT_CLK_SOURCE_31_30_SHIFT) |
+				(divisor << OUT_CLK_DIVISOR_SHIFT));
 }
 
 int clock_ll_set_source_bits(enum periph_id periph_id, int mux_bits,
 			     unsigned source)
 {
-	u32 *reg = get_periph_source_reg(periph_id);
-
 	switch (mux_bits) {
 	case MASK_BITS_31_30:
-		clrsetbits_le32(reg, OUT_CLK_SOURCE_31_30_MASK,
+		clock_tree_write_source(periph_id, OUT_CLK_SOURCE_31_30_MASK,
 				source << OUT_CLK_SOURCE_31_30_SHIFT);
 		break;
 
 	case MASK_BITS_31_29:
-		clrsetbits_le32(reg, OUT_CLK_SOURCE_31_29_MASK,
+		clock_tree_write_source(periph_id, OUT_CLK_SOURCE_31_29_MASK,
 				source << OUT_CLK_SOURCE_31_29_SHIFT);
 		break;
 
 	case MASK_BITS_31_28:
-		clrsetbits_le32(reg, OUT_CLK_SOURCE_31_28_MASK,
+		clock_tree_write_source(periph_id, OUT_CLK_SOURCE_31_28_MASK,
 				source << OUT_CLK_SOURCE_31_28_SHIFT);
 		break;
 
@@ -209,8 +207,7 @@ int clock_ll_set_source_bits(enum periph_id periph_id, int mux_bits,
 
 static int clock_ll_get_source_bits(enum periph_id periph_id, int mux_bits)
 {
-	u32 *reg = get_periph_source_reg(periph_id);
-	u32 val = readl(reg);
+	u32 val = clock_tree_get_source(periph_id);
 
 	switch (mux_bits) {
 	case MASK_BITS_31_30:
@@ -311,9 +308,9 @@ static unsigned long get_rate_from_divider(unsigned long parent_rate,
 unsigned long clock_get_periph_rate(enum periph_id periph_id,
 		enum clock_id parent)
 {
-	u32 *reg = get_periph_source_reg(periph_id);
 	unsigned parent_rate = pll_rate[parent];
-	int div = (readl(reg) & OUT_CLK_DIVISOR_MASK) >> OUT_CLK_DIVISOR_SHIFT;
+	int div = (clock_tree_get_source(periph_id) & OUT_CLK_DIVISOR_MASK) >>
+		OUT_CLK_DIVISOR_SHIFT;
 
 	switch (periph_id) {
 	case PERIPH_ID_UART1:
@@ -331,8 +328,8 @@ unsigned long clock_get_periph_rate(enum periph_id periph_id,
 		 * get_rate_from_divider(), but... Removing the +2 from
 		 * get_rate_from_divider() would probably require remove the -2
 		 * from the tail of clk_get_divider() since I believe that's
-		 * only there to invert get_rate_from_divider()'s +2. Observe
-		 * how find_best_divider() uses those two functions together.
+		 * only there to invert get_rate_from_divider()'s +2.
+		 * clock_solve_divider() uses the same (n + 2) / 2 model.
 		 * However, doing so breaks other stuff, such as Seaboard's
 		 * display, likely due to clock_set_pllout()'s call to
 		 * clk_get_divider(). Attempting to fix that by making
@@ -354,47 +351,6 @@ unsigned long clock_get_periph_rate(enum periph_id periph_id,
 	return get_rate_from_divider(parent_rate, div);
 }
 
-/**
- * Find the best available 7.1 format divisor given a parent clock rate and
- * required child clock rate. This function assumes that a second-stage
- * divisor is available which can divide by powers of 2 from 1 to 256.
- *
- * @param divider_bits	number of divider bits (8 or 16)
- * @param parent_rate	clock rate of parent clock in Hz
- * @param rate		required clock rate for this clock
- * @param extra_div	value for the second-stage divisor (not set if this
- *			function returns -1.
- * @return divider which should be used, or -1 if nothing is valid
- *
- */
-static int find_best_divider(unsigned divider_bits, unsigned long parent_rate,
-				unsigned long rate, int *extra_div)
-{
-	int shift;
-	int best_divider = -1;
-	int best_error = rate;
-
-	/* try dividers from 1 to 256 and find closest match */
-	for (shift = 0; shift <= 8 && best_error > 0; shift++) {
-		unsigned divided_parent = parent_rate >> shift;
-		int divider = clk_get_divider(divider_bits, divided_parent,
-						rate);
-		unsigned effective_rate = get_rate_from_divider(divided_parent,
-						divider);
-		int error = rate - effective_rate;
-
-		/* Given a valid divider, look for the lowest error */
-		if (divider != -1 && error < best_error) {
-			best_error = error;
-			*extra_div = 1 << shift;
-			best_divider = divider;
-		}
-	}
-
-	/* return what we found - *extra_div will already be set */
-	return best_divider;
-}
-
 /**
  * Adjust peripheral PLL to use the given divider and source.
  *
@@ -408,9 +364,7 @@ static int find_best_divider(unsigned divider_bits, unsigned long parent_rate,
 static int adjust_periph_pll(enum periph_id periph_id, int source,
 				int mux_bits, unsigned divider)
 {
-	u32 *reg = get_periph_source_reg(periph_id);
-
-	clrsetbits_le32(reg, OUT_CLK_DIVISOR_MASK,
+	clock_tree_write_source(periph_id, OUT_CLK_DIVISOR_MASK,
 			divider << OUT_CLK_DIVISOR_SHIFT);
 	udelay(1);
 
@@ -450,8 +404,8 @@ unsigned clock_adjust_periph_pll_div(enum periph_id periph_id,
 	source = get_periph_clock_source(periph_id, parent, &mux_bits,
 					 &divider_bits);
 
-	divider = find_best_divider(divider_bits, pll_rate[parent],
-				    rate, &xdiv);
+	divider = clock_solve_divider(divider_bits, pll_rate[parent], rate,
+				      extra_div ? &xdiv : NULL);
 	if (extra_div)
 		*extra_div = xdiv;
 
@@ -460,7 +414,7 @@ unsigned clock_adjust_periph_pll_div(enum periph_id periph_id,
 		return -1U;
 	debug("periph %d, rate=%d, reg=%p = %x\n", periph_id, rate,
 		get_periph_source_reg(periph_id),
-		readl(get_periph_source_reg(periph_id)));
+		clock_tree_get_source(periph_id));
 
 	/* Check what we ended up with. This shouldn't matter though */
 	effective_rate = clock_get_periph_rate(periph_id, parent);
@@ -509,6 +463,39 @@ void reset_periph(enum periph_id periph_id, int us_delay)
 	udelay(us_delay);
 }
 
+void periph_hold_set(const u64 *periph_ids, int count)
+{
+	u32 reset[PERIPH_BANK_COUNT] = { 0 };
+	u32 enable[PERIPH_BANK_COUNT] = { 0 };
+	int i;
+
+	for (i = 0; i < count; i++) {
+		enum periph_id periph_id = periph_ids[i];
+
+		periph_mask_add(reset, periph_id);
+		if (clock_tree_enable_ref(periph_id))
+			periph_mask_add(enable, periph_id);
+	}
+
+	/* Reset goes on first, so nothing is clocked while it comes up */
+	reset_set_enable_mask(reset, 1);
+	clock_set_enable_mask(enable, 1);
+}
+
+void periph_release_set(const u64 *periph_ids, int count, int us_delay)
+{
+	u32 reset[PERIPH_BANK_COUNT] = { 0 };
+	int i;
+
+	for (i = 0; i < count; i++)
+		periph_mask_add(reset, periph_ids[i]);
+
+	/* One settle delay for the whole group, each side of the release */
+	udelay(us_delay);
+	reset_set_enable_mask(reset, 0);
+	udelay(us_delay);
+}
+
 void reset_cmplx_set_enable(int cpu, int which, int reset)
 {
 	struct clk_rst_ctlr *clkrst =
@@ -631,6 +618,9 @@ int clock_set_rate(enum clock_id clkid, u32 n, u32 m, u32 p, u32 cpcon)
 	base_reg &= ~PLL_BYPASS_MASK;
 	writel(base_reg, &pll->pll_base);
 
+	pll_rate[clkid] = clock_get_rate(clkid);
+	clock_tree_pll_changed(clkid);
+
 	return 0;
 }
 
@@ -0,0 +1,131 @@
+/*
+ * Peripheral clock divider and PLL solver.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+/*
+ * A peripheral clock source register divides its parent by (n + 2) / 2,
+ * where n is the 7.1 (or 15.1) fixed point divider field. For a given
+ * parent the best n is the smallest one which does not overshoot the
+ * required rate, which is a single rounded-up division. With a second-stage
+ * divisor there are at most nine candidates to compare, one per power of 2.
+ *
+ * A PLL is solved the same way: for each M that keeps the comparison
+ * frequency in range and each P, the best N is a single rounded-down
+ * division, clamped to what the VCO allows.
+ */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Foundation/Types.h>
+
+#include "Include/ClockSolver.h"
+
+/*
+ * Divider for the parent divided by 1 << shift, or -1 if even the largest
+ * divider is too fast. *effective_rate is set to the resulting rate.
+ */
+static int clock_solve_stage(unsigned divider_bits, u64 parent_rate,
+			     u64 rate, int shift, u64 *effective_rate)
+{
+	u64 max_divider = (1ULL << divider_bits) - 1;
+	u64 target = rate << shift;
+	u64 divider;
+
+	/* (n + 2) >= 2 * parent / target, rounded up so we never overshoot */
+	divider = (parent_rate * 2 + target - 1) / target;
+	divider = divider < 2 ? 0 : divider - 2;
+	if (divider > max_divider)
+		return -1;
+
+	*effective_rate = (parent_rate * 2) / ((divider + 2) << shift);
+	return divider;
+}
+
+int clock_solve_divider(unsigned divider_bits, unsigned long parent_rate,
+			unsigned long rate, int *extra_div)
+{
+	int max_shift = extra_div ? CLOCK_SOLVER_MAX_SHIFT : 0;
+	int best_divider = -1;
+	int best_shift = 0;
+	u64 best_rate = 0;
+	int shift;
+
+	if (!rate || !parent_rate)
+		return -1;
+
+	for (shift = 0; shift <= max_shift; shift++) {
+		u64 effective_rate;
+		int divider = clock_solve_stage(divider_bits, parent_rate,
+						rate, shift, &effective_rate);
+
+		/* Nothing gets closer than an exact match */
+		if (divider >= 0 && (best_divider < 0 ||
+				     effective_rate > best_rate)) {
+			best_divider = divider;
+			best_shift = shift;
+			best_rate = effective_rate;
+			if (best_rate == rate)
+				break;
+		}
+	}
+
+	if (best_divider >= 0 && extra_div)
+		*extra_div = 1 << best_shift;
+
+	return best_divider;
+}
+
+/*
+ * From the T210 TRM, as in the Linux pll_u_vco_params. P is the QLIN
+ * divider, whose first two settings divide by 1 and 2; above that it no
+ * longer matches the VCO >> P which clock_get_rate() reads back, so the
+ * search stops there.
+ */
+const struct clock_pll_limits clock_pllu_limits = {
+	.min_input = 9600000,	.max_input = 800000000,
+	.min_cf = 9600000,	.max_cf = 19200000,
+	.min_vco = 350000000,	.max_vco = 700000000,
+	.max_m = 0xff,		.max_n = 0xff,	.max_p = 1,
+};
+
+unsigned long clock_solve_pll(const struct clock_pll_limits *limits,
+			      unsigned long parent_rate, unsigned long rate,
+			      unsigned *divm, unsigned *divn, unsigned *divp)
+{
+	u64 best_rate = 0;
+	unsigned m, p;
+
+	if (!rate || parent_rate < limits->min_input ||
+	    parent_rate > limits->max_input)
+		return 0;
+
+	/* Comparison frequency falls as M grows */
+	for (m = (parent_rate + limits->max_cf - 1) / limits->max_cf;
+	     m <= limits->max_m && parent_rate / m >= limits->min_cf; m++) {
+		for (p = 0; p <= limits->max_p; p++) {
+			u64 max_n = ((u64)limits->max_vco * m) / parent_rate;
+			u64 min_n = ((u64)limits->min_vco * m + parent_rate - 1) /
+				    parent_rate;
+			u64 n = ((u64)rate * m << p) / parent_rate;
+			u64 effective_rate;
+
+			if (max_n > limits->max_n)
+				max_n = limits->max_n;
+			if (n > max_n)
+				n = max_n;
+			if (!n || n < min_n)
+				continue;
+
+			effective_rate = ((u64)parent_rate * n / m) >> p;
+			if (effective_rate > best_rate) {
+				best_rate = effective_rate;
+				*divm = m;
+				*divn = n;
+				*divp = p;
+			}
+		}
+	}
+
+	return best_rate;
+}
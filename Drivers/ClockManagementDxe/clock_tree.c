@@ -0,0 +1,264 @@
+/*
+ * In-memory model of the Tegra210 peripheral clock tree.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+/*
+ * Each peripheral gets a node holding the last value of its clock source
+ * register (mux and divider), its enable bit and an enable count. Nodes are
+ * read from the CAR once in clock_tree_init() and are then kept up to date
+ * by the code that writes those registers, so rate and parent queries never
+ * touch MMIO and source register updates do not need a read first.
+ *
+ * Rates are derived from the node's source register and pll_rate[] of its
+ * parent. They are computed on first use and kept until either the source
+ * register is written or the parent PLL is reprogrammed; the latter is
+ * tracked with a generation count per PLL.
+ */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Protocol/Utc/Tegra210/Tegra.h>
+#include <Protocol/Utc/Tegra210/Clock.h>
+#include <Protocol/Utc/ClkRst.h>
+#include <Library/IoLib.h>
+#include <Foundation/Types.h>
+#include <Shim/DebugLib.h>
+#include <Shim/UBootIo.h>
+
+#include "Include/ClockTree.h"
+
+/* Node flags */
+#define CLOCK_NODE_LOADED	(1 << 0)	/* read from the hardware */
+#define CLOCK_NODE_SOURCE	(1 << 1)	/* has a clock source register */
+#define CLOCK_NODE_ENABLED	(1 << 2)	/* clock enable bit is set */
+#define CLOCK_NODE_PARENT	(1 << 3)	/* parent is valid */
+#define CLOCK_NODE_RATE		(1 << 4)	/* rate is valid for rate_gen */
+#define CLOCK_NODE_REQUESTED	(1 << 5)	/* requested was set last */
+
+struct clock_node {
+	u32 *reg;		/* clock source register */
+	u32 source;		/* last value of *reg */
+	u32 rate;		/* cached rate */
+	u32 rate_gen;		/* pll_gen[parent] when rate was computed */
+	u32 requested;		/* rate last asked for by clock_tree_set_rate() */
+	s8 parent;		/* enum clock_id */
+	u8 flags;
+	u16 enable_count;
+};
+
+static struct clock_node clock_nodes[PERIPH_ID_COUNT];
+static u32 pll_gen[CLOCK_ID_COUNT];
+
+/* Returns a pointer to the clock enable register for a peripheral */
+static u32 *clock_tree_enable_reg(enum periph_id periph_id)
+{
+	struct clk_rst_ctlr *clkrst =
+		(struct clk_rst_ctlr *)NV_PA_CLK_RST_BASE;
+
+	if ((int)periph_id < (int)PERIPH_ID_VW_FIRST)
+		return &clkrst->crc_clk_out_enb[PERIPH_REG(periph_id)];
+	if ((int)periph_id < (int)PERIPH_ID_X_FIRST)
+		return &clkrst->crc_clk_out_enb_vw[PERIPH_REG(periph_id)];
+	if ((int)periph_id < (int)PERIPH_ID_Y_FIRST)
+		return &clkrst->crc_clk_out_enb_x;
+	return &clkrst->crc_clk_out_enb_y;
+}
+
+static void clock_tree_load(enum periph_id periph_id, u32 enable_bank)
+{
+	struct clock_node *node = &clock_nodes[periph_id];
+	int mux_bits, divider_bits, type;
+
+	/* enable_count is ours, it survives the node being read again */
+	node->flags = CLOCK_NODE_LOADED;
+	if (enable_bank & PERIPH_MASK(periph_id))
+		node->flags |= CLOCK_NODE_ENABLED;
+
+	if (!get_periph_clock_info(periph_id, &mux_bits, &divider_bits,
+				   &type)) {
+		node->reg = get_periph_source_reg(periph_id);
+		node->source = readl(node->reg);
+		node->flags |= CLOCK_NODE_SOURCE;
+	}
+}
+
+/* Returns the node of a peripheral, loading it if needed */
+static struct clock_node *clock_tree_node(enum periph_id periph_id)
+{
+	struct clock_node *node;
+
+	if (!clock_periph_id_isvalid(periph_id))
+		return NULL;
+
+	node = &clock_nodes[periph_id];
+	if (!(node->flags & CLOCK_NODE_LOADED))
+		clock_tree_load(periph_id,
+				readl(clock_tree_enable_reg(periph_id)));
+
+	return node;
+}
+
+void clock_tree_init(void)
+{
+	u32 *bank = NULL;
+	u32 value = 0;
+	int i;
+
+	/* Peripheral IDs are in bank order, so each bank is read once */
+	for (i = PERIPH_ID_FIRST; i < PERIPH_ID_COUNT; i++) {
+		u32 *reg = clock_tree_enable_reg(i);
+
+		if (reg != bank) {
+			bank = reg;
+			value = readl(reg);
+		}
+		clock_tree_load(i, value);
+	}
+}
+
+void clock_tree_invalidate(enum periph_id periph_id)
+{
+	if (clock_periph_id_isvalid(periph_id))
+		clock_nodes[periph_id].flags = 0;
+}
+
+void clock_tree_invalidate_all(void)
+{
+	int i;
+
+	for (i = PERIPH_ID_FIRST; i < PERIPH_ID_COUNT; i++)
+		clock_nodes[i].flags = 0;
+}
+
+u32 clock_tree_get_source(enum periph_id periph_id)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+
+	if (!node || !(node->flags & CLOCK_NODE_SOURCE))
+		return readl(get_periph_source_reg(periph_id));
+
+	return node->source;
+}
+
+void clock_tree_write_source(enum periph_id periph_id, u32 clear, u32 set)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+
+	if (!node || !(node->flags & CLOCK_NODE_SOURCE)) {
+		clrsetbits_le32(get_periph_source_reg(periph_id), clear, set);
+		return;
+	}
+
+	node->source = (node->source & ~clear) | set;
+	node->flags &= ~(CLOCK_NODE_PARENT | CLOCK_NODE_RATE |
+			 CLOCK_NODE_REQUESTED);
+	writel(node->source, node->reg);
+}
+
+enum clock_id clock_tree_get_parent(enum periph_id periph_id)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+
+	if (!node)
+		return CLOCK_ID_NONE;
+
+	if (!(node->flags & CLOCK_NODE_PARENT)) {
+		node->parent = clock_get_periph_parent(periph_id);
+		node->flags |= CLOCK_NODE_PARENT;
+	}
+
+	return node->parent;
+}
+
+unsigned long clock_tree_get_rate(enum periph_id periph_id)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+	enum clock_id parent = clock_tree_get_parent(periph_id);
+
+	if (!node || parent == CLOCK_ID_NONE)
+		return 0;
+
+	if (!(node->flags & CLOCK_NODE_RATE) ||
+	    node->rate_gen != pll_gen[parent]) {
+		node->rate = clock_get_periph_rate(periph_id, parent);
+		node->rate_gen = pll_gen[parent];
+		node->flags |= CLOCK_NODE_RATE;
+	}
+
+	return node->rate;
+}
+
+unsigned clock_tree_set_rate(enum periph_id periph_id, unsigned rate)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+	enum clock_id parent = clock_tree_get_parent(periph_id);
+	unsigned effective_rate;
+
+	if (!node || parent == CLOCK_ID_NONE)
+		return -1U;
+
+	if ((node->flags & CLOCK_NODE_REQUESTED) &&
+	    (node->flags & CLOCK_NODE_RATE) &&
+	    node->requested == rate && node->rate_gen == pll_gen[parent])
+		return node->rate;
+
+	effective_rate = clock_adjust_periph_pll_div(periph_id, parent, rate,
+						     NULL);
+	if (effective_rate == -1U)
+		return effective_rate;
+
+	node->rate = effective_rate;
+	node->rate_gen = pll_gen[parent];
+	node->requested = rate;
+	node->flags |= CLOCK_NODE_RATE | CLOCK_NODE_REQUESTED;
+
+	return effective_rate;
+}
+
+void clock_tree_pll_changed(enum clock_id clkid)
+{
+	if (clock_id_is_pll(clkid))
+		pll_gen[clkid]++;
+}
+
+int clock_tree_enable_ref(enum periph_id periph_id)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+
+	if (!node)
+		return 1;
+
+	if (node->enable_count++ == 0 &&
+	    !(node->flags & CLOCK_NODE_ENABLED)) {
+		node->flags |= CLOCK_NODE_ENABLED;
+		return 1;
+	}
+
+	return 0;
+}
+
+void clock_tree_enable(enum periph_id periph_id)
+{
+	if (clock_tree_enable_ref(periph_id))
+		clock_enable(periph_id);
+}
+
+void clock_tree_disable(enum periph_id periph_id)
+{
+	struct clock_node *node = clock_tree_node(periph_id);
+
+	if (!node) {
+		clock_disable(periph_id);
+		return;
+	}
+
+	/* Unbalanced calls still turn the clock off, as they always did */
+	if (node->enable_count > 0 && --node->enable_count > 0)
+		return;
+
+	if (node->flags & CLOCK_NODE_ENABLED) {
+		clock_disable(periph_id);
+		node->flags &= ~CLOCK_NODE_ENABLED;
+	}
+}
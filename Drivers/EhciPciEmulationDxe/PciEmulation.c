@@ -51,8 +51,18 @@ static void usbf_reset_controller(
     struct usb_ctlr *usbctlr
 )
 {
-	/* Reset the USB controller with 2us delay */
-	mClkProtocol->ResetPeriph(config->periph_id, 2);
+	UINT64 periph_id = config->periph_id;
+
+	/*
+	 * Reset the USB controller with its clock running and a 2us delay.
+	 * The clock is turned on while it is held in reset. The controller is
+	 * the whole group: this driver does not program XUSB_PADCTL, so
+	 * resetting it here would undo whatever set the pads up, PLLU and the
+	 * UTMI PLL are started separately, and USB1 is never brought up for
+	 * another controller since only USBD is used.
+	 */
+	mClkProtocol->HoldPeriphs(&periph_id, 1);
+	mClkProtocol->ReleasePeriphs(&periph_id, 1, 2);
 
 	/*
 	 * Set USB1_NO_LEGACY_MODE to 1, Registers are accessible under
@@ -128,8 +138,6 @@ static int init_utmi_usb_controller(
 	struct clk_rst_ctlr *clkrst;
 	struct usb_ctlr *usb1ctlr;
 
-    mClkProtocol->EnableClk(config->periph_id);
-
 	/* Reset the usb controller */
 	usbf_reset_controller(config, usbctlr);
 
@@ -439,15 +447,30 @@ int usb_common_init(struct fdt_usb *config, enum usb_init_type init)
 	return 0;
 }
 
-static void config_clock(const u32 timing[])
+static int config_clock(struct fdt_usb *config, const u32 timing[])
 {
+	enum clock_osc_freq osc = mClkProtocol->GetOscFreq();
+	u32 divm = timing[PARAM_DIVM];
+	u32 divn = timing[PARAM_DIVN];
+	u32 divp = timing[PARAM_DIVP];
+
+	/* The T210 13/26MHz rows are 12MHz copies, solve M/N/P instead */
+	if (config->type == USB_CTLR_T210 &&
+	    (osc == CLOCK_OSC_FREQ_13_0 || osc == CLOCK_OSC_FREQ_26_0) &&
+	    mClkProtocol->SolvePll(CLOCK_ID_USB, T210_PLLU_RATE,
+				   &divm, &divn, &divp) != T210_PLLU_RATE)
+	{
+		printf("tegrausb: no PLLU setting for this oscillator\n");
+		return -1;
+	}
+
 	debug("%s: DIVM = %d, DIVN = %d, DIVP = %d, cpcon/lfcon = %d/%d\n",
-	      __func__, timing[PARAM_DIVM], timing[PARAM_DIVN],
-	      timing[PARAM_DIVP], timing[PARAM_CPCON], timing[PARAM_LFCON]);
+	      __func__, divm, divn, divp,
+	      timing[PARAM_CPCON], timing[PARAM_LFCON]);
 
-	mClkProtocol->StartPll(CLOCK_ID_USB,
-		timing[PARAM_DIVM], timing[PARAM_DIVN], timing[PARAM_DIVP],
+	mClkProtocol->StartPll(CLOCK_ID_USB, divm, divn, divp,
 		timing[PARAM_CPCON], timing[PARAM_LFCON]);
+	return 0;
 }
 
 EFI_STATUS
@@ -476,7 +499,8 @@ ConfigController(
 
     if (!mPriv.clk_done)
     {
-        config_clock(get_pll_timing(&fdt_usb_controllers[mPriv.type]));
+        ret = config_clock(&mPriv, get_pll_timing(&fdt_usb_controllers[mPriv.type]));
+        if (ret) return EFI_DEVICE_ERROR;
         mPriv.clk_done = true;
     }
 
@@ -131,7 +131,14 @@ static const unsigned T114_usb_pll[CLOCK_OSC_FREQ_COUNT][PARAM_COUNT] = {
 	{ 0x000, 0x00, 0x00, 0x0,   0,  0x00, 0x00, 0x00, 0x00, 0x0000, 0 }
 };
 
-/* NOTE: 13/26MHz settings are N/A for T210, so dupe 12MHz settings for now */
+/* PLLU output on T210, the 480MHz VCO divided by 2 */
+#define T210_PLLU_RATE		240000000
+
+/*
+ * NOTE: 13/26MHz settings are N/A for T210, so dupe 12MHz settings for now.
+ * config_clock() does not use their DivN/DivM/DivP, it asks the clock
+ * driver to solve them.
+ */
 static const unsigned T210_usb_pll[CLOCK_OSC_FREQ_COUNT][PARAM_COUNT] = {
 	/* DivN, DivM, DivP, KCP,   KVCO,  Delays              Debounce, Bias */
 	{ 0x028, 0x01, 0x01, 0x0,   0,  0x02, 0x2F, 0x08, 0x76,  32500,  5 },
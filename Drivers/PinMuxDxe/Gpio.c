@@ -12,6 +12,7 @@
 #include <Library/TimerLib.h>
 #include <Device/PinMux.h>
 #include <Protocol/PinMux.h>
+#include <Library/UtilLib.h>
 
 #include "Include/Gpio.h"
 #include "Tegra210/Gpio.h"
@@ -21,8 +22,15 @@ static const int CONFIG_GPIO = 1;
 static const int DIRECTION_INPUT = 0;
 static const int DIRECTION_OUTPUT = 1;
 
+/*
+ * Queued register updates in gpio_config_table(). The out, direction and
+ * config registers of a port are shared by its 8 pins, so this is enough
+ * for a few ports at a time.
+ */
+#define GPIO_PROG_OPS	24
+
 /* Config GPIO pin 'gpio' as input or output (OE) as per 'output' */
-static void set_direction(unsigned gpio, int output)
+static void set_direction(reg_prog_t *prog, unsigned gpio, int output)
 {
 	struct gpio_ctlr *ctlr = (struct gpio_ctlr *) NV_PA_GPIO_BASE;
 	struct gpio_ctlr_bank *bank = &ctlr->gpio_bank[GPIO_BANK(gpio)];
@@ -31,16 +39,13 @@ static void set_direction(unsigned gpio, int output)
 	debug("set_direction: port = %d, bit = %d, %s\n",
 		GPIO_FULLPORT(gpio), GPIO_BIT(gpio), output ? "OUT" : "IN");
 
-	u = readl(&bank->gpio_dir_out[GPIO_PORT(gpio)]);
-	if (output != DIRECTION_INPUT)
-		u |= 1 << GPIO_BIT(gpio);
-	else
-		u &= ~(1 << GPIO_BIT(gpio));
-	writel(u, &bank->gpio_dir_out[GPIO_PORT(gpio)]);
+	u = 1 << GPIO_BIT(gpio);
+	reg_prog_update(prog, &bank->gpio_dir_out[GPIO_PORT(gpio)], u,
+			output != DIRECTION_INPUT ? u : 0);
 }
 
 /* set GPIO pin 'gpio' output bit as 0 or 1 as per 'high' */
-static void set_level(unsigned gpio, int high)
+static void set_level(reg_prog_t *prog, unsigned gpio, int high)
 {
 	struct gpio_ctlr *ctlr = (struct gpio_ctlr *)NV_PA_GPIO_BASE;
 	struct gpio_ctlr_bank *bank = &ctlr->gpio_bank[GPIO_BANK(gpio)];
@@ -49,12 +54,9 @@ static void set_level(unsigned gpio, int high)
 	debug("set_level: port = %d, bit %d == %d\n",
 		GPIO_FULLPORT(gpio), GPIO_BIT(gpio), high);
 
-	u = readl(&bank->gpio_out[GPIO_PORT(gpio)]);
-	if (high)
-		u |= 1 << GPIO_BIT(gpio);
-	else
-		u &= ~(1 << GPIO_BIT(gpio));
-	writel(u, &bank->gpio_out[GPIO_PORT(gpio)]);
+	u = 1 << GPIO_BIT(gpio);
+	reg_prog_update(prog, &bank->gpio_out[GPIO_PORT(gpio)], u,
+			high ? u : 0);
 }
 
 /* Return config of pin 'gpio' as GPIO (1) or SFIO (0) */
@@ -75,7 +77,7 @@ static int get_config(unsigned gpio)
 }
 
 /* Config pin 'gpio' as GPIO or SFIO, based on 'type' */
-static void set_config(unsigned gpio, int type)
+static void set_config(reg_prog_t *prog, unsigned gpio, int type)
 {
 	struct gpio_ctlr *ctlr = (struct gpio_ctlr *)NV_PA_GPIO_BASE;
 	struct gpio_ctlr_bank *bank = &ctlr->gpio_bank[GPIO_BANK(gpio)];
@@ -84,34 +86,50 @@ static void set_config(unsigned gpio, int type)
 	debug("set_config: port = %d, bit = %d, %s\n",
 		GPIO_FULLPORT(gpio), GPIO_BIT(gpio), type ? "GPIO" : "SFPIO");
 
-	u = readl(&bank->gpio_config[GPIO_PORT(gpio)]);
-	if (type != CONFIG_SFIO)
-		u |= 1 << GPIO_BIT(gpio);
-	else
-		u &= ~(1 << GPIO_BIT(gpio));
-	writel(u, &bank->gpio_config[GPIO_PORT(gpio)]);
+	u = 1 << GPIO_BIT(gpio);
+	reg_prog_update(prog, &bank->gpio_config[GPIO_PORT(gpio)], u,
+			type != CONFIG_SFIO ? u : 0);
 }
 
+/*
+ * The table is applied in three passes, output levels, then directions, then
+ * the switch to GPIO, so no pin drives a stale level. Within a pass the pins
+ * of a port share one write to each register.
+ */
 void gpio_config_table(const struct tegra_gpio_config *config, int len)
 {
+	reg_op_t ops[GPIO_PROG_OPS];
+	reg_prog_t prog;
 	int i;
 
-	for (i = 0; i < len; i++) 
-    {
-		switch (config[i].init) 
-        {
+	reg_prog_init(&prog, ops, ARRAY_SIZE(ops));
+
+	for (i = 0; i < len; i++)
+	{
+		if (config[i].init == TEGRA_GPIO_INIT_OUT0)
+			set_level(&prog, config[i].gpio, 0);
+		else if (config[i].init == TEGRA_GPIO_INIT_OUT1)
+			set_level(&prog, config[i].gpio, 1);
+	}
+	reg_prog_fence(&prog);
+
+	for (i = 0; i < len; i++)
+	{
+		switch (config[i].init)
+		{
 		case TEGRA_GPIO_INIT_IN:
-			set_direction(config[i].gpio, DIRECTION_INPUT);
+			set_direction(&prog, config[i].gpio, DIRECTION_INPUT);
 			break;
 		case TEGRA_GPIO_INIT_OUT0:
-			set_level(config[i].gpio, 0);
-			set_direction(config[i].gpio, DIRECTION_OUTPUT);
-			break;
 		case TEGRA_GPIO_INIT_OUT1:
-			set_level(config[i].gpio, 1);
-			set_direction(config[i].gpio, DIRECTION_OUTPUT);
+			set_direction(&prog, config[i].gpio, DIRECTION_OUTPUT);
 			break;
 		}
-		set_config(config[i].gpio, CONFIG_GPIO);
 	}
-}
\ No newline at end of file
+	reg_prog_fence(&prog);
+
+	for (i = 0; i < len; i++)
+		set_config(&prog, config[i].gpio, CONFIG_GPIO);
+
+	reg_prog_run(&prog);
+}
@@ -9,6 +9,7 @@
 #include <Shim/TimerLib.h>
 #include <Shim/UBootIo.h>
 #include <Library/TimerLib.h>
+#include <Library/PerformanceLib.h>
 #include <Device/PinMux.h>
 #include <Protocol/PinMux.h>
 
@@ -36,14 +37,18 @@ PinMuxDxeInitialize
 
     pinmux_clear_tristate_input_clamping();
 
+    PERF_START(ImageHandle, "GpioConfig", NULL, 0);
     gpio_config_table(nintendo_switch_gpio_inits,
         ARRAY_SIZE(nintendo_switch_gpio_inits));
+    PERF_END(ImageHandle, "GpioConfig", NULL, 0);
 
+    PERF_START(ImageHandle, "PinmuxApply", NULL, 0);
 	pinmux_config_pingrp_table(nintendo_switch_pingrps,
         ARRAY_SIZE(nintendo_switch_pingrps));
 
 	pinmux_config_drvgrp_table(nintendo_switch_drvgrps,
         ARRAY_SIZE(nintendo_switch_drvgrps));
+    PERF_END(ImageHandle, "PinmuxApply", NULL, 0);
 
     Status = gBS->InstallMultipleProtocolInterfaces(
         &ProtoHandle,
@@ -16,6 +16,7 @@
 #include <Shim/TimerLib.h>
 #include <Shim/UBootIo.h>
 #include <Library/TimerLib.h>
+#include <Library/UtilLib.h>
 
 /* return 1 if a pingrp is in range */
 #define pmux_pingrp_isvalid(pin) (((pin) >= 0) && ((pin) < PMUX_PINGRP_COUNT))
@@ -86,6 +87,13 @@
 	(((hsm) >= PMUX_HSM_DISABLE) && ((hsm) <= PMUX_HSM_ENABLE))
 #endif
 
+/*
+ * Number of queued register updates when applying a table. Every field of
+ * a pin or drive group lives in one register, so this only bounds how many
+ * groups are queued before the program is run.
+ */
+#define PINMUX_PROG_OPS	32
+
 #define _R(offset)	(u32 *)((unsigned long)NV_PA_APB_MISC_BASE + (offset))
 
 #if defined(CONFIG_TEGRA20)
@@ -143,6 +151,19 @@
 #define RCV_SEL_SHIFT	9
 #endif
 
+/*
+ * Update a field of a pinmux register, either right away or, when a whole
+ * table is being applied, by queueing it on prog so that all the fields of
+ * a register end up in one write.
+ */
+static void pinmux_update(reg_prog_t *prog, u32 *reg, u32 clear, u32 set)
+{
+	if (prog)
+		reg_prog_update(prog, reg, clear, set);
+	else
+		clrsetbits_le32(reg, clear, set);
+}
+
 #ifdef TEGRA_PMX_SOC_HAS_IO_CLAMPING
 /* This register/field only exists on Tegra114 and later */
 #define APB_MISC_PP_PINMUX_GLOBAL_0 0x40
@@ -163,11 +184,11 @@ void pinmux_clear_tristate_input_clamping(void)
 }
 #endif
 
-void pinmux_set_func(enum pmux_pingrp pin, enum pmux_func func)
+static void pinmux_prog_set_func(reg_prog_t *prog, enum pmux_pingrp pin,
+				 enum pmux_func func)
 {
 	u32 *reg = MUX_REG(pin);
 	int i, mux = -1;
-	u32 val;
 
 	if (func == PMUX_FUNC_DEFAULT)
 		return;
@@ -189,59 +210,62 @@ void pinmux_set_func(enum pmux_pingrp pin, enum pmux_func func)
 	}
 	assert(mux != -1);
 
-	val = readl(reg);
-	val &= ~(3 << MUX_SHIFT(pin));
-	val |= (mux << MUX_SHIFT(pin));
-	writel(val, reg);
+	pinmux_update(prog, reg, 3 << MUX_SHIFT(pin), mux << MUX_SHIFT(pin));
 }
 
-void pinmux_set_pullupdown(enum pmux_pingrp pin, enum pmux_pull pupd)
+static void pinmux_prog_set_pullupdown(reg_prog_t *prog,
+				       enum pmux_pingrp pin,
+				       enum pmux_pull pupd)
 {
 	u32 *reg = PULL_REG(pin);
-	u32 val;
 
 	/* Error check on pin and pupd */
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_pupd_isvalid(pupd));
 
-	val = readl(reg);
-	val &= ~(3 << PULL_SHIFT(pin));
-	val |= (pupd << PULL_SHIFT(pin));
-	writel(val, reg);
+	pinmux_update(prog, reg, 3 << PULL_SHIFT(pin), pupd << PULL_SHIFT(pin));
 }
 
-static void pinmux_set_tristate(enum pmux_pingrp pin, int tri)
+static void pinmux_set_tristate(reg_prog_t *prog, enum pmux_pingrp pin,
+				int tri)
 {
 	u32 *reg = TRI_REG(pin);
-	u32 val;
 
 	/* Error check on pin */
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_tristate_isvalid(tri));
 
-	val = readl(reg);
 	if (tri == PMUX_TRI_TRISTATE)
-		val |= (1 << TRI_SHIFT(pin));
+		pinmux_update(prog, reg, 0, 1 << TRI_SHIFT(pin));
 	else
-		val &= ~(1 << TRI_SHIFT(pin));
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << TRI_SHIFT(pin), 0);
+}
+
+void pinmux_set_func(enum pmux_pingrp pin, enum pmux_func func)
+{
+	pinmux_prog_set_func(NULL, pin, func);
+}
+
+void pinmux_set_pullupdown(enum pmux_pingrp pin, enum pmux_pull pupd)
+{
+	pinmux_prog_set_pullupdown(NULL, pin, pupd);
 }
 
 void pinmux_tristate_enable(enum pmux_pingrp pin)
 {
-	pinmux_set_tristate(pin, PMUX_TRI_TRISTATE);
+	pinmux_set_tristate(NULL, pin, PMUX_TRI_TRISTATE);
 }
 
 void pinmux_tristate_disable(enum pmux_pingrp pin)
 {
-	pinmux_set_tristate(pin, PMUX_TRI_NORMAL);
+	pinmux_set_tristate(NULL, pin, PMUX_TRI_NORMAL);
 }
 
 #ifdef TEGRA_PMX_PINS_HAVE_E_INPUT
-void pinmux_set_io(enum pmux_pingrp pin, enum pmux_pin_io io)
+static void pinmux_prog_set_io(reg_prog_t *prog, enum pmux_pingrp pin,
+			       enum pmux_pin_io io)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (io == PMUX_PIN_NONE)
 		return;
@@ -250,20 +274,23 @@ void pinmux_set_io(enum pmux_pingrp pin, enum pmux_pin_io io)
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_io_isvalid(io));
 
-	val = readl(reg);
 	if (io == PMUX_PIN_INPUT)
-		val |= (io & 1) << IO_SHIFT;
+		pinmux_update(prog, reg, 0, (io & 1) << IO_SHIFT);
 	else
-		val &= ~(1 << IO_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << IO_SHIFT, 0);
+}
+
+void pinmux_set_io(enum pmux_pingrp pin, enum pmux_pin_io io)
+{
+	pinmux_prog_set_io(NULL, pin, io);
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_LOCK
-static void pinmux_set_lock(enum pmux_pingrp pin, enum pmux_pin_lock lock)
+static void pinmux_set_lock(reg_prog_t *prog, enum pmux_pingrp pin,
+			    enum pmux_pin_lock lock)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (lock == PMUX_PIN_LOCK_DEFAULT)
 		return;
@@ -272,25 +299,23 @@ static void pinmux_set_lock(enum pmux_pingrp pin, enum pmux_pin_lock lock)
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_lock_isvalid(lock));
 
-	val = readl(reg);
 	if (lock == PMUX_PIN_LOCK_ENABLE) {
-		val |= (1 << LOCK_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << LOCK_SHIFT);
 	} else {
-		if (val & (1 << LOCK_SHIFT))
+		if (readl(reg) & (1 << LOCK_SHIFT))
 			printf("%s: Cannot clear LOCK bit!\n", __func__);
-		val &= ~(1 << LOCK_SHIFT);
+		pinmux_update(prog, reg, 1 << LOCK_SHIFT, 0);
 	}
-	writel(val, reg);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_OD
-static void pinmux_set_od(enum pmux_pingrp pin, enum pmux_pin_od od)
+static void pinmux_set_od(reg_prog_t *prog, enum pmux_pingrp pin,
+			  enum pmux_pin_od od)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (od == PMUX_PIN_OD_DEFAULT)
 		return;
@@ -299,23 +324,20 @@ static void pinmux_set_od(enum pmux_pingrp pin, enum pmux_pin_od od)
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_od_isvalid(od));
 
-	val = readl(reg);
 	if (od == PMUX_PIN_OD_ENABLE)
-		val |= (1 << OD_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << OD_SHIFT);
 	else
-		val &= ~(1 << OD_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << OD_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_IO_RESET
-static void pinmux_set_ioreset(enum pmux_pingrp pin,
+static void pinmux_set_ioreset(reg_prog_t *prog, enum pmux_pingrp pin,
 				enum pmux_pin_ioreset ioreset)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (ioreset == PMUX_PIN_IO_RESET_DEFAULT)
 		return;
@@ -324,23 +346,20 @@ static void pinmux_set_ioreset(enum pmux_pingrp pin,
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_ioreset_isvalid(ioreset));
 
-	val = readl(reg);
 	if (ioreset == PMUX_PIN_IO_RESET_ENABLE)
-		val |= (1 << IO_RESET_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << IO_RESET_SHIFT);
 	else
-		val &= ~(1 << IO_RESET_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << IO_RESET_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_RCV_SEL
-static void pinmux_set_rcv_sel(enum pmux_pingrp pin,
+static void pinmux_set_rcv_sel(reg_prog_t *prog, enum pmux_pingrp pin,
 				enum pmux_pin_rcv_sel rcv_sel)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (rcv_sel == PMUX_PIN_RCV_SEL_DEFAULT)
 		return;
@@ -349,23 +368,20 @@ static void pinmux_set_rcv_sel(enum pmux_pingrp pin,
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_rcv_sel_isvalid(rcv_sel));
 
-	val = readl(reg);
 	if (rcv_sel == PMUX_PIN_RCV_SEL_HIGH)
-		val |= (1 << RCV_SEL_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << RCV_SEL_SHIFT);
 	else
-		val &= ~(1 << RCV_SEL_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << RCV_SEL_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_E_IO_HV
-static void pinmux_set_e_io_hv(enum pmux_pingrp pin,
+static void pinmux_set_e_io_hv(reg_prog_t *prog, enum pmux_pingrp pin,
 				enum pmux_pin_e_io_hv e_io_hv)
 {
 	u32 *reg = REG(pin);
-	u32 val;
 
 	if (e_io_hv == PMUX_PIN_E_IO_HV_DEFAULT)
 		return;
@@ -374,22 +390,20 @@ static void pinmux_set_e_io_hv(enum pmux_pingrp pin,
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_pin_e_io_hv_isvalid(e_io_hv));
 
-	val = readl(reg);
 	if (e_io_hv == PMUX_PIN_E_IO_HV_HIGH)
-		val |= (1 << E_IO_HV_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << E_IO_HV_SHIFT);
 	else
-		val &= ~(1 << E_IO_HV_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << E_IO_HV_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_SCHMT
-static void pinmux_set_schmt(enum pmux_pingrp pin, enum pmux_schmt schmt)
+static void pinmux_set_schmt(reg_prog_t *prog, enum pmux_pingrp pin,
+			     enum pmux_schmt schmt)
 {
 	u32 *reg = REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (schmt == PMUX_SCHMT_NONE)
@@ -399,22 +413,20 @@ static void pinmux_set_schmt(enum pmux_pingrp pin, enum pmux_schmt schmt)
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_schmt_isvalid(schmt));
 
-	val = readl(reg);
 	if (schmt == PMUX_SCHMT_ENABLE)
-		val |= (1 << SCHMT_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << SCHMT_SHIFT);
 	else
-		val &= ~(1 << SCHMT_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << SCHMT_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_PINS_HAVE_HSM
-static void pinmux_set_hsm(enum pmux_pingrp pin, enum pmux_hsm hsm)
+static void pinmux_set_hsm(reg_prog_t *prog, enum pmux_pingrp pin,
+			   enum pmux_hsm hsm)
 {
 	u32 *reg = REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (hsm == PMUX_HSM_NONE)
@@ -424,57 +436,60 @@ static void pinmux_set_hsm(enum pmux_pingrp pin, enum pmux_hsm hsm)
 	assert(pmux_pingrp_isvalid(pin));
 	assert(pmux_hsm_isvalid(hsm));
 
-	val = readl(reg);
 	if (hsm == PMUX_HSM_ENABLE)
-		val |= (1 << HSM_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << HSM_SHIFT);
 	else
-		val &= ~(1 << HSM_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << HSM_SHIFT, 0);
 
 	return;
 }
 #endif
 
-static void pinmux_config_pingrp(const struct pmux_pingrp_config *config)
+static void pinmux_config_pingrp(reg_prog_t *prog,
+				 const struct pmux_pingrp_config *config)
 {
 	enum pmux_pingrp pin = config->pingrp;
 
-	pinmux_set_func(pin, config->func);
-	pinmux_set_pullupdown(pin, config->pull);
-	pinmux_set_tristate(pin, config->tristate);
+	pinmux_prog_set_func(prog, pin, config->func);
+	pinmux_prog_set_pullupdown(prog, pin, config->pull);
+	pinmux_set_tristate(prog, pin, config->tristate);
 #ifdef TEGRA_PMX_PINS_HAVE_E_INPUT
-	pinmux_set_io(pin, config->io);
+	pinmux_prog_set_io(prog, pin, config->io);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_LOCK
-	pinmux_set_lock(pin, config->lock);
+	pinmux_set_lock(prog, pin, config->lock);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_OD
-	pinmux_set_od(pin, config->od);
+	pinmux_set_od(prog, pin, config->od);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_IO_RESET
-	pinmux_set_ioreset(pin, config->ioreset);
+	pinmux_set_ioreset(prog, pin, config->ioreset);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_RCV_SEL
-	pinmux_set_rcv_sel(pin, config->rcv_sel);
+	pinmux_set_rcv_sel(prog, pin, config->rcv_sel);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_E_IO_HV
-	pinmux_set_e_io_hv(pin, config->e_io_hv);
+	pinmux_set_e_io_hv(prog, pin, config->e_io_hv);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_SCHMT
-	pinmux_set_schmt(pin, config->schmt);
+	pinmux_set_schmt(prog, pin, config->schmt);
 #endif
 #ifdef TEGRA_PMX_PINS_HAVE_HSM
-	pinmux_set_hsm(pin, config->hsm);
+	pinmux_set_hsm(prog, pin, config->hsm);
 #endif
 }
 
 void pinmux_config_pingrp_table(const struct pmux_pingrp_config *config,
 				int len)
 {
+	reg_op_t ops[PINMUX_PROG_OPS];
+	reg_prog_t prog;
 	int i;
 
+	reg_prog_init(&prog, ops, ARRAY_SIZE(ops));
 	for (i = 0; i < len; i++)
-		pinmux_config_pingrp(&config[i]);
+		pinmux_config_pingrp(&prog, &config[i]);
+	reg_prog_run(&prog);
 }
 
 #ifdef TEGRA_PMX_SOC_HAS_DRVGRPS
@@ -521,10 +536,10 @@ void pinmux_config_pingrp_table(const struct pmux_pingrp_config *config,
 #define SLWF_SHIFT	30
 #define SLWF_MASK	(3 << SLWF_SHIFT)
 
-static void pinmux_set_drvup_slwf(enum pmux_drvgrp grp, int slwf)
+static void pinmux_set_drvup_slwf(reg_prog_t *prog, enum pmux_drvgrp grp,
+				  int slwf)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (slwf == PMUX_SLWF_NONE)
@@ -534,18 +549,15 @@ static void pinmux_set_drvup_slwf(enum pmux_drvgrp grp, int slwf)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_slw_isvalid(slwf));
 
-	val = readl(reg);
-	val &= ~SLWF_MASK;
-	val |= (slwf << SLWF_SHIFT);
-	writel(val, reg);
+	pinmux_update(prog, reg, SLWF_MASK, slwf << SLWF_SHIFT);
 
 	return;
 }
 
-static void pinmux_set_drvdn_slwr(enum pmux_drvgrp grp, int slwr)
+static void pinmux_set_drvdn_slwr(reg_prog_t *prog, enum pmux_drvgrp grp,
+				  int slwr)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (slwr == PMUX_SLWR_NONE)
@@ -555,18 +567,15 @@ static void pinmux_set_drvdn_slwr(enum pmux_drvgrp grp, int slwr)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_slw_isvalid(slwr));
 
-	val = readl(reg);
-	val &= ~SLWR_MASK;
-	val |= (slwr << SLWR_SHIFT);
-	writel(val, reg);
+	pinmux_update(prog, reg, SLWR_MASK, slwr << SLWR_SHIFT);
 
 	return;
 }
 
-static void pinmux_set_drvup(enum pmux_drvgrp grp, int drvup)
+static void pinmux_set_drvup(reg_prog_t *prog, enum pmux_drvgrp grp,
+			     int drvup)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (drvup == PMUX_DRVUP_NONE)
@@ -576,18 +585,15 @@ static void pinmux_set_drvup(enum pmux_drvgrp grp, int drvup)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_drv_isvalid(drvup));
 
-	val = readl(reg);
-	val &= ~DRVUP_MASK;
-	val |= (drvup << DRVUP_SHIFT);
-	writel(val, reg);
+	pinmux_update(prog, reg, DRVUP_MASK, drvup << DRVUP_SHIFT);
 
 	return;
 }
 
-static void pinmux_set_drvdn(enum pmux_drvgrp grp, int drvdn)
+static void pinmux_set_drvdn(reg_prog_t *prog, enum pmux_drvgrp grp,
+			     int drvdn)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (drvdn == PMUX_DRVDN_NONE)
@@ -597,19 +603,16 @@ static void pinmux_set_drvdn(enum pmux_drvgrp grp, int drvdn)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_drv_isvalid(drvdn));
 
-	val = readl(reg);
-	val &= ~DRVDN_MASK;
-	val |= (drvdn << DRVDN_SHIFT);
-	writel(val, reg);
+	pinmux_update(prog, reg, DRVDN_MASK, drvdn << DRVDN_SHIFT);
 
 	return;
 }
 
 #ifdef TEGRA_PMX_GRPS_HAVE_LPMD
-static void pinmux_set_lpmd(enum pmux_drvgrp grp, enum pmux_lpmd lpmd)
+static void pinmux_set_lpmd(reg_prog_t *prog, enum pmux_drvgrp grp,
+			    enum pmux_lpmd lpmd)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (lpmd == PMUX_LPMD_NONE)
@@ -619,20 +622,17 @@ static void pinmux_set_lpmd(enum pmux_drvgrp grp, enum pmux_lpmd lpmd)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_lpmd_isvalid(lpmd));
 
-	val = readl(reg);
-	val &= ~LPMD_MASK;
-	val |= (lpmd << LPMD_SHIFT);
-	writel(val, reg);
+	pinmux_update(prog, reg, LPMD_MASK, lpmd << LPMD_SHIFT);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_GRPS_HAVE_SCHMT
-static void pinmux_set_schmt(enum pmux_drvgrp grp, enum pmux_schmt schmt)
+static void pinmux_set_schmt(reg_prog_t *prog, enum pmux_drvgrp grp,
+			     enum pmux_schmt schmt)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (schmt == PMUX_SCHMT_NONE)
@@ -642,22 +642,20 @@ static void pinmux_set_schmt(enum pmux_drvgrp grp, enum pmux_schmt schmt)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_schmt_isvalid(schmt));
 
-	val = readl(reg);
 	if (schmt == PMUX_SCHMT_ENABLE)
-		val |= (1 << SCHMT_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << SCHMT_SHIFT);
 	else
-		val &= ~(1 << SCHMT_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << SCHMT_SHIFT, 0);
 
 	return;
 }
 #endif
 
 #ifdef TEGRA_PMX_GRPS_HAVE_HSM
-static void pinmux_set_hsm(enum pmux_drvgrp grp, enum pmux_hsm hsm)
+static void pinmux_set_hsm(reg_prog_t *prog, enum pmux_drvgrp grp,
+			   enum pmux_hsm hsm)
 {
 	u32 *reg = DRV_REG(grp);
-	u32 val;
 
 	/* NONE means unspecified/do not change/use POR value */
 	if (hsm == PMUX_HSM_NONE)
@@ -667,43 +665,46 @@ static void pinmux_set_hsm(enum pmux_drvgrp grp, enum pmux_hsm hsm)
 	assert(pmux_drvgrp_isvalid(grp));
 	assert(pmux_hsm_isvalid(hsm));
 
-	val = readl(reg);
 	if (hsm == PMUX_HSM_ENABLE)
-		val |= (1 << HSM_SHIFT);
+		pinmux_update(prog, reg, 0, 1 << HSM_SHIFT);
 	else
-		val &= ~(1 << HSM_SHIFT);
-	writel(val, reg);
+		pinmux_update(prog, reg, 1 << HSM_SHIFT, 0);
 
 	return;
 }
 #endif
 
-static void pinmux_config_drvgrp(const struct pmux_drvgrp_config *config)
+static void pinmux_config_drvgrp(reg_prog_t *prog,
+				 const struct pmux_drvgrp_config *config)
 {
 	enum pmux_drvgrp grp = config->drvgrp;
 
-	pinmux_set_drvup_slwf(grp, config->slwf);
-	pinmux_set_drvdn_slwr(grp, config->slwr);
-	pinmux_set_drvup(grp, config->drvup);
-	pinmux_set_drvdn(grp, config->drvdn);
+	pinmux_set_drvup_slwf(prog, grp, config->slwf);
+	pinmux_set_drvdn_slwr(prog, grp, config->slwr);
+	pinmux_set_drvup(prog, grp, config->drvup);
+	pinmux_set_drvdn(prog, grp, config->drvdn);
 #ifdef TEGRA_PMX_GRPS_HAVE_LPMD
-	pinmux_set_lpmd(grp, config->lpmd);
+	pinmux_set_lpmd(prog, grp, config->lpmd);
 #endif
 #ifdef TEGRA_PMX_GRPS_HAVE_SCHMT
-	pinmux_set_schmt(grp, config->schmt);
+	pinmux_set_schmt(prog, grp, config->schmt);
 #endif
 #ifdef TEGRA_PMX_GRPS_HAVE_HSM
-	pinmux_set_hsm(grp, config->hsm);
+	pinmux_set_hsm(prog, grp, config->hsm);
 #endif
 }
 
 void pinmux_config_drvgrp_table(const struct pmux_drvgrp_config *config,
 				int len)
 {
+	reg_op_t ops[PINMUX_PROG_OPS];
+	reg_prog_t prog;
 	int i;
 
+	reg_prog_init(&prog, ops, ARRAY_SIZE(ops));
 	for (i = 0; i < len; i++)
-		pinmux_config_drvgrp(&config[i]);
+		pinmux_config_drvgrp(&prog, &config[i]);
+	reg_prog_run(&prog);
 }
 #endif /* TEGRA_PMX_SOC_HAS_DRVGRPS */
 
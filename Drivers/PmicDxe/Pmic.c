@@ -11,6 +11,7 @@
 #include <Library/BaseLib.h>
 #include <Library/CacheMaintenanceLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Foundation/Types.h>
 #include <Device/T210.h>
@@ -46,7 +47,10 @@ SetRegulatorVoltage
 )
 {
     int ret = 0;
+
+    PERF_START(gImageHandle, "LdoSetVoltage", NULL, 0);
     ret = max77620_regulator_set_voltage(DeviceId, Voltage);
+    PERF_END(gImageHandle, "LdoSetVoltage", NULL, 0);
 
     if (ret != 1) return EFI_INVALID_PARAMETER;
     return EFI_SUCCESS;
@@ -60,7 +64,9 @@ EnableRegulator
     UINT32 DeviceId
 )
 {
+    PERF_START(gImageHandle, "LdoEnable", NULL, 0);
     max77620_regulator_enable(DeviceId, 1);
+    PERF_END(gImageHandle, "LdoEnable", NULL, 0);
 }
 
 STATIC
@@ -102,15 +108,23 @@ PmicDxeInitialize
     if (EFI_ERROR(Status)) goto exit;
 
     // Clock init
+    PERF_START(ImageHandle, "I2cInit", NULL, 0);
     Status = mClockProtocol->EnableI2c(I2C_1);
-    if (EFI_ERROR(Status)) goto exit;
+    if (!EFI_ERROR(Status))
+    {
+        Status = mClockProtocol->EnableI2c(I2C_5);
+    }
 
-    Status = mClockProtocol->EnableI2c(I2C_5);
+    // I2C init
+    if (!EFI_ERROR(Status))
+    {
+        i2c_init(I2C_1);
+        i2c_init(I2C_5);
+    }
+    PERF_END(ImageHandle, "I2cInit", NULL, 0);
     if (EFI_ERROR(Status)) goto exit;
 
-    // I2C init
-    i2c_init(I2C_1);
-    i2c_init(I2C_5);
+    PERF_START(ImageHandle, "RegulatorRamp", NULL, 0);
 
 	// Start up the SDMMC1 IO voltage regulator @ 3.3V
     max77620_send_byte(MAX77620_REG_LDO2_CFG, 0xF2);
@@ -128,6 +142,8 @@ PmicDxeInitialize
     // Start up the PCIe power
     max77620_send_byte(MAX77620_REG_LDO1_CFG, 0xCA);
 
+    PERF_END(ImageHandle, "RegulatorRamp", NULL, 0);
+
     // Install protocol
     Status = gBS->InstallMultipleProtocolInterfaces(
         &ProtoHandle,
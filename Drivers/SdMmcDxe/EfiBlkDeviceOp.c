@@ -20,6 +20,8 @@
 #include "Include/SdMmc.h"
 #include "Include/HostOp.h"
 #include "Include/EfiProto.h"
+#include "Include/IoTrace.h"
+#include "Include/WriteCache.h"
 
 STATIC BIO_INSTANCE mBioTemplate = {
     BIO_INSTANCE_SIGNATURE,
@@ -60,6 +62,10 @@ STATIC BIO_INSTANCE mBioTemplate = {
             END_ENTIRE_DEVICE_PATH_SUBTYPE,
             { sizeof (EFI_DEVICE_PATH_PROTOCOL), 0 }
         }
+    },
+    {   // WriteCache
+        NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL_REVISION,
+        MMCHSGetPendingBound
     }
 };
 
@@ -75,7 +81,7 @@ MMCHSReset(
 
 /*
  * Function: MmcReadInternal
- * Arg     : Data address on card, o/p buffer & data length
+ * Arg     : Data address on card, o/p buffer, data length & retry count
  * Return  : 0 on Success, non zero on failure
  * Flow    : Read data from the card to out
  */
@@ -84,7 +90,8 @@ STATIC UINT32 MmcReadInternal
     BIO_INSTANCE *Instance, 
     UINT64 DataAddr, 
     UINT32 *Buf, 
-    UINT32 DataLen
+    UINT32 DataLen,
+    UINT32 *Retries
 )
 {
     UINT32 Ret = 0;
@@ -124,6 +131,7 @@ read:
             if (OpBlkSize > 1)
             {
                 // Decrement op size
+                (*Retries)++;
                 OpBlkSize = OpBlkSize / 2;
                 ReadSize = BlockSize * OpBlkSize;
                 goto read;
@@ -148,6 +156,7 @@ read:
             if (OpBlkSize > 1)
             {
                 // Decrement op size
+                (*Retries)++;
                 OpBlkSize = OpBlkSize / 2;
                 ReadSize = BlockSize * OpBlkSize;
                 goto read;
@@ -179,6 +188,9 @@ MMCHSReadBlocks(
     EFI_BLOCK_IO_MEDIA        *Media;
     UINTN                     BlockSize;
     UINTN                     rc;
+    UINT32                    Retries;
+    IO_TRACE_CONTEXT          Trace;
+    EFI_TPL                   OldTpl;
 
     Instance  = BIO_INSTANCE_FROM_BLOCKIO_THIS(This);
     Media     = &Instance->BlockMedia;
@@ -214,7 +226,23 @@ MMCHSReadBlocks(
         return EFI_SUCCESS;
     }
 
-    rc = MmcReadInternal(Instance, (UINT64) Lba * BlockSize, Buffer, BufferSize);
+    Retries = 0;
+    if (IO_TRACE_ENABLED()) IoTraceBegin(&Trace);
+
+    // Serialize against the write cache flush timer
+    OldTpl = gBS->RaiseTPL(TPL_CALLBACK);
+    rc = MmcReadInternal(Instance, (UINT64) Lba * BlockSize, Buffer, BufferSize, &Retries);
+    if (rc == 1 && WriteCacheEnabled())
+    {
+        WriteCacheOverlay(Lba, BufferSize / BlockSize, Buffer);
+    }
+    gBS->RestoreTPL(OldTpl);
+
+    if (IO_TRACE_ENABLED())
+    {
+        IoTraceEnd(&Trace, BLOCK_IO_TRACE_OP_READ, Lba, (UINT32) (BufferSize / BlockSize), Retries, rc != 1);
+    }
+
     if (rc == 1)
         return EFI_SUCCESS;
     else
@@ -231,7 +259,73 @@ MMCHSWriteBlocks(
     IN VOID                           *Buffer
 )
 {
-    return EFI_UNSUPPORTED;
+    BIO_INSTANCE              *Instance;
+    EFI_BLOCK_IO_MEDIA        *Media;
+    UINTN                     BlockSize;
+    UINTN                     Blocks;
+    EFI_STATUS                Status;
+    IO_TRACE_CONTEXT          Trace;
+    EFI_TPL                   OldTpl;
+
+    Instance  = BIO_INSTANCE_FROM_BLOCKIO_THIS(This);
+    Media     = &Instance->BlockMedia;
+    BlockSize = Media->BlockSize;
+
+    if (MediaId != Media->MediaId) 
+    {
+        return EFI_MEDIA_CHANGED;
+    }
+
+    if (Media->ReadOnly) 
+    {
+        return EFI_WRITE_PROTECTED;
+    }
+
+    if (Lba > Media->LastBlock) 
+    {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    if ((Lba + (BufferSize / BlockSize) - 1) > Media->LastBlock) 
+    {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    if (BufferSize % BlockSize != 0) 
+    {
+        return EFI_BAD_BUFFER_SIZE;
+    }
+
+    if (Buffer == NULL) 
+    {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    if (BufferSize == 0) 
+    {
+        return EFI_SUCCESS;
+    }
+
+    Blocks = BufferSize / BlockSize;
+    if (IO_TRACE_ENABLED()) IoTraceBegin(&Trace);
+
+    OldTpl = gBS->RaiseTPL(TPL_CALLBACK);
+    if (WriteCacheEnabled())
+    {
+        Status = WriteCacheWrite(Lba, Blocks, Buffer);
+    }
+    else
+    {
+        Status = (mmc_bwrite(Lba, Blocks, Buffer) == Blocks) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+    }
+    gBS->RestoreTPL(OldTpl);
+
+    if (IO_TRACE_ENABLED())
+    {
+        IoTraceEnd(&Trace, BLOCK_IO_TRACE_OP_WRITE, Lba, (UINT32) Blocks, 0, EFI_ERROR(Status));
+    }
+
+    return Status;
 }
 
 EFI_STATUS
@@ -240,6 +334,38 @@ MMCHSFlushBlocks(
     IN EFI_BLOCK_IO_PROTOCOL  *This
 )
 {
+    EFI_STATUS                Status;
+    IO_TRACE_CONTEXT          Trace;
+    EFI_TPL                   OldTpl;
+
+    if (IO_TRACE_ENABLED()) IoTraceBegin(&Trace);
+
+    OldTpl = gBS->RaiseTPL(TPL_CALLBACK);
+    Status = WriteCacheFlush();
+    gBS->RestoreTPL(OldTpl);
+
+    if (IO_TRACE_ENABLED())
+    {
+        IoTraceEnd(&Trace, BLOCK_IO_TRACE_OP_FLUSH, 0, 0, 0, EFI_ERROR(Status));
+    }
+
+    return Status;
+}
+
+EFI_STATUS
+EFIAPI
+MMCHSGetPendingBound(
+    IN NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL  *This,
+    OUT UINTN                                   *PendingBytes,
+    OUT UINT32                                  *FlushIntervalMs OPTIONAL
+)
+{
+    if (PendingBytes == NULL)
+    {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    *PendingBytes = WriteCacheGetPendingBound(FlushIntervalMs);
     return EFI_SUCCESS;
 }
 
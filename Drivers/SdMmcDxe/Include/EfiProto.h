@@ -4,6 +4,7 @@
 #include <Uefi.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/SdWriteCache.h>
 
 //
 // Device structures
@@ -19,10 +20,12 @@ typedef struct {
     EFI_BLOCK_IO_PROTOCOL                 BlockIo;
     EFI_BLOCK_IO_MEDIA                    BlockMedia;
     MMCHS_DEVICE_PATH                     DevicePath;
+    NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL WriteCache;
 } BIO_INSTANCE;
 
 #define BIO_INSTANCE_SIGNATURE SIGNATURE_32('e', 'm', 'm', 'c')
 #define BIO_INSTANCE_FROM_BLOCKIO_THIS(a) CR(a, BIO_INSTANCE, BlockIo, BIO_INSTANCE_SIGNATURE)
+#define BIO_INSTANCE_FROM_WRITE_CACHE_THIS(a) CR(a, BIO_INSTANCE, WriteCache, BIO_INSTANCE_SIGNATURE)
 
 //
 // Function Prototypes
@@ -61,6 +64,14 @@ MMCHSFlushBlocks(
     IN EFI_BLOCK_IO_PROTOCOL  *This
 );
 
+EFI_STATUS
+EFIAPI
+MMCHSGetPendingBound(
+    IN NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL  *This,
+    OUT UINTN                                   *PendingBytes,
+    OUT UINT32                                  *FlushIntervalMs OPTIONAL
+);
+
 EFI_STATUS
 BioInstanceContructor(
     OUT BIO_INSTANCE** NewInstance
@@ -16,5 +16,7 @@ SdFxInitFinalize
 );
 
 ulong mmc_bread(UINT64 start, UINT64 blkcnt, void *dst);
+ulong mmc_bwrite(UINT64 start, UINT64 blkcnt, const void *src);
+ulong mmc_berase(UINT64 start, UINT64 blkcnt);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef __SDMMC_IO_TRACE_H__
+#define __SDMMC_IO_TRACE_H__
+
+#include <Uefi.h>
+#include <Library/PcdLib.h>
+#include <Guid/BlockIoTrace.h>
+
+typedef struct {
+    UINT64  StartTicks;
+    UINT32  Bounces;
+} IO_TRACE_CONTEXT;
+
+extern BLOCK_IO_TRACE_HEADER *mIoTrace;
+extern UINT32 mIoTraceBounces;
+
+//
+// PcdBlockIoTraceEnable is a feature flag, so every trace site folds
+// away at compile time when tracing is disabled.
+//
+#define IO_TRACE_ENABLED() \
+    (FeaturePcdGet(PcdBlockIoTraceEnable) && mIoTrace != NULL)
+
+#define IO_TRACE_NOTE_BOUNCE() \
+    do { if (FeaturePcdGet(PcdBlockIoTraceEnable)) mIoTraceBounces++; } while (0)
+
+EFI_STATUS
+IoTraceInitialize(
+    VOID
+);
+
+VOID
+IoTraceBegin(
+    OUT IO_TRACE_CONTEXT    *Context
+);
+
+VOID
+IoTraceEnd(
+    IN IO_TRACE_CONTEXT     *Context,
+    IN UINT8                Op,
+    IN UINT64               Lba,
+    IN UINT32               Blocks,
+    IN UINT32               Retries,
+    IN BOOLEAN              Failed
+);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef __MMC_TIMING_H__
+#define __MMC_TIMING_H__
+
+#include "SdMmc.h"
+
+/* Ceiling for the exponential back-off between register/status polls */
+#define MMC_POLL_MAX_BACKOFF_US		256
+
+/* Limit for a response to show up, the controller flags CMD_TIMEOUT well before */
+#define MMC_CMD_TIMEOUT_US		100000
+
+/* Data phase limit, scaled with the number of blocks moved */
+#define MMC_DATA_TIMEOUT_US		250000
+#define MMC_DATA_TIMEOUT_PER_BLOCK_US	100
+
+int mmc_poll_bits(
+	void *reg,
+	u32 mask,
+	int set,
+	unsigned long timeout_us,
+	u32 *last
+);
+
+void mmc_cmd_pre_delay(
+	struct tegra_mmc_priv *priv,
+	struct mmc_cmd *cmd
+);
+
+unsigned int mmc_cmd_busy_timeout_ms(
+	struct mmc_cmd *cmd
+);
+
+void mmc_cmd_record(
+	struct mmc_cmd *cmd,
+	UINT64 start_us,
+	int err
+);
+
+void mmc_dump_cmd_stats(void);
+
+#endif
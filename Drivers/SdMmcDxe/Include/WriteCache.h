@@ -0,0 +1,40 @@
+#ifndef __SDMMC_WRITE_CACHE_H__
+#define __SDMMC_WRITE_CACHE_H__
+
+#include <Uefi.h>
+
+EFI_STATUS
+WriteCacheInitialize(
+    IN UINT32   BlockSize
+);
+
+BOOLEAN
+WriteCacheEnabled(
+    VOID
+);
+
+EFI_STATUS
+WriteCacheWrite(
+    IN UINT64       Lba,
+    IN UINTN        Blocks,
+    IN CONST VOID   *Buffer
+);
+
+VOID
+WriteCacheOverlay(
+    IN UINT64       Lba,
+    IN UINTN        Blocks,
+    IN OUT VOID     *Buffer
+);
+
+EFI_STATUS
+WriteCacheFlush(
+    VOID
+);
+
+UINTN
+WriteCacheGetPendingBound(
+    OUT UINT32      *FlushIntervalMs OPTIONAL
+);
+
+#endif
@@ -0,0 +1,124 @@
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+
+#include "Include/IoTrace.h"
+
+BLOCK_IO_TRACE_HEADER *mIoTrace = NULL;
+UINT32 mIoTraceBounces = 0;
+
+/*
+ * Function: IoTraceInitialize
+ * Flow    : Allocate the trace ring in reserved memory and publish it as a
+ *           configuration table, so it survives ExitBootServices() and can
+ *           be picked up by the OS or by BlockIoTraceDump.
+ */
+EFI_STATUS
+IoTraceInitialize(
+    VOID
+)
+{
+    EFI_STATUS Status;
+    UINT32 RecordCount;
+    UINTN Size;
+    BLOCK_IO_TRACE_HEADER *Header;
+
+    if (!FeaturePcdGet(PcdBlockIoTraceEnable))
+    {
+        return EFI_SUCCESS;
+    }
+
+    RecordCount = FixedPcdGet32(PcdBlockIoTraceRecordCount);
+    ASSERT(RecordCount != 0 && (RecordCount & (RecordCount - 1)) == 0);
+
+    Size = sizeof(BLOCK_IO_TRACE_HEADER) + RecordCount * sizeof(BLOCK_IO_TRACE_RECORD);
+    Header = AllocateReservedPages(EFI_SIZE_TO_PAGES(Size));
+    if (Header == NULL)
+    {
+        DEBUG((EFI_D_ERROR, "%a: failed to allocate trace ring\n", __FUNCTION__));
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    ZeroMem(Header, Size);
+    Header->Signature = BLOCK_IO_TRACE_SIGNATURE;
+    Header->Version = BLOCK_IO_TRACE_VERSION;
+    Header->RecordSize = sizeof(BLOCK_IO_TRACE_RECORD);
+    Header->RecordCount = RecordCount;
+    Header->TimerFrequency = GetPerformanceCounterProperties(NULL, NULL);
+
+    Status = gBS->InstallConfigurationTable(&gNintendoSwitchBlockIoTraceTableGuid, Header);
+    if (EFI_ERROR(Status))
+    {
+        FreePages(Header, EFI_SIZE_TO_PAGES(Size));
+        return Status;
+    }
+
+    mIoTrace = Header;
+    DEBUG((EFI_D_INFO, "Block I/O trace: %d records at 0x%p\n", RecordCount, Header));
+
+    return EFI_SUCCESS;
+}
+
+VOID
+IoTraceBegin(
+    OUT IO_TRACE_CONTEXT    *Context
+)
+{
+    Context->Bounces = mIoTraceBounces;
+    Context->StartTicks = GetPerformanceCounter();
+}
+
+/*
+ * Function: IoTraceEnd
+ * Flow    : Claim the next slot with an atomic increment of Head and fill
+ *           it in. Sequence is stored last so a reader can tell a finished
+ *           record from one that is still being written or was overwritten.
+ */
+VOID
+IoTraceEnd(
+    IN IO_TRACE_CONTEXT     *Context,
+    IN UINT8                Op,
+    IN UINT64               Lba,
+    IN UINT32               Blocks,
+    IN UINT32               Retries,
+    IN BOOLEAN              Failed
+)
+{
+    UINT64 EndTicks;
+    UINT32 Index;
+    BLOCK_IO_TRACE_RECORD *Record;
+
+    EndTicks = GetPerformanceCounter();
+    Index = InterlockedIncrement(&mIoTrace->Head) - 1;
+    Record = &BLOCK_IO_TRACE_RECORDS(mIoTrace)[Index & (mIoTrace->RecordCount - 1)];
+
+    Record->Sequence = 0;
+    MemoryFence();
+
+    Record->Op = Op;
+    Record->Flags = 0;
+    if (mIoTraceBounces != Context->Bounces)
+    {
+        Record->Flags |= BLOCK_IO_TRACE_FLAG_BOUNCE;
+    }
+    if (Failed)
+    {
+        Record->Flags |= BLOCK_IO_TRACE_FLAG_ERROR;
+    }
+    Record->Retries = (UINT16) MIN(Retries, MAX_UINT16);
+    Record->Lba = Lba;
+    Record->Blocks = Blocks;
+    Record->StartTicks = Context->StartTicks;
+    Record->EndTicks = EndTicks;
+
+    MemoryFence();
+    Record->Sequence = Index + 1;
+}
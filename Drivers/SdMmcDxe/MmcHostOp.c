@@ -34,6 +34,8 @@
 #include <Library/Utc/BounceBuf.h>
 
 #include "Include/TegraMmc.h"
+#include "Include/IoTrace.h"
+#include "Include/MmcTiming.h"
 
 extern struct mmc mMmcInstance;
 extern TEGRA_MMC_PRIV mPriv;
@@ -101,8 +103,7 @@ static int mmc_go_idle()
 	struct mmc_cmd cmd;
 	int err;
 
-	udelay(1000);
-
+	/* The power-up clocks ahead of CMD0 are handled by the command timing */
 	cmd.cmdidx = MMC_CMD_GO_IDLE_STATE;
 	cmd.cmdarg = 0;
 	cmd.resp_type = MMC_RSP_NONE;
@@ -111,8 +112,6 @@ static int mmc_go_idle()
 
 	if (err) return err;
 
-	udelay(2000);
-
 	return 0;
 }
 
@@ -286,6 +285,8 @@ int mmc_send_status(struct mmc *mmc, int timeout)
 {
 	struct mmc_cmd cmd;
 	int err, retries = 5;
+	UINT64 start = get_timer(0);
+	uint backoff = 1;
 
 	cmd.cmdidx = MMC_CMD_SEND_STATUS;
 	cmd.resp_type = MMC_RSP_R1;
@@ -310,14 +311,15 @@ int mmc_send_status(struct mmc *mmc, int timeout)
 			return err;
 		}
 
-		if (timeout-- <= 0) break;
-		udelay(1000);
-	}
+		/* timeout is in ms, back off in us steps in between */
+		if (get_timer(start) >= (UINT64) timeout * 1000) 
+		{
+			printf("Timeout waiting card ready\n");
+			return -ETIMEDOUT;
+		}
 
-	if (timeout <= 0) 
-	{
-		printf("Timeout waiting card ready\n");
-		return -ETIMEDOUT;
+		udelay(backoff);
+		backoff = MIN(backoff * 2, MMC_POLL_MAX_BACKOFF_US);
 	}
 
 	return 0;
@@ -843,7 +845,7 @@ static int mmc_read_blocks(
 	return blkcnt;
 }
 
-ulong mmc_bread(UINT64 start, UINT64 blkcnt, void *dst)
+static ulong mmc_bread_internal(UINT64 start, UINT64 blkcnt, void *dst)
 {
 	struct mmc *mmc = &mMmcInstance;
 	struct blk_desc *block_dev = &mBlkDesc;
@@ -885,6 +887,210 @@ exit:
 	return err;
 }
 
+ulong mmc_bread(UINT64 start, UINT64 blkcnt, void *dst)
+{
+	IO_TRACE_CONTEXT trace;
+	ulong ret;
+
+	if (!IO_TRACE_ENABLED())
+		return mmc_bread_internal(start, blkcnt, dst);
+
+	IoTraceBegin(&trace);
+	ret = mmc_bread_internal(start, blkcnt, dst);
+	IoTraceEnd(&trace, BLOCK_IO_TRACE_OP_BREAD, start, (UINT32) blkcnt, 0,
+		ret != blkcnt);
+
+	return ret;
+}
+
+static ulong mmc_write_blocks(
+	struct mmc *mmc, lbaint_t start, 
+	lbaint_t blkcnt, const void *src
+)
+{
+	struct mmc_cmd cmd;
+	struct mmc_data data;
+	int timeout = 1000;
+
+	if (blkcnt == 0)
+		return 0;
+	else if (blkcnt == 1)
+		cmd.cmdidx = MMC_CMD_WRITE_SINGLE_BLOCK;
+	else
+		cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
+
+	if (mmc->high_capacity)
+		cmd.cmdarg = start;
+	else
+		cmd.cmdarg = start * mmc->write_bl_len;
+
+	cmd.resp_type = MMC_RSP_R1;
+
+	data.src = src;
+	data.blocks = blkcnt;
+	data.blocksize = mmc->write_bl_len;
+	data.flags = MMC_DATA_WRITE;
+
+	if (tegra_mmc_send_cmd(&mPriv, &cmd, &data)) 
+	{
+		printf("mmc write failed\n");
+		return 0;
+	}
+
+	if (blkcnt > 1) 
+	{
+		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+		cmd.cmdarg = 0;
+		cmd.resp_type = MMC_RSP_R1b;
+		if (tegra_mmc_send_cmd(&mPriv, &cmd, NULL)) 
+		{
+			printf("mmc fail to send stop cmd\n");
+			return 0;
+		}
+	}
+
+	/* Waiting for the ready status */
+	if (mmc_send_status(mmc, timeout))
+		return 0;
+
+	return blkcnt;
+}
+
+ulong mmc_bwrite(UINT64 start, UINT64 blkcnt, const void *src)
+{
+	struct mmc *mmc = &mMmcInstance;
+	struct blk_desc *block_dev = &mBlkDesc;
+	const UINT8 *cur_src = src;
+	lbaint_t cur, blocks_todo = blkcnt;
+
+	if (mmc_select_hwpart(block_dev->hwpart))
+		return 0;
+
+	if ((start + blkcnt) > block_dev->lba) 
+	{
+		DEBUG((EFI_D_ERROR, "MMC: block number 0x%llx exceeds max(0x%llx)\n",
+			start + blkcnt, block_dev->lba));
+		return 0;
+	}
+
+	if (mmc_set_blocklen(mmc, mmc->write_bl_len)) 
+	{
+		DEBUG((EFI_D_ERROR, "%s: Failed to set blocklen\n", __func__));
+		return 0;
+	}
+
+	do {
+		cur = (blocks_todo > mmc->cfg->b_max) ?
+			mmc->cfg->b_max : blocks_todo;
+		if (mmc_write_blocks(mmc, start, cur, cur_src) != cur) 
+		{
+			DEBUG((EFI_D_ERROR, "%s: Failed to write blocks\n", __func__));
+			return 0;
+		}
+		blocks_todo -= cur;
+		start += cur;
+		cur_src += cur * mmc->write_bl_len;
+	} 
+	while (blocks_todo > 0);
+
+	return blkcnt;
+}
+
+static int mmc_erase_t(struct mmc *mmc, ulong start, lbaint_t blkcnt)
+{
+	struct mmc_cmd cmd;
+	ulong end;
+	int err, start_cmd, end_cmd;
+
+	if (mmc->high_capacity) 
+	{
+		end = start + blkcnt - 1;
+	} 
+	else 
+	{
+		end = (start + blkcnt - 1) * mmc->write_bl_len;
+		start *= mmc->write_bl_len;
+	}
+
+	if (IS_SD(mmc)) 
+	{
+		start_cmd = SD_CMD_ERASE_WR_BLK_START;
+		end_cmd = SD_CMD_ERASE_WR_BLK_END;
+	} 
+	else 
+	{
+		start_cmd = MMC_CMD_ERASE_GROUP_START;
+		end_cmd = MMC_CMD_ERASE_GROUP_END;
+	}
+
+	cmd.cmdidx = start_cmd;
+	cmd.cmdarg = start;
+	cmd.resp_type = MMC_RSP_R1;
+
+	err = tegra_mmc_send_cmd(&mPriv, &cmd, NULL);
+	if (err) goto err_out;
+
+	cmd.cmdidx = end_cmd;
+	cmd.cmdarg = end;
+
+	err = tegra_mmc_send_cmd(&mPriv, &cmd, NULL);
+	if (err) goto err_out;
+
+	cmd.cmdidx = MMC_CMD_ERASE;
+	cmd.cmdarg = MMC_ERASE_ARG;
+	cmd.resp_type = MMC_RSP_R1b;
+
+	err = tegra_mmc_send_cmd(&mPriv, &cmd, NULL);
+	if (err) goto err_out;
+
+	return 0;
+
+err_out:
+	printf("mmc erase failed\n");
+	return err;
+}
+
+/*
+ * Erase blkcnt blocks starting at start. The caller is expected to pass
+ * whole erase groups; for SD cards the erase group is a single block, and
+ * the busy time is bounded by the SSR erase timing for each AU touched.
+ */
+ulong mmc_berase(UINT64 start, UINT64 blkcnt)
+{
+	struct mmc *mmc = &mMmcInstance;
+	struct blk_desc *block_dev = &mBlkDesc;
+	int timeout = 1000;
+	uint nr_au;
+
+	if (blkcnt == 0)
+		return 0;
+
+	if (mmc_select_hwpart(block_dev->hwpart))
+		return 0;
+
+	if ((start + blkcnt) > block_dev->lba) 
+	{
+		DEBUG((EFI_D_ERROR, "MMC: block number 0x%llx exceeds max(0x%llx)\n",
+			start + blkcnt, block_dev->lba));
+		return 0;
+	}
+
+	if (IS_SD(mmc) && mmc->ssr.au && mmc->ssr.erase_timeout) 
+	{
+		nr_au = DIV_ROUND_UP(blkcnt, mmc->ssr.au);
+		timeout = nr_au * mmc->ssr.erase_timeout + mmc->ssr.erase_offset;
+	}
+
+	if (mmc_erase_t(mmc, start, blkcnt))
+		return 0;
+
+	/* Waiting for the ready status */
+	if (mmc_send_status(mmc, timeout))
+		return 0;
+
+	return blkcnt;
+}
+
 EFIAPI
 int
 SdFxInit(
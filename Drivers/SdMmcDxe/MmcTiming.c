@@ -0,0 +1,186 @@
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/IoLib.h>
+
+#include <Protocol/Utc/ErrNo.h>
+#include <Protocol/Utc/Mmc.h>
+
+#include <Foundation/Types.h>
+#include <Shim/DebugLib.h>
+#include <Shim/UBootIo.h>
+#include <Shim/TimerLib.h>
+#include <Shim/Kernel.h>
+#include <Library/Utc/BounceBuf.h>
+
+#include "Include/SdMmc.h"
+#include "Include/MmcTiming.h"
+
+/*
+ * Command timing for the SD host layer.
+ *
+ * Commands are driven by polling the controller status with a short
+ * exponential back-off instead of fixed millisecond sleeps. Extra delays
+ * are only inserted where the spec asks for them, and the wall-clock
+ * latency of every command is accounted per opcode.
+ */
+
+/* CMDn live in slots 0-63, ACMDn (preceded by CMD55) in 64-127 */
+#define MMC_OPCODE_SLOTS	128
+#define MMC_ACMD_SLOT		64
+
+/* R1b busy limit when the table below does not say otherwise */
+#define MMC_BUSY_TIMEOUT_MS	1000
+
+struct mmc_cmd_timing {
+	ushort cmdidx;
+	uint pre_clocks;	/* SD clock cycles needed before the command */
+	uint busy_timeout_ms;	/* R1b busy limit, 0 leaves it to the caller */
+};
+
+struct mmc_cmd_stat {
+	uint count;
+	uint errors;
+	UINT64 total_us;
+	uint min_us;
+	uint max_us;
+};
+
+static const struct mmc_cmd_timing mmc_cmd_timings[] = {
+	/* 74 clocks on the bus after power up before the first command */
+	{ MMC_CMD_GO_IDLE_STATE,	74,	MMC_BUSY_TIMEOUT_MS },
+	/* Erase time depends on the range, mmc_berase polls CMD13 */
+	{ MMC_CMD_ERASE,		0,	0 },
+};
+
+static struct mmc_cmd_stat mmc_cmd_stats[MMC_OPCODE_SLOTS];
+static int mmc_app_cmd_pending;
+
+static const struct mmc_cmd_timing *mmc_cmd_find_timing(struct mmc_cmd *cmd)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(mmc_cmd_timings); i++) {
+		if (mmc_cmd_timings[i].cmdidx == cmd->cmdidx)
+			return &mmc_cmd_timings[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Poll reg until any bit of mask is set (set != 0) or all of them are
+ * clear (set == 0). The first reads are back to back, after that the
+ * delay doubles up to MMC_POLL_MAX_BACKOFF_US, so a quick transition is
+ * seen within microseconds and a slow one does not hammer the bus.
+ */
+int mmc_poll_bits(
+	void *reg,
+	u32 mask,
+	int set,
+	unsigned long timeout_us,
+	u32 *last
+)
+{
+	UINT64 start = get_timer(0);
+	uint backoff = 0;
+	u32 val;
+
+	while (1) {
+		val = readl(reg);
+		if (((val & mask) != 0) == (set != 0))
+			break;
+
+		if (get_timer(start) >= timeout_us) {
+			if (last)
+				*last = val;
+			return -ETIMEDOUT;
+		}
+
+		if (backoff)
+			udelay(backoff);
+		backoff = backoff ? MIN(backoff * 2, MMC_POLL_MAX_BACKOFF_US) : 1;
+	}
+
+	if (last)
+		*last = val;
+
+	return 0;
+}
+
+void mmc_cmd_pre_delay(
+	struct tegra_mmc_priv *priv,
+	struct mmc_cmd *cmd
+)
+{
+	const struct mmc_cmd_timing *timing = mmc_cmd_find_timing(cmd);
+
+	if (!timing || !timing->pre_clocks)
+		return;
+
+	/* Clock not running yet, nothing on the bus to count */
+	if (!priv->clock)
+		return;
+
+	udelay(DIV_ROUND_UP((UINT64) timing->pre_clocks * 1000000, priv->clock));
+}
+
+unsigned int mmc_cmd_busy_timeout_ms(
+	struct mmc_cmd *cmd
+)
+{
+	const struct mmc_cmd_timing *timing = mmc_cmd_find_timing(cmd);
+
+	return timing ? timing->busy_timeout_ms : MMC_BUSY_TIMEOUT_MS;
+}
+
+void mmc_cmd_record(
+	struct mmc_cmd *cmd,
+	UINT64 start_us,
+	int err
+)
+{
+	struct mmc_cmd_stat *stat;
+	uint slot = cmd->cmdidx & (MMC_ACMD_SLOT - 1);
+	uint elapsed = (uint) get_timer(start_us);
+
+	if (mmc_app_cmd_pending)
+		slot += MMC_ACMD_SLOT;
+	mmc_app_cmd_pending = (cmd->cmdidx == MMC_CMD_APP_CMD) && !err;
+
+	stat = &mmc_cmd_stats[slot];
+	if (!stat->count || elapsed < stat->min_us)
+		stat->min_us = elapsed;
+	if (elapsed > stat->max_us)
+		stat->max_us = elapsed;
+	stat->count++;
+	stat->total_us += elapsed;
+	if (err)
+		stat->errors++;
+}
+
+void mmc_dump_cmd_stats(void)
+{
+	struct mmc_cmd_stat *stat;
+	UINT64 total = 0;
+	int i;
+
+	for (i = 0; i < MMC_OPCODE_SLOTS; i++) {
+		stat = &mmc_cmd_stats[i];
+		if (!stat->count)
+			continue;
+
+		DEBUG((EFI_D_INFO, "%a%d: %d cmds, %d errors, avg %d us, min %d us, max %d us\n",
+		      (i >= MMC_ACMD_SLOT) ? "ACMD" : "CMD",
+		      i & (MMC_ACMD_SLOT - 1), stat->count, stat->errors,
+		      (uint) DivU64x32(stat->total_us, stat->count),
+		      stat->min_us, stat->max_us));
+		total += stat->total_us;
+	}
+
+	DEBUG((EFI_D_INFO, "MMC commands took %ld us in total\n", total));
+}
@@ -15,6 +15,7 @@
 #include <Protocol/BlockIo2.h>
 #include <Protocol/DevicePath.h>
 #include <Library/ArmLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Protocol/UBootClockManagement.h>
 #include <Protocol/Utc/Clock.h>
@@ -31,11 +32,15 @@
 #include <Shim/UBootIo.h>
 #include <Shim/TimerLib.h>
 #include <Shim/BitOps.h>
+#include <Shim/Kernel.h>
 #include <Library/Utc/BounceBuf.h>
 
 #include "Include/SdMmc.h"
 #include "Include/HostOp.h"
 #include "Include/EfiProto.h"
+#include "Include/IoTrace.h"
+#include "Include/WriteCache.h"
+#include "Include/MmcTiming.h"
 
 TEGRA210_UBOOT_CLOCK_MANAGEMENT_PROTOCOL* mClkProtocol;
 PMIC_PROTOCOL* mPmicProtocol;
@@ -44,6 +49,11 @@ TEGRA_MMC_PRIV mPriv;
 struct mmc mMmcInstance;
 struct blk_desc mBlkDesc;
 
+// Peripherals brought up together, &tegra_car 14. SDMMC1 is the only one:
+// its pads and IO rail have no CAR reset or clock enable bit, and this
+// driver does not use the SDMMC legacy timeout clock.
+STATIC CONST UINT64 mSdPeriphs[] = { PERIPH_ID_SDMMC1 };
+
 void tegra_mmc_set_power(
     struct tegra_mmc_priv *priv,
     unsigned short power)
@@ -159,19 +169,20 @@ int tegra_mmc_wait_inhibit(
 	if ((data == NULL) && (cmd->resp_type & MMC_RSP_BUSY))
 		mask |= TEGRA_MMC_PRNSTS_CMD_INHIBIT_DAT;
 
-	while (readl(&priv->reg->prnsts) & mask) {
-		if (timeout == 0) {
-			printf("%s: timeout error\n", __func__);
-			return -1;
-		}
-		timeout--;
-		udelay(1000);
+	if (mmc_poll_bits(&priv->reg->prnsts, mask, 0, timeout * 1000, NULL)) {
+		printf("%s: timeout error\n", __func__);
+		return -1;
 	}
 
 	return 0;
 }
 
-int tegra_mmc_send_cmd_bounced(
+/*
+ * Issue a command and walk it through its phases: response, R1b busy
+ * and data transfer. Each phase polls the controller status and returns
+ * as soon as it is done; there is no fixed settle delay at the end.
+ */
+static int tegra_mmc_run_cmd(
     struct tegra_mmc_priv *priv, 
     struct mmc_cmd *cmd,
     struct mmc_data *data,
@@ -179,15 +190,9 @@ int tegra_mmc_send_cmd_bounced(
 )
 {
 	int flags, i;
-	int result;
 	unsigned int mask = 0;
-	unsigned int retry = 0x100000;
-	debug(" mmc_send_cmd called\n");
-
-	result = tegra_mmc_wait_inhibit(priv, cmd, data, 10 /* ms */);
-
-	if (result < 0)
-		return result;
+	unsigned int busy_ms;
+	unsigned long data_timeout;
 
 	if (data)
 		tegra_mmc_prepare_data(priv, data, bbstate);
@@ -236,24 +241,20 @@ int tegra_mmc_send_cmd_bounced(
 
 	writew((cmd->cmdidx << 8) | flags, &priv->reg->cmdreg);
 
-	for (i = 0; i < retry; i++) 
-	{
-		mask = readl(&priv->reg->norintsts);
-		/* Command Complete */
-		if (mask & TEGRA_MMC_NORINTSTS_CMD_COMPLETE) 
-		{
-			if (!data) writel(mask, &priv->reg->norintsts);
-			break;
-		}
-	}
-
-	if (i == retry) 
+	/* Command Complete, or an error such as a response timeout */
+	if (mmc_poll_bits(&priv->reg->norintsts,
+			  TEGRA_MMC_NORINTSTS_CMD_COMPLETE |
+			  TEGRA_MMC_NORINTSTS_ERR_INTERRUPT,
+			  1, MMC_CMD_TIMEOUT_US, &mask)) 
 	{
 		printf("%s: waiting for status update\n", __func__);
 		writel(mask, &priv->reg->norintsts);
 		return -ETIMEDOUT;
 	}
 
+	if ((mask & TEGRA_MMC_NORINTSTS_CMD_COMPLETE) && !data)
+		writel(mask, &priv->reg->norintsts);
+
 	if (mask & TEGRA_MMC_NORINTSTS_CMD_TIMEOUT) 
 	{
 		/* Timeout Error */
@@ -289,15 +290,11 @@ int tegra_mmc_send_cmd_bounced(
 		} 
 		else if (cmd->resp_type & MMC_RSP_BUSY) 
 		{
-			for (i = 0; i < retry; i++) 
-			{
-				/* PRNTDATA[23:20] : DAT[3:0] Line Signal */
-				if (readl(&priv->reg->prnsts)
-					& (1 << 20))	/* DAT[0] */
-					break;
-			}
-
-			if (i == retry) 
+			/* PRNTDATA[23:20] : DAT[3:0] Line Signal, DAT[0] high when idle */
+			busy_ms = mmc_cmd_busy_timeout_ms(cmd);
+			if (busy_ms &&
+			    mmc_poll_bits(&priv->reg->prnsts, 1 << 20, 1,
+					  busy_ms * 1000, NULL)) 
 			{
 				printf("%s: card is still busy\n", __func__);
 				writel(mask, &priv->reg->norintsts);
@@ -318,6 +315,9 @@ int tegra_mmc_send_cmd_bounced(
 	{
 		unsigned long start = get_timer(0);
 
+		data_timeout = MMC_DATA_TIMEOUT_US +
+			data->blocks * MMC_DATA_TIMEOUT_PER_BLOCK_US;
+
 		while (1) 
 		{
 			mask = readl(&priv->reg->norintsts);
@@ -349,7 +349,7 @@ int tegra_mmc_send_cmd_bounced(
 				debug("r/w is done\n");
 				break;
 			} 
-			else if (get_timer(start) > 8000UL) 
+			else if (get_timer(start) > data_timeout) 
 			{
 				writel(mask, &priv->reg->norintsts);
 				printf("%s: MMC Timeout\n"
@@ -367,10 +367,35 @@ int tegra_mmc_send_cmd_bounced(
 		writel(mask, &priv->reg->norintsts);
 	}
 
-	udelay(1000);
 	return 0;
 }
 
+int tegra_mmc_send_cmd_bounced(
+    struct tegra_mmc_priv *priv, 
+    struct mmc_cmd *cmd,
+    struct mmc_data *data,
+    struct bounce_buffer *bbstate
+)
+{
+	int result;
+	UINT64 start;
+	debug(" mmc_send_cmd called\n");
+
+	result = tegra_mmc_wait_inhibit(priv, cmd, data, 10 /* ms */);
+
+	if (result < 0)
+		return result;
+
+	/* Only the delays the spec asks for, e.g. clocks ahead of CMD0 */
+	mmc_cmd_pre_delay(priv, cmd);
+
+	start = get_timer(0);
+	result = tegra_mmc_run_cmd(priv, cmd, data, bbstate);
+	mmc_cmd_record(cmd, start, result);
+
+	return result;
+}
+
 int tegra_mmc_send_cmd(
     struct tegra_mmc_priv *priv, 
     struct mmc_cmd *cmd,
@@ -398,6 +423,8 @@ int tegra_mmc_send_cmd(
 		len = data->blocks * data->blocksize;
 
 		bounce_buffer_start(&bbstate, buf, len, bbflags);
+		if (bbstate.bounce_buffer != bbstate.user_buffer)
+			IO_TRACE_NOTE_BOUNCE();
 	}
 
 	ret = tegra_mmc_send_cmd_bounced(priv, cmd, data, &bbstate);
@@ -643,11 +670,8 @@ SdControllerProbe
     // sdhci@700b0000
     mPriv.reg = (VOID*) (UINTN) 0x700b0000;
 
-    // Reset controller 1, &tegra_car 14
-    mClkProtocol->AssertRst(PERIPH_ID_SDMMC1);
-
-    // Clock enable, TEGRA210_CLK_SDMMC1
-    mClkProtocol->EnableClk(PERIPH_ID_SDMMC1);
+    // Reset controller 1 and enable TEGRA210_CLK_SDMMC1
+    mClkProtocol->HoldPeriphs(mSdPeriphs, ARRAY_SIZE(mSdPeriphs));
 
     // Set Rate
     ret = mClkProtocol->SetRate(PERIPH_ID_SDMMC1, 20000000);
@@ -658,7 +682,7 @@ SdControllerProbe
     }
 
     // De-assert
-    mClkProtocol->DeassertRst(PERIPH_ID_SDMMC1);
+    mClkProtocol->ReleasePeriphs(mSdPeriphs, ARRAY_SIZE(mSdPeriphs), 0);
 
     // Detect card
     if(!!gpio_read(GPIO_PORT_Z, GPIO_PIN_1))
@@ -684,6 +708,7 @@ SdMmcDxeInitialize
 )
 {
     EFI_STATUS Status;
+    EFI_STATUS CacheStatus;
 	BIO_INSTANCE *Instance;
 
     Status = gBS->LocateProtocol(
@@ -702,20 +727,35 @@ SdMmcDxeInitialize
 
     if (EFI_ERROR(Status)) goto exit;
 
+    // Tracing is optional, keep going without it
+    if (EFI_ERROR(IoTraceInitialize()))
+    {
+        DEBUG((EFI_D_ERROR, "Block I/O trace unavailable \n"));
+    }
+
+    PERF_START(ImageHandle, "SdProbe", NULL, 0);
     Status = SdControllerProbe();
+    PERF_END(ImageHandle, "SdProbe", NULL, 0);
     if (EFI_ERROR(Status)) goto exit;
 
+	PERF_START(ImageHandle, "SdHostInit", NULL, 0);
 	Status = TegraMmcInit();
+	PERF_END(ImageHandle, "SdHostInit", NULL, 0);
 	if (EFI_ERROR(Status)) goto exit;
 
 	// Check some commands
+	PERF_START(ImageHandle, "SdCardInit", NULL, 0);
 	int ret = SdFxInit();
+	PERF_END(ImageHandle, "SdCardInit", NULL, 0);
 	if (ret) 
 	{
 		Status = EFI_DEVICE_ERROR;
 		goto exit;
 	}
+
+	PERF_START(ImageHandle, "SdCardFinalize", NULL, 0);
 	ret = SdFxInitFinalize();
+	PERF_END(ImageHandle, "SdCardFinalize", NULL, 0);
 	if (ret) 
 	{
 		Status = EFI_DEVICE_ERROR;
@@ -731,6 +771,7 @@ SdMmcDxeInitialize
 		UINT8 BlkDump[512];
 		ZeroMem(BlkDump, 512);
 		BOOLEAN FoundMbr = FALSE;
+		PERF_START(ImageHandle, "SdSelfTest", NULL, 0);
 		for (UINTN i = 0; i <= MIN(mBlkDesc.lba, 50); i++)
 		{
 			int blk = mmc_bread(i, 1, &BlkDump);
@@ -745,6 +786,7 @@ SdMmcDxeInitialize
 				DEBUG((EFI_D_INFO, "MBR not found at %d \n", i));
 			}
 		}
+		PERF_END(ImageHandle, "SdSelfTest", NULL, 0);
 
 		if (!FoundMbr)
 		{
@@ -760,6 +802,16 @@ SdMmcDxeInitialize
 
 		Instance->BlockMedia.BlockSize = mBlkDesc.blksz;
 		Instance->BlockMedia.LastBlock = mBlkDesc.lba;
+
+		if (FeaturePcdGet(PcdSdMmcWriteEnable))
+		{
+			Instance->BlockMedia.ReadOnly = FALSE;
+			if (EFI_ERROR(WriteCacheInitialize(mBlkDesc.blksz)))
+			{
+				DEBUG((EFI_D_ERROR, "SD write cache unavailable, writing through \n"));
+			}
+			Instance->BlockMedia.WriteCaching = WriteCacheEnabled();
+		}
 		Status = gBS->InstallMultipleProtocolInterfaces(
 			&Instance->Handle,
 			&gEfiBlockIoProtocolGuid,    
@@ -768,6 +820,25 @@ SdMmcDxeInitialize
 			&Instance->DevicePath,
 			NULL
 		);
+
+		// Let callers find out how much acknowledged data may be pending.
+		// Optional, Block I/O is already installed and must stay loaded.
+		if (!EFI_ERROR(Status) && WriteCacheEnabled())
+		{
+			CacheStatus = gBS->InstallMultipleProtocolInterfaces(
+				&Instance->Handle,
+				&gNintendoSwitchSdWriteCacheProtocolGuid,
+				&Instance->WriteCache,
+				NULL
+			);
+			if (EFI_ERROR(CacheStatus))
+			{
+				DEBUG((EFI_D_ERROR, "SD write cache protocol not installed: %r \n", CacheStatus));
+			}
+		}
+
+		// Command latency over card bring-up and the self test
+		mmc_dump_cmd_stats();
 	}
 
 exit:
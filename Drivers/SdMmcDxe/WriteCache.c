@@ -0,0 +1,424 @@
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include <Protocol/Utc/Mmc.h>
+#include <Foundation/Types.h>
+
+#include "Include/HostOp.h"
+#include "Include/WriteCache.h"
+
+/*
+ * SD cards program a whole allocation unit (AU) at a time internally, so
+ * small scattered writes run at the card's slowest rate. Writes are held
+ * here per AU-aligned window and go out either as one erase + multi-block
+ * write once the window is complete, or as contiguous runs on
+ * FlushBlocks / when the flush timer expires.
+ *
+ * The window is a single AU, or an even divisor of it when the AU is
+ * larger than PcdSdMmcWriteCacheSize. At most one window is pending at
+ * any time, so unflushed data is bounded by the window size and by
+ * PcdSdMmcWriteCacheFlushInterval.
+ */
+
+extern struct mmc mMmcInstance;
+
+STATIC UINT8 *mWcBuffer = NULL;
+STATIC UINT8 *mWcValid = NULL;
+STATIC UINT32 mWcBlockSize;
+STATIC UINT32 mWcWindowBlocks;
+STATIC UINT32 mWcValidCount;
+STATIC UINT64 mWcWindowLba;
+STATIC BOOLEAN mWcPreErase;
+STATIC EFI_EVENT mWcFlushEvent;
+STATIC EFI_EVENT mWcExitBootServicesEvent;
+
+#define WC_TEST_VALID(Index)    (mWcValid[(Index) >> 3] & (1 << ((Index) & 7)))
+#define WC_SET_VALID(Index)     (mWcValid[(Index) >> 3] |= (1 << ((Index) & 7)))
+
+STATIC
+VOID
+WcReset(
+    VOID
+)
+{
+    ZeroMem(mWcValid, (mWcWindowBlocks + 7) / 8);
+    mWcValidCount = 0;
+}
+
+/*
+ * Function: WcWriteWindow
+ * Flow    : Erase the window first when it is a complete AU so the card
+ *           does not have to do a read-modify-write, then write it with
+ *           a single multi-block transfer.
+ */
+STATIC
+EFI_STATUS
+WcWriteWindow(
+    IN UINT64       Lba,
+    IN CONST VOID   *Buffer
+)
+{
+    if (mWcPreErase && mmc_berase(Lba, mWcWindowBlocks) != mWcWindowBlocks)
+    {
+        // Not fatal, the card will merge the old contents instead
+        DEBUG((EFI_D_WARN, "%a: pre-erase @ 0x%lx failed\n", __FUNCTION__, Lba));
+    }
+
+    if (mmc_bwrite(Lba, mWcWindowBlocks, Buffer) != mWcWindowBlocks)
+    {
+        return EFI_DEVICE_ERROR;
+    }
+
+    return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+WcFlushPending(
+    VOID
+)
+{
+    EFI_STATUS Status;
+    UINT32 Index;
+    UINT32 RunStart;
+
+    if (mWcValidCount == 0)
+    {
+        return EFI_SUCCESS;
+    }
+
+    if (mWcValidCount == mWcWindowBlocks)
+    {
+        Status = WcWriteWindow(mWcWindowLba, mWcBuffer);
+        if (EFI_ERROR(Status)) return Status;
+
+        WcReset();
+        return EFI_SUCCESS;
+    }
+
+    // Partial window, write every contiguous run of buffered blocks
+    Index = 0;
+    while (Index < mWcWindowBlocks)
+    {
+        if (!WC_TEST_VALID(Index))
+        {
+            Index++;
+            continue;
+        }
+
+        RunStart = Index;
+        while (Index < mWcWindowBlocks && WC_TEST_VALID(Index))
+        {
+            Index++;
+        }
+
+        if (mmc_bwrite(mWcWindowLba + RunStart, Index - RunStart,
+                mWcBuffer + (UINTN) RunStart * mWcBlockSize) != Index - RunStart)
+        {
+            return EFI_DEVICE_ERROR;
+        }
+    }
+
+    WcReset();
+    return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+EFIAPI
+WcFlushNotify(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    EFI_STATUS Status;
+
+    Status = WcFlushPending();
+    if (EFI_ERROR(Status))
+    {
+        DEBUG((EFI_D_ERROR, "%a: flush failed: %r\n", __FUNCTION__, Status));
+    }
+}
+
+/*
+ * Function: WriteCacheInitialize
+ * Arg     : Media block size
+ * Flow    : Size the window from the SSR AU and allocate a DMA-safe buffer
+ *           for it. Leaves the cache disabled if PcdSdMmcWriteCacheSize
+ *           is zero.
+ */
+EFI_STATUS
+WriteCacheInitialize(
+    IN UINT32   BlockSize
+)
+{
+    EFI_STATUS Status;
+    EFI_PHYSICAL_ADDRESS Address;
+    UINT32 MaxBlocks;
+    UINT32 AuBlocks;
+    UINT32 WindowBlocks;
+    UINTN Pages;
+
+    MaxBlocks = FixedPcdGet32(PcdSdMmcWriteCacheSize) / BlockSize;
+    if (MaxBlocks == 0)
+    {
+        return EFI_SUCCESS;
+    }
+
+    AuBlocks = 0;
+    if (IS_SD(&mMmcInstance) && mMmcInstance.ssr.au != 0)
+    {
+        // SSR AU size is in 512-byte sectors
+        AuBlocks = (UINT32) (((UINT64) mMmcInstance.ssr.au * 512) / BlockSize);
+    }
+
+    if (AuBlocks != 0)
+    {
+        WindowBlocks = AuBlocks;
+        while (WindowBlocks > MaxBlocks && (WindowBlocks & 1) == 0)
+        {
+            WindowBlocks >>= 1;
+        }
+
+        if (WindowBlocks > MaxBlocks)
+        {
+            WindowBlocks = MaxBlocks;
+        }
+    }
+    else
+    {
+        WindowBlocks = MaxBlocks;
+    }
+
+    // Only a complete AU benefits from being erased ahead of the write
+    mWcPreErase = (WindowBlocks == AuBlocks);
+
+    //
+    // Keep the buffer below 1GB of system memory so the controller can DMA
+    // from it directly and the bounce buffer is never involved.
+    //
+    Pages = EFI_SIZE_TO_PAGES((UINTN) WindowBlocks * BlockSize);
+    Address = FixedPcdGet64(PcdSystemMemoryBase) + SIZE_1GB - 1;
+    Status = gBS->AllocatePages(AllocateMaxAddress, EfiBootServicesData, Pages, &Address);
+    if (EFI_ERROR(Status)) goto exit;
+
+    mWcValid = AllocateZeroPool((WindowBlocks + 7) / 8);
+    if (mWcValid == NULL)
+    {
+        gBS->FreePages(Address, Pages);
+        Status = EFI_OUT_OF_RESOURCES;
+        goto exit;
+    }
+
+    Status = gBS->CreateEvent(
+        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        WcFlushNotify,
+        NULL,
+        &mWcFlushEvent
+    );
+    if (EFI_ERROR(Status)) goto fail;
+
+    Status = gBS->CreateEventEx(
+        EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        WcFlushNotify,
+        NULL,
+        &gEfiEventExitBootServicesGuid,
+        &mWcExitBootServicesEvent
+    );
+    if (EFI_ERROR(Status))
+    {
+        gBS->CloseEvent(mWcFlushEvent);
+        goto fail;
+    }
+
+    mWcBuffer = (UINT8 *) (UINTN) Address;
+    mWcBlockSize = BlockSize;
+    mWcWindowBlocks = WindowBlocks;
+    mWcValidCount = 0;
+
+    DEBUG((EFI_D_INFO, "SD write cache: AU %d KB, window %d KB%a, flush within %d ms\n",
+        (AuBlocks * BlockSize) / SIZE_1KB, (WindowBlocks * BlockSize) / SIZE_1KB,
+        mWcPreErase ? " (pre-erase)" : "", FixedPcdGet32(PcdSdMmcWriteCacheFlushInterval)));
+
+    return EFI_SUCCESS;
+
+fail:
+    FreePool(mWcValid);
+    mWcValid = NULL;
+    gBS->FreePages(Address, Pages);
+exit:
+    return Status;
+}
+
+BOOLEAN
+WriteCacheEnabled(
+    VOID
+)
+{
+    return mWcBuffer != NULL;
+}
+
+/*
+ * Function: WriteCacheWrite
+ * Arg     : Start LBA, block count & source buffer
+ * Flow    : Split the request along window boundaries. Complete windows
+ *           go straight to the card, everything else is merged into the
+ *           pending window, which is flushed first if the request moves
+ *           on to a different one.
+ */
+EFI_STATUS
+WriteCacheWrite(
+    IN UINT64       Lba,
+    IN UINTN        Blocks,
+    IN CONST VOID   *Buffer
+)
+{
+    EFI_STATUS Status;
+    CONST UINT8 *Src = Buffer;
+    UINT64 WindowLba;
+    UINT32 Offset;
+    UINT32 Count;
+    UINT32 Index;
+    BOOLEAN WasClean;
+
+    ASSERT(WriteCacheEnabled());
+
+    while (Blocks > 0)
+    {
+        WindowLba = Lba - ModU64x32(Lba, mWcWindowBlocks);
+        Offset = (UINT32) (Lba - WindowLba);
+        Count = (UINT32) MIN(Blocks, (UINTN) (mWcWindowBlocks - Offset));
+
+        if (mWcValidCount != 0 && WindowLba != mWcWindowLba)
+        {
+            Status = WcFlushPending();
+            if (EFI_ERROR(Status)) return Status;
+        }
+
+        if (Count == mWcWindowBlocks)
+        {
+            // Supersedes whatever is buffered for this window
+            WcReset();
+            Status = WcWriteWindow(WindowLba, Src);
+            if (EFI_ERROR(Status)) return Status;
+        }
+        else
+        {
+            WasClean = (mWcValidCount == 0);
+            mWcWindowLba = WindowLba;
+
+            CopyMem(mWcBuffer + (UINTN) Offset * mWcBlockSize, Src, (UINTN) Count * mWcBlockSize);
+            for (Index = Offset; Index < Offset + Count; Index++)
+            {
+                if (!WC_TEST_VALID(Index))
+                {
+                    WC_SET_VALID(Index);
+                    mWcValidCount++;
+                }
+            }
+
+            if (mWcValidCount == mWcWindowBlocks)
+            {
+                Status = WcFlushPending();
+                if (EFI_ERROR(Status)) return Status;
+            }
+            else if (WasClean)
+            {
+                // Arm the age limit when the window first becomes dirty
+                gBS->SetTimer(
+                    mWcFlushEvent,
+                    TimerRelative,
+                    EFI_TIMER_PERIOD_MILLISECONDS(FixedPcdGet32(PcdSdMmcWriteCacheFlushInterval))
+                );
+            }
+        }
+
+        Lba += Count;
+        Src += (UINTN) Count * mWcBlockSize;
+        Blocks -= Count;
+    }
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * Function: WriteCacheOverlay
+ * Arg     : Start LBA, block count & buffer just read from the card
+ * Flow    : Replace blocks that still have newer data pending here.
+ */
+VOID
+WriteCacheOverlay(
+    IN UINT64       Lba,
+    IN UINTN        Blocks,
+    IN OUT VOID     *Buffer
+)
+{
+    UINT64 Start;
+    UINT64 End;
+    UINT64 Block;
+    UINT32 Index;
+
+    if (mWcBuffer == NULL || mWcValidCount == 0)
+    {
+        return;
+    }
+
+    Start = MAX(Lba, mWcWindowLba);
+    End = MIN(Lba + Blocks, mWcWindowLba + mWcWindowBlocks);
+
+    for (Block = Start; Block < End; Block++)
+    {
+        Index = (UINT32) (Block - mWcWindowLba);
+        if (WC_TEST_VALID(Index))
+        {
+            CopyMem(
+                (UINT8 *) Buffer + (UINTN) (Block - Lba) * mWcBlockSize,
+                mWcBuffer + (UINTN) Index * mWcBlockSize,
+                mWcBlockSize
+            );
+        }
+    }
+}
+
+EFI_STATUS
+WriteCacheFlush(
+    VOID
+)
+{
+    if (mWcBuffer == NULL)
+    {
+        return EFI_SUCCESS;
+    }
+
+    gBS->SetTimer(mWcFlushEvent, TimerCancel, 0);
+    return WcFlushPending();
+}
+
+/*
+ * Function: WriteCacheGetPendingBound
+ * Arg     : Optional o/p for the flush interval
+ * Return  : Largest amount of acknowledged data, in bytes, that may not
+ *           have reached the card yet. Data never stays buffered for
+ *           longer than the flush interval.
+ */
+UINTN
+WriteCacheGetPendingBound(
+    OUT UINT32      *FlushIntervalMs OPTIONAL
+)
+{
+    if (FlushIntervalMs != NULL)
+    {
+        *FlushIntervalMs = (mWcBuffer != NULL) ? FixedPcdGet32(PcdSdMmcWriteCacheFlushInterval) : 0;
+    }
+
+    return (mWcBuffer != NULL) ? (UINTN) mWcWindowBlocks * mWcBlockSize : 0;
+}
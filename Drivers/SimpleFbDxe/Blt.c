@@ -0,0 +1,285 @@
+/* Blt.c: Rectangle fill and copy for DisplayBlt */
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+
+#include "Include/Blt.h"
+
+/* Pixels per side of the square blocks BltTranspose works through */
+#define BLT_TRANSPOSE_BLOCK     64
+
+#define BLT_PIXEL(Base, Stride, X, Y) \
+    (*(UINT32 *)((Base) + (INTN)(Y) * (Stride) + (X) * BLT_BYTES_PER_PIXEL))
+
+CONST BLT_ENGINE *mBltEngine = NULL;
+
+/* AArch64/BltKernels.S */
+VOID
+BltFill32(
+    OUT VOID        *Destination,
+    IN  UINTN       Count,
+    IN  UINT32      Color
+);
+
+VOID
+BltCopyForward(
+    OUT VOID        *Destination,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Length
+);
+
+VOID
+BltCopyBackward(
+    OUT VOID        *Destination,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Length
+);
+
+VOID
+BltTransposeStrip(
+    OUT VOID        *Destination,
+    IN  INTN        DestinationStride,
+    IN  CONST VOID  *Source,
+    IN  INTN        SourceStride,
+    IN  UINTN       Count
+);
+
+VOID
+BltScale2xLine(
+    OUT VOID        *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Count
+);
+
+/*
+ * Function: BltFill
+ * Flow    : Fill Width x Height pixels. Strides are in bytes; a rectangle
+ *           as wide as its stride is a single run.
+ */
+VOID
+BltFill(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+)
+{
+    UINTN Row;
+
+    if (Stride == Width * BLT_BYTES_PER_PIXEL)
+    {
+        BltFill32(Destination, Width * Height, Color);
+        return;
+    }
+
+    for (Row = 0; Row < Height; Row++)
+    {
+        BltFill32(Destination + Row * Stride, Width, Color);
+    }
+}
+
+/*
+ * Function: BltCopy
+ * Flow    : Copy Width x Height pixels between two surfaces, which may be
+ *           the same one. When the destination lies above an overlapping
+ *           source the rows go bottom-up and each row back to front, like
+ *           memmove, so scrolling a region down doesn't smear it.
+ */
+VOID
+BltCopy(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+)
+{
+    UINTN RowBytes = Width * BLT_BYTES_PER_PIXEL;
+    UINTN Row;
+
+    if (RowBytes == 0 || Height == 0)
+    {
+        return;
+    }
+
+    if (DestinationStride == RowBytes && SourceStride == RowBytes)
+    {
+        RowBytes *= Height;
+        Height = 1;
+    }
+
+    if (Destination > Source &&
+        Destination < Source + (Height - 1) * SourceStride + RowBytes)
+    {
+        for (Row = Height; Row-- > 0;)
+        {
+            BltCopyBackward(
+                Destination + Row * DestinationStride,
+                Source + Row * SourceStride,
+                RowBytes
+            );
+        }
+        return;
+    }
+
+    for (Row = 0; Row < Height; Row++)
+    {
+        BltCopyForward(
+            Destination + Row * DestinationStride,
+            Source + Row * SourceStride,
+            RowBytes
+        );
+    }
+}
+
+/*
+ * Function: BltEngineFill
+ * Flow    : BltFill on the offload engine when there is one and the
+ *           rectangle is large enough, on the CPU otherwise or when the
+ *           engine turns it down.
+ */
+VOID
+BltEngineFill(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+)
+{
+    if (mBltEngine != NULL && Width * Height >= BLT_ENGINE_MIN_PIXELS &&
+        !EFI_ERROR(mBltEngine->Fill(Destination, Stride, Width, Height, Color)))
+    {
+        return;
+    }
+
+    BltFill(Destination, Stride, Width, Height, Color);
+}
+
+/*
+ * Function: BltEngineCopy
+ * Flow    : BltCopy on the offload engine, like BltEngineFill.
+ */
+VOID
+BltEngineCopy(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+)
+{
+    if (mBltEngine != NULL && Width * Height >= BLT_ENGINE_MIN_PIXELS &&
+        !EFI_ERROR(mBltEngine->Copy(Destination, DestinationStride, Source, SourceStride, Width, Height)))
+    {
+        return;
+    }
+
+    BltCopy(Destination, DestinationStride, Source, SourceStride, Width, Height);
+}
+
+/*
+ * Function: BltTranspose
+ * Flow    : Write the Width x Height source rectangle as a Height x Width
+ *           one, source column X becoming destination line X. Strides may
+ *           be negative, which flips the respective axis, so both quarter
+ *           turns are a transpose. The work is cut into blocks whose
+ *           destination lines stay in the data cache until all of their
+ *           tiles are written, and each block into 4x4 tiles for the NEON
+ *           kernel with a plain loop for the ragged edges.
+ */
+VOID
+BltTranspose(
+    OUT UINT8       *Destination,
+    IN  INTN        DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  INTN        SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+)
+{
+    UINTN BlockX, BlockY;
+    UINTN Columns, Rows, Vector;
+    UINTN X, Y, Line, Lines;
+
+    for (BlockY = 0; BlockY < Height; BlockY += BLT_TRANSPOSE_BLOCK)
+    {
+        Rows = MIN(BLT_TRANSPOSE_BLOCK, Height - BlockY);
+
+        for (BlockX = 0; BlockX < Width; BlockX += BLT_TRANSPOSE_BLOCK)
+        {
+            Columns = MIN(BLT_TRANSPOSE_BLOCK, Width - BlockX);
+            Vector = Columns & ~(UINTN) 3;
+
+            for (Y = BlockY; Y < BlockY + Rows; Y += 4)
+            {
+                Lines = MIN(4, BlockY + Rows - Y);
+                X = BlockX;
+
+                if (Lines == 4 && Vector != 0)
+                {
+                    BltTransposeStrip(
+                        &BLT_PIXEL(Destination, DestinationStride, Y, BlockX),
+                        DestinationStride,
+                        &BLT_PIXEL(Source, SourceStride, BlockX, Y),
+                        SourceStride,
+                        Vector
+                    );
+                    X += Vector;
+                }
+
+                for (; X < BlockX + Columns; X++)
+                {
+                    for (Line = Y; Line < Y + Lines; Line++)
+                    {
+                        BLT_PIXEL(Destination, DestinationStride, Line, X) =
+                            BLT_PIXEL(Source, SourceStride, X, Line);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: BltScale2x
+ * Flow    : Blow the Width x Height source rectangle up to twice its size,
+ *           every source pixel becoming a 2x2 block.
+ */
+VOID
+BltScale2x(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+)
+{
+    UINTN Vector = Width & ~(UINTN) 3;
+    UINTN Row, X;
+    UINT32 Pixel;
+
+    for (Row = 0; Row < Height; Row++)
+    {
+        if (Vector != 0)
+        {
+            BltScale2xLine(Destination, DestinationStride, Source, Vector);
+        }
+
+        for (X = Vector; X < Width; X++)
+        {
+            Pixel = BLT_PIXEL(Source, 0, X, 0);
+            BLT_PIXEL(Destination, DestinationStride, 2 * X, 0) = Pixel;
+            BLT_PIXEL(Destination, DestinationStride, 2 * X + 1, 0) = Pixel;
+            BLT_PIXEL(Destination, DestinationStride, 2 * X, 1) = Pixel;
+            BLT_PIXEL(Destination, DestinationStride, 2 * X + 1, 1) = Pixel;
+        }
+
+        Destination += 2 * DestinationStride;
+        Source += SourceStride;
+    }
+}
@@ -0,0 +1,98 @@
+/* ConsoleRing.c: Owner of the deferred framebuffer console log ring */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/SerialPortLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include <Resources/FbConsole.h>
+
+#include "Include/ConsoleRing.h"
+
+// Interval between two drains of the log ring
+#define CONSOLE_RING_DRAIN_PERIOD   EFI_TIMER_PERIOD_MILLISECONDS(10)
+
+STATIC EFI_EVENT mDrainTimer = NULL;
+
+/*
+ * A zero length write makes the console library render what is queued.
+ * This driver's copy of the library draws into the same shared grid as
+ * every other module's copy, so it can drain for all of them.
+ */
+STATIC
+VOID
+EFIAPI
+ConsoleRingDrainTimer(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    UINT8 Nothing = 0;
+
+    SerialPortWrite(&Nothing, 0);
+}
+
+/*
+ * Function: ConsoleRingInitialize
+ * Flow    : Allocate the log ring shared by every module linking
+ *           DxeFrameBufferSerialPortLib, start the one timer that drains it
+ *           and publish it as a configuration table. Each library instance
+ *           attaches when the table shows up; until then, and if anything
+ *           here fails, output stays synchronous. Boot services stop the
+ *           timer at ExitBootServices, the library instances drain what is
+ *           left and go back to synchronous output then.
+ */
+EFI_STATUS
+ConsoleRingInitialize(
+    VOID
+)
+{
+    EFI_STATUS Status;
+    UINT32 Size = FixedPcdGet32(PcdFrameBufferConsoleRingSize);
+    FBCON_RING *Ring;
+
+    // The ring arithmetic relies on a power of two size
+    if (Size == 0 || (Size & (Size - 1)) != 0)
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    Ring = AllocateZeroPool(sizeof(FBCON_RING) + Size);
+    if (Ring == NULL)
+    {
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    Ring->Buffer = (UINT8 *) (Ring + 1);
+    Ring->Mask = Size - 1;
+
+    Status = gBS->CreateEvent(
+        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        ConsoleRingDrainTimer,
+        NULL,
+        &mDrainTimer
+    );
+    if (EFI_ERROR(Status)) goto exit;
+
+    Status = gBS->SetTimer(mDrainTimer, TimerPeriodic, CONSOLE_RING_DRAIN_PERIOD);
+    if (EFI_ERROR(Status)) goto exit;
+
+    Status = gBS->InstallConfigurationTable(&gNintendoSwitchConsoleRingGuid, Ring);
+    if (EFI_ERROR(Status)) goto exit;
+
+    DEBUG((EFI_D_INFO, "SimpleFbDxe: Console log ring at 0x%p, %d bytes\n", Ring, Size));
+    return EFI_SUCCESS;
+
+exit:
+    if (mDrainTimer != NULL)
+    {
+        gBS->CloseEvent(mDrainTimer);
+        mDrainTimer = NULL;
+    }
+    FreePool(Ring);
+    return Status;
+}
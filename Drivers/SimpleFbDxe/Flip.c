@@ -0,0 +1,303 @@
+/* Flip.c: Double-buffered scanout through display window A */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include <Resources/FbConsole.h>
+
+#include "Include/Flip.h"
+#include "Include/Shadow.h"
+
+/* A few frames at 60 Hz, in case the display controller isn't running */
+#define FLIP_LATCH_TIMEOUT_US   100000
+
+STATIC EFI_STATUS EFIAPI FlipEnable(IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL *This, IN BOOLEAN Enable);
+STATIC EFI_STATUS EFIAPI FlipPresent(IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL *This, IN BOOLEAN WaitForFlip);
+
+NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL mDisplayFlip = {
+    NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL_REVISION,
+    FlipEnable,
+    FlipPresent
+};
+
+/*
+ * Buffer 0 is the framebuffer the bootloader set up, buffer 1 is allocated
+ * on the first Enable(). The display carveout has no room for a second
+ * frame, so buffer 1 is ordinary cached memory that gets cleaned to the
+ * point of coherency before the display is pointed at it.
+ */
+STATIC UINT8 *mBuffers[2] = { NULL, NULL };
+STATIC UINTN mFront = 0;
+STATIC UINTN mLineBytes;
+STATIC UINTN mHeight;
+STATIC BOOLEAN mFlipEnabled = FALSE;
+
+/* Window A was pointed at mBuffers[mFront] and may not have latched yet */
+STATIC BOOLEAN mFlipPending = FALSE;
+
+/* Lines drawn since the last flip, and lines the last flip brought out */
+STATIC UINTN mDirtyTop = MAX_UINTN;
+STATIC UINTN mDirtyBottom = 0;
+STATIC UINTN mPendingTop = MAX_UINTN;
+STATIC UINTN mPendingBottom = 0;
+
+STATIC EFI_EVENT mExitBootServicesEvent = NULL;
+
+STATIC
+VOID
+FlipWaitForLatch(
+    VOID
+)
+{
+    UINTN Timeout = FLIP_LATCH_TIMEOUT_US;
+
+    // The controller clears the request bits once the new address is active
+    while ((DISPLAY_A(_DIREG(DC_CMD_STATE_CONTROL)) & (GENERAL_ACT_REQ | WIN_A_ACT_REQ)) && Timeout != 0)
+    {
+        gBS->Stall(10);
+        Timeout = (Timeout > 10) ? Timeout - 10 : 0;
+    }
+}
+
+/*
+ * Function: FlipSettle
+ * Flow    : Wait until the last flip has latched, then catch the new back
+ *           buffer up with the lines that flip brought out, so drawing can
+ *           carry on from what is on screen.
+ */
+STATIC
+VOID
+FlipSettle(
+    VOID
+)
+{
+    UINT8 *Back;
+    UINTN Offset;
+    UINTN Size;
+
+    if (!mFlipPending)
+    {
+        return;
+    }
+
+    FlipWaitForLatch();
+    mFlipPending = FALSE;
+
+    if (mPendingTop < mPendingBottom)
+    {
+        Back = mBuffers[mFront ^ 1];
+        Offset = mPendingTop * mLineBytes;
+        Size = (mPendingBottom - mPendingTop) * mLineBytes;
+
+        CopyMem(Back + Offset, mBuffers[mFront] + Offset, Size);
+        WriteBackDataCacheRange(Back + Offset, Size);
+    }
+
+    mPendingTop = MAX_UINTN;
+    mPendingBottom = 0;
+}
+
+UINT8 *
+FlipGetBackBuffer(
+    IN UINT8    *Scanout
+)
+{
+    if (!mFlipEnabled)
+    {
+        return Scanout;
+    }
+
+    FlipSettle();
+    return mBuffers[mFront ^ 1];
+}
+
+VOID
+FlipMarkDirty(
+    IN UINTN    Y,
+    IN UINTN    Height
+)
+{
+    if (!mFlipEnabled)
+    {
+        return;
+    }
+
+    if (Y < mDirtyTop) mDirtyTop = Y;
+    if (Y + Height > mDirtyBottom) mDirtyBottom = MIN(Y + Height, mHeight);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FlipPresent(
+    IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL    *This,
+    IN BOOLEAN                                  WaitForFlip
+)
+{
+    EFI_TPL OldTpl;
+    UINT8 *Back;
+
+    if (!mFlipEnabled)
+    {
+        return EFI_NOT_STARTED;
+    }
+
+    // The shadow flush timer must not push into a buffer being flipped
+    OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+
+    ShadowFlush();
+    FlipSettle();
+
+    if (mDirtyTop < mDirtyBottom)
+    {
+        Back = mBuffers[mFront ^ 1];
+        WriteBackDataCacheRange(Back + mDirtyTop * mLineBytes, (mDirtyBottom - mDirtyTop) * mLineBytes);
+
+        FBCON_PAN_WINDOW(Back);
+        mFront ^= 1;
+        mFlipPending = TRUE;
+
+        mPendingTop = mDirtyTop;
+        mPendingBottom = mDirtyBottom;
+        mDirtyTop = MAX_UINTN;
+        mDirtyBottom = 0;
+
+        ShadowSetScanout(mBuffers[mFront ^ 1]);
+    }
+
+    if (WaitForFlip)
+    {
+        FlipSettle();
+    }
+
+    gBS->RestoreTPL(OldTpl);
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * Function: FlipDisable
+ * Flow    : Present the last frame and, if it ended up in the allocated
+ *           buffer, copy it to the bootloader framebuffer and scan that
+ *           out again. GOP's FrameBufferBase and the OS expect it there.
+ */
+STATIC
+VOID
+FlipDisable(
+    VOID
+)
+{
+    UINTN Size = mLineBytes * mHeight;
+
+    FlipPresent(&mDisplayFlip, TRUE);
+
+    if (mFront != 0)
+    {
+        CopyMem(mBuffers[0], mBuffers[1], Size);
+        WriteBackDataCacheRange(mBuffers[0], Size);
+        FBCON_PAN_WINDOW(mBuffers[0]);
+        FlipWaitForLatch();
+        mFront = 0;
+    }
+
+    ShadowSetScanout(mBuffers[0]);
+    mFlipEnabled = FALSE;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FlipEnable(
+    IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL    *This,
+    IN BOOLEAN                                  Enable
+)
+{
+    EFI_STATUS Status;
+    EFI_PHYSICAL_ADDRESS Address;
+    EFI_TPL OldTpl;
+    UINTN Size = mLineBytes * mHeight;
+
+    if (Enable == mFlipEnabled)
+    {
+        return EFI_SUCCESS;
+    }
+
+    if (!Enable)
+    {
+        OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+        FlipDisable();
+        gBS->RestoreTPL(OldTpl);
+        return EFI_SUCCESS;
+    }
+
+    // Window start addresses are 32 bit
+    if (mBuffers[1] == NULL)
+    {
+        Address = MAX_UINT32;
+        Status = gBS->AllocatePages(AllocateMaxAddress, EfiBootServicesData, EFI_SIZE_TO_PAGES(Size), &Address);
+        if (EFI_ERROR(Status))
+        {
+            DEBUG((EFI_D_ERROR, "SimpleFbDxe: No memory for the back buffer\n"));
+            return Status;
+        }
+        mBuffers[1] = (UINT8 *)(UINTN) Address;
+    }
+
+    OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+
+    // Start from what is on screen
+    ShadowFlush();
+    CopyMem(mBuffers[1], mBuffers[0], Size);
+    WriteBackDataCacheRange(mBuffers[1], Size);
+    ShadowSetScanout(mBuffers[1]);
+
+    mFront = 0;
+    mFlipPending = FALSE;
+    mDirtyTop = mPendingTop = MAX_UINTN;
+    mDirtyBottom = mPendingBottom = 0;
+    mFlipEnabled = TRUE;
+
+    gBS->RestoreTPL(OldTpl);
+
+    return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+EFIAPI
+FlipExitBootServices(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    if (mFlipEnabled)
+    {
+        FlipDisable();
+    }
+}
+
+EFI_STATUS
+FlipInitialize(
+    IN VOID     *Scanout,
+    IN UINTN    LineBytes,
+    IN UINTN    Height
+)
+{
+    mBuffers[0] = Scanout;
+    mLineBytes = LineBytes;
+    mHeight = Height;
+
+    return gBS->CreateEvent(
+        EVT_SIGNAL_EXIT_BOOT_SERVICES,
+        TPL_NOTIFY,
+        FlipExitBootServices,
+        NULL,
+        &mExitBootServicesEvent
+    );
+}
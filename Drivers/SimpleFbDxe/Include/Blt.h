@@ -0,0 +1,103 @@
+#ifndef __SIMPLEFB_BLT_H__
+#define __SIMPLEFB_BLT_H__
+
+#include <Uefi.h>
+
+#define BLT_BYTES_PER_PIXEL     4
+
+/*
+ * Engine taking large fills and copies off the CPU. An error, such as
+ * EFI_UNSUPPORTED for a rectangle it cannot handle, leaves the work to
+ * the CPU kernels.
+ */
+typedef
+EFI_STATUS
+(*BLT_ENGINE_FILL)(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+);
+
+typedef
+EFI_STATUS
+(*BLT_ENGINE_COPY)(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+);
+
+typedef struct {
+    BLT_ENGINE_FILL Fill;
+    BLT_ENGINE_COPY Copy;
+} BLT_ENGINE;
+
+/* Smaller rectangles are done before a submission would have been */
+#define BLT_ENGINE_MIN_PIXELS   (256 * 256)
+
+/* NULL while there is no engine, see VicInitialize() */
+extern CONST BLT_ENGINE *mBltEngine;
+
+VOID
+BltFill(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+);
+
+VOID
+BltCopy(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+);
+
+VOID
+BltEngineFill(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+);
+
+VOID
+BltEngineCopy(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+);
+
+VOID
+BltTranspose(
+    OUT UINT8       *Destination,
+    IN  INTN        DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  INTN        SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+);
+
+VOID
+BltScale2x(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+);
+
+#endif
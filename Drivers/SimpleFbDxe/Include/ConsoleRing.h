@@ -0,0 +1,11 @@
+#ifndef __SIMPLEFB_CONSOLE_RING_H__
+#define __SIMPLEFB_CONSOLE_RING_H__
+
+#include <Uefi.h>
+
+EFI_STATUS
+ConsoleRingInitialize(
+    VOID
+);
+
+#endif
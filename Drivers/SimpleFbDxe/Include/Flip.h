@@ -0,0 +1,27 @@
+#ifndef __SIMPLEFB_FLIP_H__
+#define __SIMPLEFB_FLIP_H__
+
+#include <Uefi.h>
+#include <Protocol/DisplayFlip.h>
+
+extern NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL mDisplayFlip;
+
+EFI_STATUS
+FlipInitialize(
+    IN VOID     *Scanout,
+    IN UINTN    LineBytes,
+    IN UINTN    Height
+);
+
+UINT8 *
+FlipGetBackBuffer(
+    IN UINT8    *Scanout
+);
+
+VOID
+FlipMarkDirty(
+    IN UINTN    Y,
+    IN UINTN    Height
+);
+
+#endif
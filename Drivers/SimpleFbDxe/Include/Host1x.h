@@ -0,0 +1,43 @@
+#ifndef __SIMPLEFB_HOST1X_H__
+#define __SIMPLEFB_HOST1X_H__
+
+/*
+ * Host1x command stream opcodes. Offset is the register word offset in
+ * the class selected by SETCLASS.
+ */
+#define HOST1X_OPCODE_SETCLASS(Offset, Class, Mask) \
+    ((0U << 28) | ((Offset) << 16) | ((Class) << 6) | (Mask))
+#define HOST1X_OPCODE_INCR(Offset, Count) \
+    ((1U << 28) | ((Offset) << 16) | (Count))
+#define HOST1X_OPCODE_NONINCR(Offset, Count) \
+    ((2U << 28) | ((Offset) << 16) | (Count))
+#define HOST1X_OPCODE_MASK(Offset, Mask) \
+    ((3U << 28) | ((Offset) << 16) | (Mask))
+#define HOST1X_OPCODE_IMM(Offset, Value) \
+    ((4U << 28) | ((Offset) << 16) | (Value))
+
+#define HOST1X_OPCODE(Word)             ((Word) >> 28)
+#define HOST1X_OPCODE_OFFSET(Word)      (((Word) >> 16) & 0xfff)
+#define HOST1X_OPCODE_COUNT(Word)       ((Word) & 0xffff)
+#define HOST1X_OPCODE_CLASS(Word)       (((Word) >> 6) & 0x3ff)
+
+/* Word 0 of every client class: increment a syncpoint once the work is done */
+#define HOST1X_INCR_SYNCPT              0x00
+#define HOST1X_INCR_SYNCPT_OP_DONE      (1 << 8)
+
+/* Channel DMA registers (Tegra X1 Host1x), channel N at N * HOST1X_CHANNEL_SIZE */
+#define HOST1X_CHANNEL_SIZE             0x4000
+#define HOST1X_CHANNEL_DMASTART         0x14
+#define HOST1X_CHANNEL_DMAPUT           0x18
+#define HOST1X_CHANNEL_DMAGET           0x1c
+#define HOST1X_CHANNEL_DMAEND           0x20
+#define HOST1X_CHANNEL_DMACTRL          0x24
+#define HOST1X_CHANNEL_DMACTRL_DMASTOP      (1 << 0)
+#define HOST1X_CHANNEL_DMACTRL_DMAGETRST    (1 << 1)
+#define HOST1X_CHANNEL_DMACTRL_DMAINITGET   (1 << 2)
+
+/* Syncpoint values, in the sync register block of the Host1x aperture */
+#define HOST1X_SYNC_BASE                0x2100
+#define HOST1X_SYNC_SYNCPT(Id)          (HOST1X_SYNC_BASE + 0xf80 + (Id) * 4)
+
+#endif
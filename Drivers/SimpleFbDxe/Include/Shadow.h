@@ -0,0 +1,44 @@
+#ifndef __SIMPLEFB_SHADOW_H__
+#define __SIMPLEFB_SHADOW_H__
+
+#include <Uefi.h>
+
+EFI_STATUS
+ShadowInitialize(
+    IN VOID     *Scanout,
+    IN UINTN    Width,
+    IN UINTN    Height
+);
+
+UINT8 *
+ShadowGetDrawBuffer(
+    IN UINT8    *Scanout
+);
+
+VOID
+ShadowMarkDirty(
+    IN UINTN    X,
+    IN UINTN    Y,
+    IN UINTN    Width,
+    IN UINTN    Height
+);
+
+VOID
+ShadowFlush(
+    VOID
+);
+
+VOID
+ShadowSync(
+    IN UINTN    X,
+    IN UINTN    Y,
+    IN UINTN    Width,
+    IN UINTN    Height
+);
+
+VOID
+ShadowSetScanout(
+    IN VOID     *Scanout
+);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __SIMPLEFB_SPLASH_H__
+#define __SIMPLEFB_SPLASH_H__
+
+#include <Uefi.h>
+#include <Protocol/Splash.h>
+
+EFI_STATUS
+SplashInitialize(
+    VOID
+);
+
+EFI_STATUS
+SplashDraw(
+    IN  UINT8   *Screen,
+    OUT UINTN   *FirstLine,
+    OUT UINTN   *LineCount
+);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef __SIMPLEFB_VIC_H__
+#define __SIMPLEFB_VIC_H__
+
+#include <Uefi.h>
+
+/* Host1x class of VIC, its THI hands METHOD0/METHOD1 pairs to the Falcon */
+#define VIC_CLASS_ID                        0x5d
+#define VIC_THI_METHOD0                     0x10
+#define VIC_THI_METHOD1                     0x11
+
+/* vic04 methods, METHOD0 takes them divided by 4 */
+#define VIC_SET_APPLICATION_ID              0x200
+#define VIC_EXECUTE                         0x300
+#define VIC_SET_SURFACE0_SLOT0_LUMA_OFFSET  0x400
+#define VIC_SET_CONTROL_PARAMS              0x704
+#define VIC_SET_CONFIG_STRUCT_OFFSET        0x708
+#define VIC_SET_OUTPUT_SURFACE_LUMA_OFFSET  0x720
+
+#define VIC_APPLICATION_ID_COMPOSITOR       1
+
+/* Size of the config struct in 16 byte units */
+#define VIC_CONTROL_PARAMS_CONFIG_SIZE(Bytes)   (((Bytes) / 16) << 16)
+
+/*
+ * Surface and config struct offsets are addresses divided by 256, so both
+ * have to be aligned to that and below 1 TiB.
+ */
+#define VIC_OFFSET_ALIGN                    256
+#define VIC_OFFSET_LIMIT                    (1ULL << 40)
+
+#define VIC_BLT_FILL                        1
+#define VIC_BLT_COPY                        2
+
+/*
+ * One rectangle fill or copy on 32 bpp surfaces. This is the layout the
+ * Blt path hands to the firmware, not the vic04 compositor ConfigStruct;
+ * the output surface is the one of SET_OUTPUT_SURFACE_LUMA_OFFSET and the
+ * source the one of SET_SURFACE0_SLOT0_LUMA_OFFSET.
+ */
+typedef struct {
+    UINT32  Operation;              // VIC_BLT_FILL or VIC_BLT_COPY
+    UINT32  Color;                  // Fill color
+    UINT32  Width;                  // Rectangle size in pixels
+    UINT32  Height;
+    UINT32  DestinationX;           // First pixel, from the surface start
+    UINT32  DestinationStride;      // Bytes
+    UINT32  SourceX;
+    UINT32  SourceStride;
+} VIC_BLT_CONFIG;
+
+/*
+ * Push buffer under construction and the config structs it points at,
+ * one VIC_OFFSET_ALIGN slot per rectangle. Both have to be visible to
+ * Host1x and VIC.
+ */
+typedef struct {
+    UINT32  *Words;
+    UINTN   WordCount;
+    UINTN   WordLimit;
+    UINT8   *Configs;
+    UINTN   ConfigCount;
+    UINTN   ConfigLimit;
+} VIC_STREAM;
+
+VOID
+VicStreamReset(
+    IN OUT VIC_STREAM   *Stream
+);
+
+EFI_STATUS
+VicStreamFill(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT8           *Destination,
+    IN  UINTN           Stride,
+    IN  UINTN           Width,
+    IN  UINTN           Height,
+    IN  UINT32          Color
+);
+
+EFI_STATUS
+VicStreamCopy(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT8           *Destination,
+    IN  UINTN           DestinationStride,
+    IN  CONST UINT8     *Source,
+    IN  UINTN           SourceStride,
+    IN  UINTN           Width,
+    IN  UINTN           Height
+);
+
+EFI_STATUS
+VicStreamFinish(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT32          Syncpoint
+);
+
+EFI_STATUS
+VicInitialize(
+    VOID
+);
+
+#endif
@@ -0,0 +1,374 @@
+/* Shadow.c: Write-back shadow of the scanout buffer */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include "Include/Shadow.h"
+
+#define SHADOW_BYTES_PER_PIXEL  4
+
+/*
+ * Dirty columns of one line, [Left, Right). A line is clean when Left is
+ * not below Right.
+ */
+typedef struct {
+    UINT16  Left;
+    UINT16  Right;
+} SHADOW_SPAN;
+
+STATIC UINT8 *mShadow = NULL;
+STATIC UINT8 *mScanout = NULL;
+STATIC UINTN mWidth;
+STATIC UINTN mHeight;
+STATIC SHADOW_SPAN *mDirty = NULL;
+STATIC UINTN mDirtyTop = MAX_UINTN;
+STATIC UINTN mDirtyBottom = 0;
+STATIC BOOLEAN mShadowActive = FALSE;
+STATIC EFI_EVENT mFlushTimer = NULL;
+STATIC EFI_EVENT mExitBootServicesEvent = NULL;
+
+/*
+ * Function: ShadowStreamCopy
+ * Flow    : Copy to the scanout buffer with non-temporal pair stores, so
+ *           pushing a frame doesn't evict the shadow that GOP clients keep
+ *           drawing into. The tail goes through CopyMem.
+ */
+STATIC
+VOID
+ShadowStreamCopy(
+    OUT VOID        *Destination,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Length
+)
+{
+#if defined(MDE_CPU_AARCH64) && defined(__GNUC__)
+    UINT8 *Dst = Destination;
+    CONST UINT8 *Src = Source;
+
+    while (Length >= 64)
+    {
+        __asm__ volatile(
+            "ldp  x2, x3, [%1]\n"
+            "ldp  x4, x5, [%1, #16]\n"
+            "ldp  x6, x7, [%1, #32]\n"
+            "ldp  x8, x9, [%1, #48]\n"
+            "stnp x2, x3, [%0]\n"
+            "stnp x4, x5, [%0, #16]\n"
+            "stnp x6, x7, [%0, #32]\n"
+            "stnp x8, x9, [%0, #48]\n"
+            :
+            : "r" (Dst), "r" (Src)
+            : "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "memory"
+        );
+        Dst += 64;
+        Src += 64;
+        Length -= 64;
+    }
+
+    Destination = Dst;
+    Source = Src;
+#endif
+
+    if (Length != 0)
+    {
+        CopyMem(Destination, Source, Length);
+    }
+}
+
+VOID
+ShadowFlush(
+    VOID
+)
+{
+    EFI_TPL OldTpl;
+    UINTN Row;
+    UINTN Run;
+    UINTN Stride;
+    SHADOW_SPAN *Span;
+
+    if (!mShadowActive)
+    {
+        return;
+    }
+
+    OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+
+    Stride = mWidth * SHADOW_BYTES_PER_PIXEL;
+    for (Row = mDirtyTop; Row < mDirtyBottom; Row += Run)
+    {
+        Span = &mDirty[Row];
+        Run = 1;
+        if (Span->Left >= Span->Right)
+        {
+            continue;
+        }
+
+        // Consecutive full lines are one contiguous range in both buffers
+        if (Span->Left == 0 && Span->Right == mWidth)
+        {
+            while (Row + Run < mDirtyBottom &&
+                mDirty[Row + Run].Left == 0 && mDirty[Row + Run].Right == mWidth)
+            {
+                mDirty[Row + Run].Left = (UINT16) mWidth;
+                mDirty[Row + Run].Right = 0;
+                Run++;
+            }
+        }
+
+        ShadowStreamCopy(
+            mScanout + Row * Stride + Span->Left * SHADOW_BYTES_PER_PIXEL,
+            mShadow + Row * Stride + Span->Left * SHADOW_BYTES_PER_PIXEL,
+            (Run == 1) ?
+                (Span->Right - Span->Left) * SHADOW_BYTES_PER_PIXEL :
+                Run * Stride
+        );
+
+        Span->Left = (UINT16) mWidth;
+        Span->Right = 0;
+    }
+
+    mDirtyTop = MAX_UINTN;
+    mDirtyBottom = 0;
+
+    // The scanout is write-through, make the stores visible to the display
+    MemoryFence();
+
+    gBS->RestoreTPL(OldTpl);
+}
+
+VOID
+ShadowMarkDirty(
+    IN UINTN    X,
+    IN UINTN    Y,
+    IN UINTN    Width,
+    IN UINTN    Height
+)
+{
+    EFI_TPL OldTpl;
+    UINTN Right;
+    UINTN Bottom;
+    UINTN Row;
+
+    if (!mShadowActive || X >= mWidth || Y >= mHeight)
+    {
+        return;
+    }
+
+    Right = MIN(X + Width, mWidth);
+    Bottom = MIN(Y + Height, mHeight);
+
+    // The flush timer must not see a half updated span
+    OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+
+    for (Row = Y; Row < Bottom; Row++)
+    {
+        if (mDirty[Row].Left > X) mDirty[Row].Left = (UINT16) X;
+        if (mDirty[Row].Right < Right) mDirty[Row].Right = (UINT16) Right;
+    }
+
+    if (Y < mDirtyTop) mDirtyTop = Y;
+    if (Bottom > mDirtyBottom) mDirtyBottom = Bottom;
+
+    gBS->RestoreTPL(OldTpl);
+
+    // Without a flush interval every Blt goes out right away
+    if (FixedPcdGet32(PcdFrameBufferShadowFlushInterval) == 0)
+    {
+        ShadowFlush();
+    }
+}
+
+/*
+ * Function: ShadowSync
+ * Flow    : GOP mode 0 hands out the scanout buffer as FrameBufferBase and
+ *           the DXE framebuffer console draws into it directly, so the
+ *           shadow can be stale. Before pixels are read back, push what is
+ *           pending and reload the rectangle from the scanout buffer.
+ */
+VOID
+ShadowSync(
+    IN UINTN    X,
+    IN UINTN    Y,
+    IN UINTN    Width,
+    IN UINTN    Height
+)
+{
+    EFI_TPL OldTpl;
+    UINTN Right;
+    UINTN Bottom;
+    UINTN Row;
+    UINTN Stride;
+
+    if (!mShadowActive || X >= mWidth || Y >= mHeight)
+    {
+        return;
+    }
+
+    Right = MIN(X + Width, mWidth);
+    Bottom = MIN(Y + Height, mHeight);
+    Stride = mWidth * SHADOW_BYTES_PER_PIXEL;
+
+    // The flush timer must not push between the flush and the reload
+    OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+
+    ShadowFlush();
+    for (Row = Y; Row < Bottom; Row++)
+    {
+        CopyMem(
+            mShadow + Row * Stride + X * SHADOW_BYTES_PER_PIXEL,
+            mScanout + Row * Stride + X * SHADOW_BYTES_PER_PIXEL,
+            (Right - X) * SHADOW_BYTES_PER_PIXEL
+        );
+    }
+
+    gBS->RestoreTPL(OldTpl);
+}
+
+/*
+ * Push to another scanout buffer from now on. The caller flushes first,
+ * at TPL_NOTIFY so the timer can't get in between.
+ */
+VOID
+ShadowSetScanout(
+    IN VOID     *Scanout
+)
+{
+    mScanout = Scanout;
+}
+
+UINT8 *
+ShadowGetDrawBuffer(
+    IN UINT8    *Scanout
+)
+{
+    return mShadowActive ? mShadow : Scanout;
+}
+
+STATIC
+VOID
+EFIAPI
+ShadowFlushTimer(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    ShadowFlush();
+}
+
+/*
+ * The OS takes over the scanout buffer, push what is left and stop
+ * drawing into the shadow.
+ */
+STATIC
+VOID
+EFIAPI
+ShadowExitBootServices(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    ShadowFlush();
+    mShadowActive = FALSE;
+
+    if (mFlushTimer != NULL)
+    {
+        gBS->SetTimer(mFlushTimer, TimerCancel, 0);
+    }
+}
+
+/*
+ * Function: ShadowInitialize
+ * Flow    : Allocate a write-back copy of the scanout buffer and seed it
+ *           with what is on screen now, so read-back Blt operations see
+ *           the splash and the console. Falls back to drawing into the
+ *           scanout buffer if anything is missing.
+ */
+EFI_STATUS
+ShadowInitialize(
+    IN VOID     *Scanout,
+    IN UINTN    Width,
+    IN UINTN    Height
+)
+{
+    EFI_STATUS Status;
+    UINTN Size = Width * Height * SHADOW_BYTES_PER_PIXEL;
+    UINTN Row;
+    UINT32 Interval = FixedPcdGet32(PcdFrameBufferShadowFlushInterval);
+
+    if (Width > MAX_UINT16)
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    mShadow = AllocatePages(EFI_SIZE_TO_PAGES(Size));
+    mDirty = AllocatePool(Height * sizeof(SHADOW_SPAN));
+    if (mShadow == NULL || mDirty == NULL)
+    {
+        DEBUG((EFI_D_ERROR, "SimpleFbDxe: No memory for the shadow framebuffer\n"));
+        Status = EFI_OUT_OF_RESOURCES;
+        goto exit;
+    }
+
+    mScanout = Scanout;
+    mWidth = Width;
+    mHeight = Height;
+    CopyMem(mShadow, mScanout, Size);
+
+    for (Row = 0; Row < Height; Row++)
+    {
+        mDirty[Row].Left = (UINT16) Width;
+        mDirty[Row].Right = 0;
+    }
+
+    if (Interval != 0)
+    {
+        Status = gBS->CreateEvent(
+            EVT_TIMER | EVT_NOTIFY_SIGNAL,
+            TPL_CALLBACK,
+            ShadowFlushTimer,
+            NULL,
+            &mFlushTimer
+        );
+        if (EFI_ERROR(Status)) goto exit;
+
+        Status = gBS->SetTimer(mFlushTimer, TimerPeriodic, EFI_TIMER_PERIOD_MILLISECONDS(Interval));
+        if (EFI_ERROR(Status)) goto exit;
+    }
+
+    Status = gBS->CreateEvent(
+        EVT_SIGNAL_EXIT_BOOT_SERVICES,
+        TPL_NOTIFY,
+        ShadowExitBootServices,
+        NULL,
+        &mExitBootServicesEvent
+    );
+    if (EFI_ERROR(Status)) goto exit;
+
+    mShadowActive = TRUE;
+    DEBUG((EFI_D_INFO, "SimpleFbDxe: Shadow framebuffer at 0x%p, flush every %d ms\n", mShadow, Interval));
+    return EFI_SUCCESS;
+
+exit:
+    if (mFlushTimer != NULL)
+    {
+        gBS->CloseEvent(mFlushTimer);
+        mFlushTimer = NULL;
+    }
+    if (mDirty != NULL)
+    {
+        FreePool(mDirty);
+        mDirty = NULL;
+    }
+    if (mShadow != NULL)
+    {
+        FreePages(mShadow, EFI_SIZE_TO_PAGES(Size));
+        mShadow = NULL;
+    }
+    return Status;
+}
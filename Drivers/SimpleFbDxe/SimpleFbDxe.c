@@ -3,14 +3,26 @@
 #include <Uefi.h>
 #include <Library/UefiLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PcdLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DxeServicesTableLib.h>
 #include <Protocol/GraphicsOutput.h>
+#include <Guid/GlobalVariable.h>
 #include <Library/BaseLib.h>
 #include <Library/CacheMaintenanceLib.h>
+#include <Library/PerformanceLib.h>
+
+#include <Resources/FbConsole.h>
+
+#include "Include/Blt.h"
+#include "Include/ConsoleRing.h"
+#include "Include/Flip.h"
+#include "Include/Shadow.h"
+#include "Include/Splash.h"
+#include "Include/Vic.h"
 
 /// Defines
 /*
@@ -20,10 +32,13 @@
 #define VNBYTES(bpix)	(1 << (bpix)) / 8
 #define VNBITS(bpix)	(1 << (bpix))
 
+/* The scanout buffer is portrait whatever mode GOP is in */
+#define FB_LINE_BYTES   (FixedPcdGet32(PcdMipiFrameBufferWidth) * FB_BYTES_PER_PIXEL)
+
+/* Position in the surface Blt draws into, see DisplayGetSurface() */
 #define POS_TO_FB(posX, posY) ((UINT8 *)                                \
-                               ((UINTN)This->Mode->FrameBufferBase +    \
-                                (posY) * This->Mode->Info->PixelsPerScanLine * \
-                                FB_BYTES_PER_PIXEL +                   \
+                               ((UINTN)DrawBuffer +                     \
+                                (posY) * DrawStride +                   \
                                 (posX) * FB_BYTES_PER_PIXEL))
 
 #define FB_BITS_PER_PIXEL                   (32)
@@ -76,6 +91,35 @@ DISPLAY_DEVICE_PATH mDisplayDevicePath =
     }
 };
 
+/*
+ * Modes published through GOP. The panel scans out in portrait; landscape
+ * modes have no linear framebuffer and DisplayBlt turns them a quarter
+ * turn into the portrait one. Scaled modes draw into a small portrait
+ * backing buffer, and every change is blown up 2x onto the screen.
+ */
+typedef struct {
+    UINT32      HorizontalResolution;
+    UINT32      VerticalResolution;
+    BOOLEAN     Landscape;
+    UINT32      Scale;
+} DISPLAY_MODE;
+
+#define DISPLAY_MODE_COUNT  4
+
+/* 100ns units, how often to check whether the boot option has returned */
+#define DISPLAY_BOOT_RETURN_POLL    1000000
+
+STATIC DISPLAY_MODE mModes[DISPLAY_MODE_COUNT];
+
+/* Backing buffer of the scaled modes, allocated on first use */
+STATIC UINT8 *mScaleBuffer = NULL;
+STATIC UINTN mScaleWidth;
+STATIC UINTN mScaleHeight;
+
+/* Boot option running in mode 0, see DisplayReadyToBoot() */
+STATIC UINT16 mBootOption;
+STATIC EFI_EVENT mBootReturnTimer = NULL;
+
 /// Declares
 
 STATIC
@@ -122,6 +166,47 @@ STATIC EFI_GRAPHICS_OUTPUT_PROTOCOL mDisplay = {
   NULL
 };
 
+/*
+ * Full-size portrait buffer Blt results end up in: the shadow framebuffer
+ * when there is one, else the back buffer while flipping, else the
+ * framebuffer itself.
+ */
+STATIC
+UINT8 *
+DisplayGetScreen
+(
+    VOID
+)
+{
+    return ShadowGetDrawBuffer(FlipGetBackBuffer((UINT8 *)(UINTN)mDisplay.Mode->FrameBufferBase));
+}
+
+STATIC
+VOID
+DisplayGetModeInfo
+(
+    IN  UINT32                                ModeNumber,
+    OUT EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info
+)
+{
+    ZeroMem(Info, sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION));
+
+    Info->Version = 0;
+    Info->HorizontalResolution = mModes[ModeNumber].HorizontalResolution;
+    Info->VerticalResolution = mModes[ModeNumber].VerticalResolution;
+
+    if (mModes[ModeNumber].Landscape || mModes[ModeNumber].Scale > 1)
+    {
+        Info->PixelFormat = PixelBltOnly;
+        Info->PixelsPerScanLine = mModes[ModeNumber].HorizontalResolution;
+    }
+    else
+    {
+        Info->PixelFormat = PixelBlueGreenRedReserved8BitPerColor;
+        Info->PixelsPerScanLine = FixedPcdGet32(PcdMipiFrameBufferWidth);
+    }
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -134,19 +219,22 @@ DisplayQueryMode
 )
 {
     EFI_STATUS Status;
+
+    if (SizeOfInfo == NULL || Info == NULL || ModeNumber >= This->Mode->MaxMode)
+    {
+        return EFI_INVALID_PARAMETER;
+    }
+
     Status = gBS->AllocatePool(
         EfiBootServicesData,
         sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION),
         (VOID **) Info);
 
     ASSERT_EFI_ERROR(Status);
+    if (EFI_ERROR(Status)) return Status;
 
     *SizeOfInfo = sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
-    (*Info)->Version = This->Mode->Info->Version;
-    (*Info)->HorizontalResolution = This->Mode->Info->HorizontalResolution;
-    (*Info)->VerticalResolution = This->Mode->Info->VerticalResolution;
-    (*Info)->PixelFormat = This->Mode->Info->PixelFormat;
-    (*Info)->PixelsPerScanLine = This->Mode->Info->PixelsPerScanLine;
+    DisplayGetModeInfo(ModeNumber, *Info);
 
     return EFI_SUCCESS;
 }
@@ -160,7 +248,160 @@ DisplaySetMode
     IN  UINT32                       ModeNumber
 )
 {
-  return EFI_SUCCESS;
+    UINT8 *DrawBuffer;
+
+    if (ModeNumber >= This->Mode->MaxMode)
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    if (mModes[ModeNumber].Scale > 1)
+    {
+        if (mScaleBuffer == NULL)
+        {
+            mScaleBuffer = AllocatePages(EFI_SIZE_TO_PAGES(mScaleWidth * mScaleHeight * FB_BYTES_PER_PIXEL));
+            if (mScaleBuffer == NULL) return EFI_DEVICE_ERROR;
+        }
+        ZeroMem(mScaleBuffer, mScaleWidth * mScaleHeight * FB_BYTES_PER_PIXEL);
+    }
+
+    DisplayGetModeInfo(ModeNumber, This->Mode->Info);
+    This->Mode->Mode = ModeNumber;
+
+    /* A mode set leaves the screen black */
+    DrawBuffer = DisplayGetScreen();
+    BltFill(
+        DrawBuffer,
+        FB_LINE_BYTES,
+        FixedPcdGet32(PcdMipiFrameBufferWidth),
+        FixedPcdGet32(PcdMipiFrameBufferHeight),
+        0
+    );
+    ShadowMarkDirty(0, 0, FixedPcdGet32(PcdMipiFrameBufferWidth), FixedPcdGet32(PcdMipiFrameBufferHeight));
+    FlipMarkDirty(0, FixedPcdGet32(PcdMipiFrameBufferHeight));
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * Surface Blt draws into for the current mode: the backing buffer of a
+ * scaled mode, otherwise the screen. Strides are in bytes.
+ */
+STATIC
+VOID
+DisplayGetSurface(
+	OUT UINT8                             **DrawBuffer,
+	OUT UINTN                             *DrawStride
+)
+{
+	if (mModes[mDisplay.Mode->Mode].Scale > 1)
+	{
+		*DrawBuffer = mScaleBuffer;
+		*DrawStride = mScaleWidth * FB_BYTES_PER_PIXEL;
+		return;
+	}
+
+	*DrawBuffer = DisplayGetScreen();
+	*DrawStride = FB_LINE_BYTES;
+}
+
+/*
+ * A portrait rectangle of the draw surface changed. Scaled modes bring it
+ * to the screen here, so a redraw only reads and writes the small buffer.
+ */
+STATIC
+VOID
+DisplayMarkDirty(
+	IN  UINTN                             X,
+	IN  UINTN                             Y,
+	IN  UINTN                             Width,
+	IN  UINTN                             Height
+)
+{
+	UINT8 *Screen;
+
+	if (mModes[mDisplay.Mode->Mode].Scale > 1)
+	{
+		Screen = DisplayGetScreen();
+		BltScale2x(
+			Screen + 2 * Y * FB_LINE_BYTES + 2 * X * FB_BYTES_PER_PIXEL, FB_LINE_BYTES,
+			mScaleBuffer + Y * mScaleWidth * FB_BYTES_PER_PIXEL + X * FB_BYTES_PER_PIXEL,
+			mScaleWidth * FB_BYTES_PER_PIXEL,
+			Width, Height
+		);
+		X *= 2;
+		Y *= 2;
+		Width *= 2;
+		Height *= 2;
+	}
+
+	ShadowMarkDirty(X, Y, Width, Height);
+	FlipMarkDirty(Y, Height);
+}
+
+/*
+ * Landscape modes are the portrait scanout buffer turned a quarter turn
+ * counter-clockwise: landscape (X, Y) is portrait (Y, W - 1 - X), W being
+ * the landscape width. Rectangles stay rectangles, so only pixels going
+ * to or coming from BltBuffer have to be transposed.
+ */
+STATIC
+VOID
+DisplayBltLandscape(
+	IN  UINT8                             *DrawBuffer,
+	IN  UINTN                             DrawStride,
+	IN  UINT8                             *BltBuf,
+	IN  EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
+	IN  UINTN                             SourceX,
+	IN  UINTN                             SourceY,
+	IN  UINTN                             DestinationX,
+	IN  UINTN                             DestinationY,
+	IN  UINTN                             Width,
+	IN  UINTN                             Height,
+	IN  UINTN                             Delta
+)
+{
+	UINTN LandscapeWidth = mDisplay.Mode->Info->HorizontalResolution;
+	INTN Stride = DrawStride;
+
+	// Portrait rectangle the destination ends up in
+	UINTN X = DestinationY;
+	UINTN Y = LandscapeWidth - DestinationX - Width;
+
+	switch (BltOperation) {
+	case EfiBltVideoFill:
+		BltEngineFill(POS_TO_FB(X, Y), Stride, Height, Width, *(UINT32 *) BltBuf);
+		break;
+
+	case EfiBltVideoToBltBuffer:
+		BltTranspose(
+			BltBuf + DestinationY * Delta + DestinationX * FB_BYTES_PER_PIXEL, Delta,
+			POS_TO_FB(SourceY, LandscapeWidth - 1 - SourceX), -Stride,
+			Height, Width
+		);
+		return;
+
+	case EfiBltBufferToVideo:
+		BltTranspose(
+			POS_TO_FB(X, LandscapeWidth - 1 - DestinationX), -Stride,
+			BltBuf + SourceY * Delta + SourceX * FB_BYTES_PER_PIXEL, Delta,
+			Width, Height
+		);
+		break;
+
+	case EfiBltVideoToVideo:
+		BltEngineCopy(
+			POS_TO_FB(X, Y), Stride,
+			POS_TO_FB(SourceY, LandscapeWidth - SourceX - Width), Stride,
+			Height, Width
+		);
+		break;
+
+	default:
+		return;
+	}
+
+	DisplayMarkDirty(X, Y, Height, Width);
 }
 
 STATIC
@@ -179,73 +420,260 @@ DisplayBlt(
 	IN  UINTN                             Delta         OPTIONAL
 )
 {
-	UINT8 *VidBuf, *BltBuf, *VidBuf1;
-	UINTN i;
+	UINTN HorizontalResolution = This->Mode->Info->HorizontalResolution;
+	UINTN VerticalResolution = This->Mode->Info->VerticalResolution;
+	UINT8 *BltBuf = (UINT8 *) BltBuffer;
+	UINT8 *DrawBuffer;
+	UINTN DrawStride;
 
-	switch (BltOperation) {
-	case EfiBltVideoFill:
-		BltBuf = (UINT8 *) mDisplay.Mode->FrameBufferBase;
+	DisplayGetSurface(&DrawBuffer, &DrawStride);
 
-		for (i = 0; i < Height; i++) 
-		{
-			VidBuf = POS_TO_FB(DestinationX, DestinationY + i);
-			
-			SetMem32(VidBuf, Width * FB_BYTES_PER_PIXEL, *(UINT32 *) BltBuf);
-		}
-		break;
+	if (BltOperation >= EfiGraphicsOutputBltOperationMax || Width == 0 || Height == 0)
+	{
+		return EFI_INVALID_PARAMETER;
+	}
 
-	case EfiBltVideoToBltBuffer:
-		if (Delta == 0) 
+	// The engine merges rows, a rectangle hanging off the screen would
+	// run into memory past the framebuffer
+	if (BltOperation == EfiBltVideoToBltBuffer || BltOperation == EfiBltVideoToVideo)
+	{
+		if (SourceX + Width > HorizontalResolution || SourceY + Height > VerticalResolution)
 		{
-			Delta = Width * FB_BYTES_PER_PIXEL;
+			return EFI_INVALID_PARAMETER;
 		}
-
-		// A R G B
-		// A B G R
-		for (i = 0; i < Height; i++) 
+	}
+	if (BltOperation != EfiBltVideoToBltBuffer)
+	{
+		if (DestinationX + Width > HorizontalResolution || DestinationY + Height > VerticalResolution)
 		{
-			VidBuf = POS_TO_FB(SourceX, SourceY + i);
+			return EFI_INVALID_PARAMETER;
+		}
+	}
 
-			BltBuf = (UINT8 *)((UINTN)BltBuffer + (DestinationY + i) * Delta +
-				DestinationX * FB_BYTES_PER_PIXEL);
+	if (Delta == 0)
+	{
+		Delta = Width * FB_BYTES_PER_PIXEL;
+	}
 
-			gBS->CopyMem((VOID *)BltBuf, (VOID *)VidBuf, FB_BYTES_PER_PIXEL * Width);
+	// Reads come from the shadow, pick up direct writes to the screen first.
+	// Scaled modes read their own buffer.
+	if ((BltOperation == EfiBltVideoToBltBuffer || BltOperation == EfiBltVideoToVideo) &&
+		mModes[This->Mode->Mode].Scale == 1)
+	{
+		if (mModes[This->Mode->Mode].Landscape)
+		{
+			ShadowSync(SourceY, HorizontalResolution - SourceX - Width, Height, Width);
 		}
-		break;
-
-	case EfiBltBufferToVideo:
-		if (Delta == 0) 
+		else
 		{
-			Delta = Width * FB_BYTES_PER_PIXEL;
+			ShadowSync(SourceX, SourceY, Width, Height);
 		}
+	}
 
-		for (i = 0; i < Height; i++) 
-		{
-			VidBuf = POS_TO_FB(DestinationX, DestinationY + i);
-			BltBuf = (UINT8 *)((UINTN)BltBuffer + (SourceY + i) * Delta + SourceX * FB_BYTES_PER_PIXEL);
+	if (mModes[This->Mode->Mode].Landscape)
+	{
+		DisplayBltLandscape(DrawBuffer, DrawStride, BltBuf, BltOperation,
+			SourceX, SourceY, DestinationX, DestinationY, Width, Height, Delta);
+		return EFI_SUCCESS;
+	}
 
-			gBS->CopyMem((VOID *)VidBuf, (VOID *)BltBuf, Width * FB_BYTES_PER_PIXEL);
-		}
+	switch (BltOperation) {
+	case EfiBltVideoFill:
+		// The fill color is the first pixel of BltBuffer. Large fills and
+		// scrolls go to the offload engine if there is one.
+		BltEngineFill(POS_TO_FB(DestinationX, DestinationY), DrawStride, Width, Height, *(UINT32 *) BltBuf);
 		break;
 
-	case EfiBltVideoToVideo:
-		for (i = 0; i < Height; i++) 
-		{
-			VidBuf = POS_TO_FB(SourceX, SourceY + i);
-			VidBuf1 = POS_TO_FB(DestinationX, DestinationY + i);
+	case EfiBltVideoToBltBuffer:
+		BltCopy(
+			BltBuf + DestinationY * Delta + DestinationX * FB_BYTES_PER_PIXEL, Delta,
+			POS_TO_FB(SourceX, SourceY), DrawStride,
+			Width, Height
+		);
+		break;
 
-			gBS->CopyMem((VOID *)VidBuf1, (VOID *)VidBuf, Width * FB_BYTES_PER_PIXEL);
-		}
+	case EfiBltBufferToVideo:
+		BltCopy(
+			POS_TO_FB(DestinationX, DestinationY), DrawStride,
+			BltBuf + SourceY * Delta + SourceX * FB_BYTES_PER_PIXEL, Delta,
+			Width, Height
+		);
+		break;
+
+	case EfiBltVideoToVideo:
+		BltEngineCopy(
+			POS_TO_FB(DestinationX, DestinationY), DrawStride,
+			POS_TO_FB(SourceX, SourceY), DrawStride,
+			Width, Height
+		);
 		break;
 
 	default:
-		ASSERT_EFI_ERROR(EFI_SUCCESS);
 		break;
 	}
 
+	if (BltOperation != EfiBltVideoToBltBuffer)
+	{
+		DisplayMarkDirty(DestinationX, DestinationY, Width, Height);
+	}
+
 	return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayShowSplash
+(
+    IN  NINTENDO_SWITCH_SPLASH_PROTOCOL *This
+)
+{
+    EFI_STATUS Status;
+    UINTN FirstLine;
+    UINTN LineCount;
+
+    Status = SplashDraw(DisplayGetScreen(), &FirstLine, &LineCount);
+    if (EFI_ERROR(Status)) return Status;
+
+    ShadowMarkDirty(0, FirstLine, FixedPcdGet32(PcdMipiFrameBufferWidth), LineCount);
+    FlipMarkDirty(FirstLine, LineCount);
+
+    return EFI_SUCCESS;
+}
+
+STATIC NINTENDO_SWITCH_SPLASH_PROTOCOL mSplash = {
+    NINTENDO_SWITCH_SPLASH_PROTOCOL_REVISION,
+    DisplayShowSplash
+};
+
+/*
+ * The panned framebuffer console may have moved window A away from the
+ * framebuffer base. GOP and the OS expect the base to be scanned out, so
+ * move the visible lines back, restore the window and stop console panning.
+ */
+STATIC
+VOID
+DisplayReleaseConsolePan
+(
+    VOID
+)
+{
+    FBCON_PAN_CONTROL   *Pan = (FBCON_PAN_CONTROL *) FBCON_PAN_CONTROL_ADDRESS;
+    UINT8               *FrameBuffer = (UINT8 *) FixedPcdGet32(PcdMipiFrameBufferAddress);
+    UINTN               Size = FBCON_ROW_BYTES * FixedPcdGet32(PcdMipiFrameBufferHeight);
+
+    if (Pan->Signature != FBCON_PAN_SIGNATURE || (Pan->Flags & FBCON_PAN_FLAG_RELEASED))
+    {
+        return;
+    }
+
+    if (Pan->PanRow != 0)
+    {
+        CopyMem(FrameBuffer, FrameBuffer + Pan->PanRow * FBCON_ROW_BYTES, Size);
+        WriteBackDataCacheRange(FrameBuffer, Size);
+        Pan->PanRow = 0;
+    }
+
+    Pan->Flags |= FBCON_PAN_FLAG_RELEASED;
+    WriteBackDataCacheRange(Pan, sizeof(*Pan));
+
+    FBCON_PAN_WINDOW(FrameBuffer);
+}
+
+/*
+ * Publish only the first ModeCount modes, moving to mode 0 if the current
+ * one goes away, and reconnect the display so GraphicsConsole picks its
+ * mode again: the PCD resolution when the landscape mode is published, the
+ * current mode otherwise.
+ */
+STATIC
+VOID
+DisplayLimitModes
+(
+    IN EFI_HANDLE   DisplayHandle,
+    IN UINT32       ModeCount
+)
+{
+    if (mDisplay.Mode->MaxMode == ModeCount)
+    {
+        return;
+    }
+
+    gBS->DisconnectController(DisplayHandle, NULL, NULL);
+    mDisplay.Mode->MaxMode = ModeCount;
+    if (mDisplay.Mode->Mode >= ModeCount)
+    {
+        DisplaySetMode(&mDisplay, 0);
+    }
+    gBS->ConnectController(DisplayHandle, NULL, NULL, TRUE);
+}
+
+/*
+ * Function: DisplayBootReturnPoll
+ * Flow    : BDS deletes BootCurrent when a boot option returns, and sets it
+ *           to another option before starting the next one or the boot
+ *           manager menu. Either way the option that wanted mode 0 is
+ *           gone, publish all modes again.
+ */
+STATIC
+VOID
+EFIAPI
+DisplayBootReturnPoll
+(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    EFI_STATUS Status;
+    UINT16 BootCurrent;
+    UINTN DataSize = sizeof(BootCurrent);
+
+    Status = gRT->GetVariable(EFI_BOOT_CURRENT_VARIABLE_NAME, &gEfiGlobalVariableGuid, NULL, &DataSize, &BootCurrent);
+    if (!EFI_ERROR(Status) && BootCurrent == mBootOption)
+    {
+        return;
+    }
+
+    gBS->SetTimer(Event, TimerCancel, 0);
+    DisplayLimitModes(Context, DISPLAY_MODE_COUNT);
+}
+
+/*
+ * Function: DisplayReadyToBoot
+ * Flow    : OS loaders expect the current mode to have a linear
+ *           framebuffer. Before each boot option starts, stop publishing
+ *           the landscape and scaled modes and go back to mode 0, until
+ *           the option returns. The boot manager menu is started without
+ *           ReadyToBoot and stays in landscape.
+ */
+STATIC
+VOID
+EFIAPI
+DisplayReadyToBoot
+(
+    IN EFI_EVENT    Event,
+    IN VOID         *Context
+)
+{
+    UINTN DataSize = sizeof(mBootOption);
+
+    if (mBootReturnTimer == NULL ||
+        EFI_ERROR(gRT->GetVariable(EFI_BOOT_CURRENT_VARIABLE_NAME, &gEfiGlobalVariableGuid, NULL, &DataSize, &mBootOption)))
+    {
+        // No way to tell when it returns, stay on mode 0 from now on
+        if (mBootReturnTimer != NULL)
+        {
+            gBS->SetTimer(mBootReturnTimer, TimerCancel, 0);
+        }
+    }
+    else
+    {
+        gBS->SetTimer(mBootReturnTimer, TimerPeriodic, DISPLAY_BOOT_RETURN_POLL);
+    }
+
+    DisplayLimitModes(Context, 1);
+}
+
 EFI_STATUS
 EFIAPI
 SimpleFbDxeInitialize
@@ -257,6 +685,7 @@ SimpleFbDxeInitialize
 
     EFI_STATUS          Status                  = EFI_SUCCESS;
     EFI_HANDLE          hUEFIDisplayHandle      = NULL;
+    EFI_EVENT           ReadyToBootEvent;
 
     /* Retrieve simple frame buffer from pre-SEC bootloader */
     DEBUG((EFI_D_ERROR, "SimpleFbDxe: Retrieve MIPI FrameBuffer parameters from PCD\n"));
@@ -300,25 +729,59 @@ SimpleFbDxeInitialize
         ZeroMem(mDisplay.Mode->Info, sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION));
     }
 
+    /* Timed from here, the early exits above must not leave it open */
+    PERF_START(ImageHandle, "FbInit", NULL, 0);
+
+    /* Portrait is what the panel scans out, landscape is rotated by Blt */
+    mModes[0].HorizontalResolution = MipiFrameBufferWidth;
+    mModes[0].VerticalResolution = MipiFrameBufferHeight;
+    mModes[0].Landscape = FALSE;
+    mModes[0].Scale = 1;
+    mModes[1].HorizontalResolution = MipiFrameBufferHeight;
+    mModes[1].VerticalResolution = PcdGet32(PcdMipiFrameBufferVisibleWidth);
+    mModes[1].Landscape = TRUE;
+    mModes[1].Scale = 1;
+
+    /* Half resolution modes for tools that don't need the full panel */
+    mScaleWidth = PcdGet32(PcdMipiFrameBufferVisibleWidth) / 2;
+    mScaleHeight = MipiFrameBufferHeight / 2;
+    mModes[2].HorizontalResolution = mScaleWidth;
+    mModes[2].VerticalResolution = mScaleHeight;
+    mModes[2].Landscape = FALSE;
+    mModes[2].Scale = 2;
+    mModes[3].HorizontalResolution = mScaleHeight;
+    mModes[3].VerticalResolution = mScaleWidth;
+    mModes[3].Landscape = TRUE;
+    mModes[3].Scale = 2;
+
     /* Set information */
-    mDisplay.Mode->MaxMode = 1;
+    mDisplay.Mode->MaxMode = DISPLAY_MODE_COUNT;
     mDisplay.Mode->Mode = 0;
-    mDisplay.Mode->Info->Version = 0;
-
-    mDisplay.Mode->Info->HorizontalResolution = MipiFrameBufferWidth;
-    mDisplay.Mode->Info->VerticalResolution = MipiFrameBufferHeight;
+    DisplayGetModeInfo(0, mDisplay.Mode->Info);
 
     /* SimpleFB runs on a8r8g8b8 (VIDEO_BPP32) for this device */
     UINT32 LineLength = MipiFrameBufferWidth * VNBYTES(VIDEO_BPP32);
     UINT32 FrameBufferSize = LineLength * MipiFrameBufferHeight;
     EFI_PHYSICAL_ADDRESS FrameBufferAddress = MipiFrameBufferAddr;
 
-    mDisplay.Mode->Info->PixelsPerScanLine = MipiFrameBufferWidth;
-    mDisplay.Mode->Info->PixelFormat = PixelBlueGreenRedReserved8BitPerColor;
     mDisplay.Mode->SizeOfInfo = sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
     mDisplay.Mode->FrameBufferBase = FrameBufferAddress;
     mDisplay.Mode->FrameBufferSize = FrameBufferSize;
 
+    if (FeaturePcdGet(PcdFrameBufferConsoleHardwareScroll))
+    {
+        DisplayReleaseConsolePan();
+    }
+
+    /* Fall back to drawing straight into the framebuffer on failure */
+    if (FeaturePcdGet(PcdFrameBufferShadowEnable))
+    {
+        ShadowInitialize((VOID *)(UINTN)FrameBufferAddress, MipiFrameBufferWidth, MipiFrameBufferHeight);
+    }
+
+    /* Without VIC, Blt stays on the CPU */
+    VicInitialize();
+
     /* Register handle */
     Status = gBS->InstallMultipleProtocolInterfaces(
         &hUEFIDisplayHandle,
@@ -330,6 +793,59 @@ SimpleFbDxeInitialize
 
     ASSERT_EFI_ERROR (Status);
 
+    /* GraphicsConsole picks landscape, hand boot options mode 0 */
+    if (!EFI_ERROR(Status))
+    {
+        gBS->CreateEvent(
+            EVT_TIMER | EVT_NOTIFY_SIGNAL,
+            TPL_CALLBACK,
+            DisplayBootReturnPoll,
+            hUEFIDisplayHandle,
+            &mBootReturnTimer
+        );
+        EfiCreateEventReadyToBootEx(
+            TPL_CALLBACK,
+            DisplayReadyToBoot,
+            hUEFIDisplayHandle,
+            &ReadyToBootEvent
+        );
+    }
+
+    /* Double buffering is opt-in for clients through the flip protocol */
+    if (!EFI_ERROR(Status) && FeaturePcdGet(PcdFrameBufferFlipEnable))
+    {
+        Status = FlipInitialize((VOID *)(UINTN)FrameBufferAddress, LineLength, MipiFrameBufferHeight);
+        if (!EFI_ERROR(Status))
+        {
+            Status = gBS->InstallMultipleProtocolInterfaces(
+                &hUEFIDisplayHandle,
+                &gNintendoSwitchDisplayFlipProtocolGuid,
+                &mDisplayFlip,
+                NULL);
+        }
+        ASSERT_EFI_ERROR (Status);
+    }
+
+    /* First light: the splash goes up before any console is connected */
+    if (!EFI_ERROR(Status) && !EFI_ERROR(SplashInitialize()))
+    {
+        DisplayShowSplash(&mSplash);
+        Status = gBS->InstallMultipleProtocolInterfaces(
+            &hUEFIDisplayHandle,
+            &gNintendoSwitchSplashProtocolGuid,
+            &mSplash,
+            NULL);
+        ASSERT_EFI_ERROR (Status);
+    }
+
+    /* One log ring and drain timer for the deferred console of all modules */
+    if (!EFI_ERROR(Status) && FeaturePcdGet(PcdFrameBufferConsoleAsync))
+    {
+        ConsoleRingInitialize();
+    }
+
+    PERF_END(ImageHandle, "FbInit", NULL, 0);
+
     return Status;
 
 }
\ No newline at end of file
@@ -0,0 +1,207 @@
+/* Splash.c: Boot splash stored in the framebuffer's own format */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DxeServicesLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+
+#include <Guid/Splash.h>
+
+#include "Include/Blt.h"
+#include "Include/Splash.h"
+
+STATIC UINT8 *mSplashPixels = NULL;
+STATIC UINTN mSplashFirstLine;
+STATIC UINTN mSplashLineCount;
+
+/*
+ * Function: SplashLz4Decompress
+ * Flow    : Decode one LZ4 block. Every sequence is a token, literals, a
+ *           16 bit back offset and a match; the last one stops after its
+ *           literals. Anything running past either buffer is corrupt.
+ */
+STATIC
+EFI_STATUS
+SplashLz4Decompress(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationSize,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceSize
+)
+{
+    CONST UINT8 *SourceEnd = Source + SourceSize;
+    UINT8 *Output = Destination;
+    UINT8 *OutputEnd = Destination + DestinationSize;
+    UINTN Length;
+    UINTN Offset;
+    UINT8 Token;
+    UINT8 Byte;
+
+    while (Source < SourceEnd)
+    {
+        Token = *Source++;
+
+        Length = Token >> 4;
+        if (Length == 15)
+        {
+            do
+            {
+                if (Source >= SourceEnd) return EFI_VOLUME_CORRUPTED;
+                Byte = *Source++;
+                Length += Byte;
+            } while (Byte == 255);
+        }
+
+        if (Length > (UINTN)(SourceEnd - Source) || Length > (UINTN)(OutputEnd - Output))
+        {
+            return EFI_VOLUME_CORRUPTED;
+        }
+        CopyMem(Output, Source, Length);
+        Output += Length;
+        Source += Length;
+
+        if (Source == SourceEnd)
+        {
+            break;
+        }
+
+        if (SourceEnd - Source < 2) return EFI_VOLUME_CORRUPTED;
+        Offset = Source[0] | (Source[1] << 8);
+        Source += 2;
+        if (Offset == 0 || Offset > (UINTN)(Output - Destination))
+        {
+            return EFI_VOLUME_CORRUPTED;
+        }
+
+        Length = (Token & 0xF) + 4;
+        if ((Token & 0xF) == 15)
+        {
+            do
+            {
+                if (Source >= SourceEnd) return EFI_VOLUME_CORRUPTED;
+                Byte = *Source++;
+                Length += Byte;
+            } while (Byte == 255);
+        }
+
+        if (Length > (UINTN)(OutputEnd - Output))
+        {
+            return EFI_VOLUME_CORRUPTED;
+        }
+
+        // Matches may overlap their own output, copy front to back
+        for (; Length != 0; Length--, Output++)
+        {
+            *Output = *(Output - Offset);
+        }
+    }
+
+    return (Output == OutputEnd) ? EFI_SUCCESS : EFI_VOLUME_CORRUPTED;
+}
+
+/*
+ * Function: SplashInitialize
+ * Flow    : Pick the splash out of the firmware volume and, if it is
+ *           compressed, unpack it once, so every later draw is a copy.
+ */
+EFI_STATUS
+SplashInitialize(
+    VOID
+)
+{
+    EFI_STATUS Status;
+    SPLASH_HEADER *Header = NULL;
+    UINTN Size;
+    UINTN PixelSize;
+    UINT8 *Pixels;
+
+    Status = GetSectionFromAnyFv(&gNintendoSwitchSplashFileGuid, EFI_SECTION_RAW, 0, (VOID **) &Header, &Size);
+    if (EFI_ERROR(Status))
+    {
+        return Status;
+    }
+
+    if (Size < sizeof(SPLASH_HEADER) ||
+        Header->Signature != SPLASH_SIGNATURE ||
+        Header->Version != SPLASH_VERSION ||
+        Header->DataSize > Size - sizeof(SPLASH_HEADER))
+    {
+        Status = EFI_VOLUME_CORRUPTED;
+        goto exit;
+    }
+
+    if (Header->ScreenWidth != FixedPcdGet32(PcdMipiFrameBufferWidth) ||
+        Header->ScreenHeight != FixedPcdGet32(PcdMipiFrameBufferHeight) ||
+        Header->LineCount > Header->ScreenHeight - MIN(Header->FirstLine, Header->ScreenHeight))
+    {
+        DEBUG((EFI_D_ERROR, "SimpleFbDxe: Splash was made for a %dx%d screen\n",
+            Header->ScreenWidth, Header->ScreenHeight));
+        Status = EFI_UNSUPPORTED;
+        goto exit;
+    }
+
+    PixelSize = Header->LineCount * Header->ScreenWidth * BLT_BYTES_PER_PIXEL;
+    Pixels = AllocatePool(PixelSize);
+    if (Pixels == NULL)
+    {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto exit;
+    }
+
+    if (Header->Flags & SPLASH_FLAG_LZ4)
+    {
+        Status = SplashLz4Decompress(Pixels, PixelSize, (UINT8 *)(Header + 1), Header->DataSize);
+    }
+    else if (Header->DataSize == PixelSize)
+    {
+        CopyMem(Pixels, Header + 1, PixelSize);
+    }
+    else
+    {
+        Status = EFI_VOLUME_CORRUPTED;
+    }
+
+    if (EFI_ERROR(Status))
+    {
+        FreePool(Pixels);
+        goto exit;
+    }
+
+    mSplashPixels = Pixels;
+    mSplashFirstLine = Header->FirstLine;
+    mSplashLineCount = Header->LineCount;
+
+exit:
+    if (EFI_ERROR(Status))
+    {
+        DEBUG((EFI_D_ERROR, "SimpleFbDxe: Splash not usable: %r\n", Status));
+    }
+    FreePool(Header);
+    return Status;
+}
+
+EFI_STATUS
+SplashDraw(
+    IN  UINT8   *Screen,
+    OUT UINTN   *FirstLine,
+    OUT UINTN   *LineCount
+)
+{
+    UINTN Width = FixedPcdGet32(PcdMipiFrameBufferWidth);
+    UINTN LineBytes = Width * BLT_BYTES_PER_PIXEL;
+
+    if (mSplashPixels == NULL)
+    {
+        return EFI_NOT_FOUND;
+    }
+
+    // Full lines on both sides, this is a single run
+    BltCopy(Screen + mSplashFirstLine * LineBytes, LineBytes, mSplashPixels, LineBytes, Width, mSplashLineCount);
+
+    *FirstLine = mSplashFirstLine;
+    *LineCount = mSplashLineCount;
+    return EFI_SUCCESS;
+}
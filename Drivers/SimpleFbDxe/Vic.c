@@ -0,0 +1,243 @@
+/* Vic.c: Blt offload to VIC through a Host1x channel */
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include <Foundation/Types.h>
+#include <Device/T210.h>
+#include <Device/Pmc.h>
+#include <Library/ClockLib.h>
+
+#include "Include/Blt.h"
+#include "Include/Host1x.h"
+#include "Include/Vic.h"
+
+/* Nothing else submits to Host1x before the OS takes it over */
+#define VIC_BLT_CHANNEL         0
+#define VIC_BLT_SYNCPT          1
+#define VIC_BLT_TIMEOUT_US      100000
+
+#define VIC_PUSH_WORDS          4096
+#define VIC_CONFIG_SLOTS        128
+
+/* Clock enable and reset bits of CLK_OUT_ENB_L/X and RST_DEVICES_L/X */
+#define VIC_CLOCK_HOST1X        BIT28
+#define VIC_CLOCK_VIC           BIT18
+
+/* Falcon of VIC, halted until firmware is booted on it */
+#define VIC_FALCON_CPUCTL       0x1100
+#define VIC_FALCON_CPUCTL_HALTED    BIT4
+
+STATIC VIC_STREAM mStream;
+STATIC EFI_EVENT mExitBootServicesEvent = NULL;
+
+/*
+ * Function: VicSubmit
+ * Flow    : Run the finished stream on the Blt channel and wait for its
+ *           syncpoint increment. On a timeout the channel is stopped and
+ *           the engine withdrawn, the caller falls back to the CPU.
+ */
+STATIC
+EFI_STATUS
+VicSubmit(
+    VOID
+)
+{
+    UINTN Channel = HOST1X_BASE + VIC_BLT_CHANNEL * HOST1X_CHANNEL_SIZE;
+    UINTN Syncpoint = HOST1X_BASE + HOST1X_SYNC_SYNCPT(VIC_BLT_SYNCPT);
+    UINT32 Start = (UINT32)(UINTN)mStream.Words;
+    UINT32 End = Start + (UINT32)(mStream.WordCount * sizeof(UINT32));
+    UINT32 Fence = MmioRead32(Syncpoint) + 1;
+    UINTN Waited;
+
+    WriteBackDataCacheRange(mStream.Words, mStream.WordCount * sizeof(UINT32));
+    WriteBackDataCacheRange(mStream.Configs, mStream.ConfigCount * VIC_OFFSET_ALIGN);
+
+    // Point GET at the start of the buffer, then move PUT to its end
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMACTRL, HOST1X_CHANNEL_DMACTRL_DMASTOP);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMASTART, Start);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMAEND, End);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMAPUT, Start);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMACTRL, HOST1X_CHANNEL_DMACTRL_DMASTOP |
+        HOST1X_CHANNEL_DMACTRL_DMAGETRST | HOST1X_CHANNEL_DMACTRL_DMAINITGET);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMACTRL, 0);
+    MmioWrite32(Channel + HOST1X_CHANNEL_DMAPUT, End);
+
+    for (Waited = 0; (INT32)(MmioRead32(Syncpoint) - Fence) < 0; Waited++)
+    {
+        if (Waited == VIC_BLT_TIMEOUT_US)
+        {
+            MmioWrite32(Channel + HOST1X_CHANNEL_DMACTRL, HOST1X_CHANNEL_DMACTRL_DMASTOP);
+            mBltEngine = NULL;
+            DEBUG((EFI_D_ERROR, "VIC Blt timed out, offload disabled\n"));
+            return EFI_TIMEOUT;
+        }
+        MicroSecondDelay(1);
+    }
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * VIC writes behind the data cache: dirty lines of the destination must
+ * not land on top of its output later, and lines fetched while it runs
+ * must not be read afterwards.
+ */
+STATIC
+EFI_STATUS
+VicRun(
+    IN  UINT8           *Destination,
+    IN  UINTN           Length
+)
+{
+    EFI_STATUS Status;
+
+    Status = VicStreamFinish(&mStream, VIC_BLT_SYNCPT);
+    if (!EFI_ERROR(Status))
+    {
+        WriteBackInvalidateDataCacheRange(Destination, Length);
+        Status = VicSubmit();
+        InvalidateDataCacheRange(Destination, Length);
+    }
+
+    VicStreamReset(&mStream);
+    return Status;
+}
+
+STATIC
+EFI_STATUS
+VicBltFill(
+    OUT UINT8       *Destination,
+    IN  UINTN       Stride,
+    IN  UINTN       Width,
+    IN  UINTN       Height,
+    IN  UINT32      Color
+)
+{
+    EFI_STATUS Status;
+
+    Status = VicStreamFill(&mStream, Destination, Stride, Width, Height, Color);
+    if (EFI_ERROR(Status))
+    {
+        VicStreamReset(&mStream);
+        return Status;
+    }
+
+    return VicRun(Destination, (Height - 1) * Stride + Width * BLT_BYTES_PER_PIXEL);
+}
+
+STATIC
+EFI_STATUS
+VicBltCopy(
+    OUT UINT8       *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST UINT8 *Source,
+    IN  UINTN       SourceStride,
+    IN  UINTN       Width,
+    IN  UINTN       Height
+)
+{
+    EFI_STATUS Status;
+
+    Status = VicStreamCopy(&mStream, Destination, DestinationStride, Source, SourceStride, Width, Height);
+    if (EFI_ERROR(Status))
+    {
+        VicStreamReset(&mStream);
+        return Status;
+    }
+
+    WriteBackDataCacheRange((VOID *)Source, (Height - 1) * SourceStride + Width * BLT_BYTES_PER_PIXEL);
+    return VicRun(Destination, (Height - 1) * DestinationStride + Width * BLT_BYTES_PER_PIXEL);
+}
+
+STATIC CONST BLT_ENGINE mVicEngine = {
+    VicBltFill,
+    VicBltCopy
+};
+
+/* The OS owns Host1x from here on */
+STATIC
+VOID
+EFIAPI
+VicExitBootServices(
+    IN  EFI_EVENT   Event,
+    IN  VOID        *Context
+)
+{
+    mBltEngine = NULL;
+}
+
+/*
+ * Function: VicInitialize
+ * Flow    : Hand large Blt fills and copies to VIC, if PcdDisplayVicBlt
+ *           asks for it and VIC is up. VIC only serves methods once its
+ *           Falcon runs firmware, and nothing in this package loads one,
+ *           so the CPU path stays in charge unless an earlier stage did.
+ *           Registers of an unclocked or power gated unit are not touched.
+ */
+EFI_STATUS
+VicInitialize(
+    VOID
+)
+{
+    EFI_PHYSICAL_ADDRESS Buffer = MAX_UINT32;
+    UINTN PushBytes = VIC_PUSH_WORDS * sizeof(UINT32);
+    EFI_STATUS Status;
+
+    if (!FeaturePcdGet(PcdDisplayVicBlt))
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    if (!(PMC(APBDEV_PMC_PWRGATE_STATUS) & (1 << POWER_PARTID_VIC)) ||
+        !(CLOCK(CLK_RST_CONTROLLER_CLK_OUT_ENB_L) & VIC_CLOCK_HOST1X) ||
+        (CLOCK(CLK_RST_CONTROLLER_RST_DEVICES_L) & VIC_CLOCK_HOST1X) ||
+        !(CLOCK(CLK_RST_CONTROLLER_CLK_OUT_ENB_X) & VIC_CLOCK_VIC) ||
+        (CLOCK(CLK_RST_CONTROLLER_RST_DEVICES_X) & VIC_CLOCK_VIC) ||
+        (VIC(VIC_FALCON_CPUCTL) & VIC_FALCON_CPUCTL_HALTED))
+    {
+        DEBUG((EFI_D_INFO, "VIC not running, Blt stays on the CPU\n"));
+        return EFI_NOT_READY;
+    }
+
+    // DMASTART and DMAEND are 32-bit
+    Status = gBS->AllocatePages(
+        AllocateMaxAddress,
+        EfiBootServicesData,
+        EFI_SIZE_TO_PAGES(PushBytes + VIC_CONFIG_SLOTS * VIC_OFFSET_ALIGN),
+        &Buffer
+    );
+    if (EFI_ERROR(Status))
+    {
+        return Status;
+    }
+
+    mStream.Configs = (UINT8 *)(UINTN)Buffer;
+    mStream.ConfigLimit = VIC_CONFIG_SLOTS;
+    mStream.Words = (UINT32 *)(mStream.Configs + VIC_CONFIG_SLOTS * VIC_OFFSET_ALIGN);
+    mStream.WordLimit = VIC_PUSH_WORDS;
+    VicStreamReset(&mStream);
+
+    Status = gBS->CreateEvent(
+        EVT_SIGNAL_EXIT_BOOT_SERVICES,
+        TPL_NOTIFY,
+        VicExitBootServices,
+        NULL,
+        &mExitBootServicesEvent
+    );
+    if (EFI_ERROR(Status))
+    {
+        gBS->FreePages(Buffer, EFI_SIZE_TO_PAGES(PushBytes + VIC_CONFIG_SLOTS * VIC_OFFSET_ALIGN));
+        return Status;
+    }
+
+    mBltEngine = &mVicEngine;
+    return EFI_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/* VicStream.c: Host1x command streams running Blt rectangles on VIC */
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+
+#include "Include/Blt.h"
+#include "Include/Host1x.h"
+#include "Include/Vic.h"
+
+/* SETCLASS and SET_APPLICATION_ID open every stream */
+#define VIC_STREAM_HEADER_WORDS     4
+
+/* Method writes of one rectangle: control, config, output, source, execute */
+#define VIC_RECTANGLE_WORDS         (5 * 3)
+
+STATIC
+VOID
+VicStreamMethod(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT32          Method,
+    IN  UINT32          Data
+)
+{
+    Stream->Words[Stream->WordCount++] = HOST1X_OPCODE_INCR(VIC_THI_METHOD0, 2);
+    Stream->Words[Stream->WordCount++] = Method >> 2;
+    Stream->Words[Stream->WordCount++] = Data;
+}
+
+/*
+ * Function: VicOffset
+ * Flow    : Offset register value for the surface holding Address, which
+ *           starts at the VIC_OFFSET_ALIGN boundary below it. Returns
+ *           the distance from there to Address.
+ */
+STATIC
+UINTN
+VicOffset(
+    IN  UINTN           Address,
+    OUT UINT32          *Offset
+)
+{
+    *Offset = (UINT32)(Address / VIC_OFFSET_ALIGN);
+    return Address % VIC_OFFSET_ALIGN;
+}
+
+STATIC
+EFI_STATUS
+VicStreamRectangle(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT32          Operation,
+    IN  UINT32          Color,
+    IN  UINTN           Destination,
+    IN  UINTN           DestinationStride,
+    IN  UINTN           Source,
+    IN  UINTN           SourceStride,
+    IN  UINTN           Width,
+    IN  UINTN           Height
+)
+{
+    UINTN RowBytes = Width * BLT_BYTES_PER_PIXEL;
+    VIC_BLT_CONFIG *Config;
+    UINT32 DestinationOffset, SourceOffset = 0, ConfigOffset;
+    UINTN Words = VIC_RECTANGLE_WORDS;
+
+    if (Stream->WordCount == 0)
+    {
+        Words += VIC_STREAM_HEADER_WORDS;
+    }
+
+    if (Stream->WordCount + Words > Stream->WordLimit ||
+        Stream->ConfigCount == Stream->ConfigLimit)
+    {
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    if ((Destination | Source) % BLT_BYTES_PER_PIXEL != 0 ||
+        Destination + (Height - 1) * DestinationStride + RowBytes > VIC_OFFSET_LIMIT ||
+        Source + (Height - 1) * SourceStride + RowBytes > VIC_OFFSET_LIMIT ||
+        (UINTN)Stream->Configs + Stream->ConfigLimit * VIC_OFFSET_ALIGN > VIC_OFFSET_LIMIT ||
+        Height > MAX_UINT32 || Width > MAX_UINT32 ||
+        DestinationStride > MAX_UINT32 || SourceStride > MAX_UINT32)
+    {
+        return EFI_UNSUPPORTED;
+    }
+
+    Config = (VIC_BLT_CONFIG *)(Stream->Configs + Stream->ConfigCount++ * VIC_OFFSET_ALIGN);
+    Config->Operation = Operation;
+    Config->Color = Color;
+    Config->Width = (UINT32)Width;
+    Config->Height = (UINT32)Height;
+    Config->DestinationX = (UINT32)(VicOffset(Destination, &DestinationOffset) / BLT_BYTES_PER_PIXEL);
+    Config->DestinationStride = (UINT32)DestinationStride;
+    Config->SourceX = 0;
+    Config->SourceStride = (UINT32)SourceStride;
+    VicOffset((UINTN)Config, &ConfigOffset);
+
+    if (Stream->WordCount == 0)
+    {
+        Stream->Words[Stream->WordCount++] = HOST1X_OPCODE_SETCLASS(0, VIC_CLASS_ID, 0);
+        VicStreamMethod(Stream, VIC_SET_APPLICATION_ID, VIC_APPLICATION_ID_COMPOSITOR);
+    }
+
+    VicStreamMethod(Stream, VIC_SET_CONTROL_PARAMS, VIC_CONTROL_PARAMS_CONFIG_SIZE(sizeof(*Config)));
+    VicStreamMethod(Stream, VIC_SET_CONFIG_STRUCT_OFFSET, ConfigOffset);
+    VicStreamMethod(Stream, VIC_SET_OUTPUT_SURFACE_LUMA_OFFSET, DestinationOffset);
+    if (Operation == VIC_BLT_COPY)
+    {
+        Config->SourceX = (UINT32)(VicOffset(Source, &SourceOffset) / BLT_BYTES_PER_PIXEL);
+        VicStreamMethod(Stream, VIC_SET_SURFACE0_SLOT0_LUMA_OFFSET, SourceOffset);
+    }
+    VicStreamMethod(Stream, VIC_EXECUTE, 0);
+
+    return EFI_SUCCESS;
+}
+
+VOID
+VicStreamReset(
+    IN OUT VIC_STREAM   *Stream
+)
+{
+    Stream->WordCount = 0;
+    Stream->ConfigCount = 0;
+}
+
+EFI_STATUS
+VicStreamFill(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT8           *Destination,
+    IN  UINTN           Stride,
+    IN  UINTN           Width,
+    IN  UINTN           Height,
+    IN  UINT32          Color
+)
+{
+    if (Width == 0 || Height == 0)
+    {
+        return EFI_SUCCESS;
+    }
+
+    return VicStreamRectangle(Stream, VIC_BLT_FILL, Color,
+        (UINTN)Destination, Stride, (UINTN)Destination, Stride, Width, Height);
+}
+
+/*
+ * Function: VicStreamCopy
+ * Flow    : VIC reads and writes a rectangle in an order of its own, so
+ *           an overlapping copy is cut into bands of rows whose source
+ *           and destination don't overlap. They are queued in the order
+ *           memmove would take them: from the top when the destination
+ *           lies below the source in memory, from the bottom otherwise.
+ *           Rectangles overlapping within a row are left to the CPU.
+ */
+EFI_STATUS
+VicStreamCopy(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT8           *Destination,
+    IN  UINTN           DestinationStride,
+    IN  CONST UINT8     *Source,
+    IN  UINTN           SourceStride,
+    IN  UINTN           Width,
+    IN  UINTN           Height
+)
+{
+    UINTN RowBytes = Width * BLT_BYTES_PER_PIXEL;
+    UINTN Target = (UINTN)Destination;
+    UINTN Origin = (UINTN)Source;
+    UINTN WordCount = Stream->WordCount;
+    UINTN ConfigCount = Stream->ConfigCount;
+    UINTN Distance, Band, Bands, Index, Row;
+    EFI_STATUS Status;
+
+    if (Width == 0 || Height == 0)
+    {
+        return EFI_SUCCESS;
+    }
+
+    Band = Height;
+    if (Target < Origin + (Height - 1) * SourceStride + RowBytes &&
+        Origin < Target + (Height - 1) * DestinationStride + RowBytes)
+    {
+        Distance = Target > Origin ? Target - Origin : Origin - Target;
+        if (DestinationStride != SourceStride || Distance < RowBytes)
+        {
+            return EFI_UNSUPPORTED;
+        }
+        Band = (Distance - RowBytes) / SourceStride + 1;
+    }
+
+    Bands = (Height + Band - 1) / Band;
+    for (Index = 0; Index < Bands; Index++)
+    {
+        Row = (Target < Origin ? Index : Bands - 1 - Index) * Band;
+        Status = VicStreamRectangle(Stream, VIC_BLT_COPY, 0,
+            Target + Row * DestinationStride, DestinationStride,
+            Origin + Row * SourceStride, SourceStride,
+            Width, MIN(Band, Height - Row));
+        if (EFI_ERROR(Status))
+        {
+            Stream->WordCount = WordCount;
+            Stream->ConfigCount = ConfigCount;
+            return Status;
+        }
+    }
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * Function: VicStreamFinish
+ * Flow    : Close the stream with a syncpoint increment, which VIC only
+ *           performs once the last rectangle is written.
+ */
+EFI_STATUS
+VicStreamFinish(
+    IN OUT VIC_STREAM   *Stream,
+    IN  UINT32          Syncpoint
+)
+{
+    if (Stream->WordCount == 0 || Stream->WordCount == Stream->WordLimit)
+    {
+        return EFI_NOT_READY;
+    }
+
+    Stream->Words[Stream->WordCount++] =
+        HOST1X_OPCODE_IMM(HOST1X_INCR_SYNCPT, HOST1X_INCR_SYNCPT_OP_DONE | Syncpoint);
+
+    return EFI_SUCCESS;
+}
@@ -94,13 +94,24 @@ static ARM_MEMORY_REGION_DESCRIPTOR_EX gDeviceMemoryDescriptorEx[] =
 	{
 		// HLOS memory 2
 		0x801f0000,
-		0x5f990000,
+		0x5f950000,
 		EFI_RESOURCE_SYSTEM_MEMORY,
 		SYSTEM_MEMORY_RESOURCE_ATTR_CAPABILITIES,
 		ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK,
 		AddMem,
 		EfiConventionalMemory
 	},
+	{
+		// Boot log, see PcdBootLogBase. Write-through so that the records
+		// are in DRAM when a warm reset happens.
+		0xdfb40000,
+		0x40000,
+		EFI_RESOURCE_MEMORY_RESERVED,
+		EFI_RESOURCE_ATTRIBUTE_WRITE_THROUGH_CACHEABLE,
+		ARM_MEMORY_REGION_ATTRIBUTE_WRITE_THROUGH,
+		AddMem,
+		EfiReservedMemoryType
+	},
 	{
 		// Display Reserved
 		0xdfb80000,
@@ -0,0 +1,69 @@
+#ifndef __BLOCK_IO_TRACE_GUID_H__
+#define __BLOCK_IO_TRACE_GUID_H__
+
+//
+// Configuration table that points at the SD/MMC block I/O trace ring.
+// The ring lives in reserved memory so it is still readable by the OS
+// after ExitBootServices().
+//
+#define BLOCK_IO_TRACE_TABLE_GUID \
+    { 0x6a1e2c7b, 0x3d4f, 0x4b8a, { 0x9e, 0x51, 0x2c, 0x7d, 0x18, 0xa0, 0x4f, 0x63 } }
+
+#define BLOCK_IO_TRACE_SIGNATURE    SIGNATURE_32('b', 'i', 'o', 't')
+#define BLOCK_IO_TRACE_VERSION      1
+
+//
+// Operation codes
+//
+#define BLOCK_IO_TRACE_OP_READ      0   // EFI_BLOCK_IO_PROTOCOL.ReadBlocks
+#define BLOCK_IO_TRACE_OP_WRITE     1   // EFI_BLOCK_IO_PROTOCOL.WriteBlocks
+#define BLOCK_IO_TRACE_OP_FLUSH     2   // EFI_BLOCK_IO_PROTOCOL.FlushBlocks
+#define BLOCK_IO_TRACE_OP_BREAD     3   // Host level mmc_bread()
+
+//
+// Record flags
+//
+#define BLOCK_IO_TRACE_FLAG_BOUNCE  BIT0    // At least one transfer went through a bounce buffer
+#define BLOCK_IO_TRACE_FLAG_ERROR   BIT1    // Request failed
+
+#pragma pack(1)
+
+typedef struct {
+    //
+    // Sequence is written last. A record whose Sequence does not match
+    // the slot it was read from is either stale or still being written.
+    //
+    UINT32  Sequence;
+    UINT8   Op;
+    UINT8   Flags;
+    UINT16  Retries;
+    UINT64  Lba;
+    UINT32  Blocks;
+    UINT32  Reserved;
+    UINT64  StartTicks;
+    UINT64  EndTicks;
+} BLOCK_IO_TRACE_RECORD;
+
+typedef struct {
+    UINT32  Signature;
+    UINT32  Version;
+    UINT32  RecordSize;
+    UINT32  RecordCount;    // Ring capacity, power of two
+    UINT64  TimerFrequency; // Ticks per second of Start/EndTicks
+    //
+    // Total number of records ever produced. The next record goes to
+    // slot (Head % RecordCount).
+    //
+    volatile UINT32 Head;
+    UINT32  Reserved;
+    // BLOCK_IO_TRACE_RECORD Records[RecordCount];
+} BLOCK_IO_TRACE_HEADER;
+
+#pragma pack()
+
+#define BLOCK_IO_TRACE_RECORDS(Header) \
+    ((BLOCK_IO_TRACE_RECORD *) ((UINT8 *) (Header) + sizeof(BLOCK_IO_TRACE_HEADER)))
+
+extern EFI_GUID gNintendoSwitchBlockIoTraceTableGuid;
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef __BOOT_LOG_GUID_H__
+#define __BOOT_LOG_GUID_H__
+
+//
+// Configuration table that points at the persistent boot log. The log sits
+// in a fixed, write-through mapped carveout (PcdBootLogBase/PcdBootLogSize)
+// so it survives a warm reset and keeps the output of earlier boots.
+//
+#define BOOT_LOG_TABLE_GUID \
+    { 0x3b8c5e2a, 0x71d4, 0x4f06, { 0xa8, 0x2e, 0x5d, 0x94, 0x0b, 0xc7, 0x36, 0xe1 } }
+
+#define BOOT_LOG_SIGNATURE          SIGNATURE_32('b', 'l', 'o', 'g')
+#define BOOT_LOG_VERSION            3
+
+#define BOOT_LOG_ALIGNMENT          8
+
+//
+// Record types
+//
+#define BOOT_LOG_TYPE_TEXT          0   // Formatted message, CHAR8 Text[TextLength]
+#define BOOT_LOG_TYPE_BINARY        1   // BOOT_LOG_BINARY, formatted when the log is read
+#define BOOT_LOG_TYPE_MODULE        2   // BOOT_LOG_MODULE, names Module for later binary records
+
+#define BOOT_LOG_MAX_ARGUMENTS      16
+
+#pragma pack(1)
+
+typedef struct {
+    //
+    // Size of the record including this header, a multiple of
+    // BOOT_LOG_ALIGNMENT. Zero marks the end of the used space before
+    // the log wraps back to offset 0.
+    //
+    UINT16  Length;
+    UINT16  TextLength;     // Bytes of payload following this header
+    UINT8   Type;           // BOOT_LOG_TYPE_*
+    UINT8   Reserved;
+    UINT16  Module;         // Module index within Boot, binary and module records
+    UINT32  ErrorLevel;
+    UINT32  Boot;           // BOOT_LOG_HEADER.BootCount of the writer
+    UINT32  Sequence;
+    UINT64  Timestamp;      // Generic timer count
+    UINT32  Reserved2;
+    // CHAR8 Text[TextLength], not NUL terminated
+} BOOT_LOG_RECORD;
+
+//
+// A DEBUG() call that was logged without formatting. Arguments is laid
+// out as a BASE_LIST, one UINT64 per argument, so the message can be
+// printed with AsciiBSPrint() while the module that logged it is still
+// loaded. String, GUID and time arguments are copied behind Arguments and
+// their slot holds the address of the copy inside the log.
+//
+typedef struct {
+    UINT64  Format;         // Address of the format string in the module image
+    UINT32  ArgumentCount;
+    UINT32  Reserved;
+    // UINT64 Arguments[ArgumentCount];
+    // UINT8  Data[];
+} BOOT_LOG_BINARY;
+
+//
+// Written once per boot by each module before its first binary record,
+// and again whenever the previous one has been overwritten. Anchor is the
+// run time address of gEfiCallerIdGuid, which lets a host tool relocate
+// the module's debug image and look up format strings.
+//
+typedef struct {
+    GUID    FileGuid;
+    UINT64  Anchor;
+    // CHAR8 BaseName[], NUL terminated
+} BOOT_LOG_MODULE;
+
+typedef struct {
+    UINT32  Signature;
+    UINT32  Version;
+    UINT32  HeaderSize;
+    UINT32  DataSize;       // Bytes of record space following the header
+    UINT64  TimerFrequency; // Ticks per second of the record timestamps
+    UINT32  BootCount;      // Incremented by every boot that finds the log intact
+    UINT32  Sequence;       // Sequence number of the next record
+    UINT32  First;          // Offset of the oldest record
+    UINT32  Next;           // Offset the next record is written at
+    UINT32  Used;           // Non-zero when First..Next holds records
+    UINT32  ModuleCount;    // Module indices handed out during this boot
+    UINT64  Base;           // Address of this header, to resolve pointers into the log
+    UINT64  LevelTable;     // BOOT_LOG_LEVEL_TABLE of this boot, 0 if none
+    UINT32  LevelGeneration;// Bumped whenever LevelTable changes, 0 if none
+    UINT32  Reserved;
+} BOOT_LOG_HEADER;
+
+//
+// Per-module DEBUG() levels. BootLogDxe builds the table from the
+// DebugLevels variable, or PcdDebugModuleLevels while the variable does not
+// exist, a list of Name=Level pairs such as "SdMmcDxe=0x80000046
+// *=0x80000000". The variable is not persistent, BootLogDxe rebuilds the
+// table when it changes. The debug library of every module looks up its base
+// name once per generation.
+//
+#define BOOT_LOG_LEVEL_VARIABLE_GUID \
+    { 0x6d952a2a, 0x5c27, 0x44e6, { 0x85, 0x86, 0x31, 0xe7, 0x08, 0xe2, 0xfc, 0x60 } }
+
+#define BOOT_LOG_LEVEL_VARIABLE     L"DebugLevels"
+#define BOOT_LOG_LEVEL_NAME_LENGTH  32
+#define BOOT_LOG_LEVEL_MAX_ENTRIES  64
+
+typedef struct {
+    CHAR8   Name[BOOT_LOG_LEVEL_NAME_LENGTH];   // Module base name, "*" for all others
+    UINT32  ErrorLevel;
+    UINT32  Reserved;
+} BOOT_LOG_LEVEL_ENTRY;
+
+typedef struct {
+    UINT32  Count;
+    UINT32  Reserved;
+    // BOOT_LOG_LEVEL_ENTRY Entries[Count];
+} BOOT_LOG_LEVEL_TABLE;
+
+#pragma pack()
+
+#define BOOT_LOG_DATA(Header) \
+    ((UINT8 *) (Header) + (Header)->HeaderSize)
+
+#define BOOT_LOG_RECORD_AT(Header, Offset) \
+    ((BOOT_LOG_RECORD *) (BOOT_LOG_DATA(Header) + (Offset)))
+
+//
+// Offset of the record following the one at Offset, taking the wrap
+// marker and the end of the record space into account.
+//
+#define BOOT_LOG_NEXT_OFFSET(Header, Offset) \
+    ((BOOT_LOG_RECORD_AT(Header, Offset)->Length == 0 || \
+      (Offset) + BOOT_LOG_RECORD_AT(Header, Offset)->Length + sizeof(BOOT_LOG_RECORD) > (Header)->DataSize) ? \
+        0 : (Offset) + BOOT_LOG_RECORD_AT(Header, Offset)->Length)
+
+extern EFI_GUID gNintendoSwitchBootLogTableGuid;
+extern EFI_GUID gNintendoSwitchDebugLevelsVariableGuid;
+
+#endif
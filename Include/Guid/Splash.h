@@ -0,0 +1,41 @@
+#ifndef __SPLASH_GUID_H__
+#define __SPLASH_GUID_H__
+
+//
+// FV file holding the boot splash as a raw section, made from an image by
+// Tools/SplashConvert.py. The pixels are already in the framebuffer's
+// BGRA layout, rotated and placed on full scanout lines, so showing it is
+// one copy of LineCount lines starting at FirstLine.
+//
+#define SPLASH_FILE_GUID \
+    { 0xf309ff45, 0xe6d1, 0x4697, { 0xb2, 0x03, 0x1c, 0xf4, 0xff, 0x2b, 0x22, 0xa7 } }
+
+#define SPLASH_SIGNATURE            SIGNATURE_32('s', 'p', 'l', 's')
+#define SPLASH_VERSION              1
+
+#define SPLASH_FLAG_LZ4             BIT0    // Pixels are one LZ4 block
+
+#pragma pack(1)
+
+typedef struct {
+    UINT32  Signature;
+    UINT32  Version;
+    //
+    // Scanout geometry the splash was converted for, in pixels
+    //
+    UINT32  ScreenWidth;
+    UINT32  ScreenHeight;
+    UINT32  FirstLine;
+    UINT32  LineCount;
+    UINT32  Flags;
+    //
+    // Bytes of pixel data following this header
+    //
+    UINT32  DataSize;
+} SPLASH_HEADER;
+
+#pragma pack()
+
+extern EFI_GUID gNintendoSwitchSplashFileGuid;
+
+#endif
@@ -49,6 +49,15 @@
 #define DC_X_WINBUF_XD_ADDR_V_OFFSET 0x808
 #define DC_X_WINBUF_XD_SURFACE_KIND 0x80B
 
+/*! DC_CMD_STATE_CONTROL bits. */
+#define GENERAL_ACT_REQ (1 << 0)
+#define WIN_A_ACT_REQ (1 << 1)
+#define GENERAL_UPDATE (1 << 8)
+#define WIN_A_UPDATE (1 << 9)
+
+/*! DC_CMD_DISPLAY_WINDOW_HEADER bits. */
+#define WINDOW_A_SELECT (1 << 4)
+
 /*! Display serial interface registers. */
 #define _DSIREG(reg) ((reg) * 4)
 #define DSI_DSI_RD_DATA 0x9
@@ -295,6 +295,8 @@ enum {
 #define PINMUX_AUX_SDMMC3_DAT2 0x2C
 #define PINMUX_AUX_SDMMC3_DAT3 0x30
 #define PINMUX_AUX_DMIC3_CLK   0xB4
+#define PINMUX_AUX_UARTX_TX(x) (0xE4 + 0x10 * (x))
+#define PINMUX_AUX_UARTX_RX(x) (0xE8 + 0x10 * (x))
 #define PINMUX_AUX_UART2_TX    0xF4
 #define PINMUX_AUX_UART3_TX    0x104
 #define PINMUX_AUX_WIFI_EN     0x1B4
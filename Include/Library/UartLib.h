@@ -0,0 +1,75 @@
+#ifndef _UART_LIB_H_
+#define _UART_LIB_H_
+
+/*! UART controllers, same order as the clock table in ClockLib. */
+#define UART_A 0
+#define UART_B 1
+#define UART_C 2
+#define UART_D 3
+
+/*! 16550 compatible registers, 4 byte stride. */
+#define UART_THR_DLAB 0x00
+#define UART_IER_DLAB 0x04
+#define UART_IIR_FCR  0x08
+#define UART_LCR      0x0C
+#define UART_MCR      0x10
+#define UART_LSR      0x14
+#define UART_MSR      0x18
+#define UART_SPR      0x1C
+
+#define UART_FCR_EN_FIFO BIT0
+#define UART_FCR_RX_CLR  BIT1
+#define UART_FCR_TX_CLR  BIT2
+
+#define UART_LCR_WORD_LENGTH_8 0x3
+#define UART_LCR_DLAB          BIT7
+
+#define UART_LSR_RDR           BIT0
+#define UART_LSR_THRE          BIT5 // TX FIFO empty
+#define UART_LSR_TMTY          BIT6 // TX FIFO and shifter empty
+#define UART_LSR_TX_FIFO_FULL  BIT8 // Tegra specific
+#define UART_LSR_RX_FIFO_EMPTY BIT9 // Tegra specific
+
+#define UART_FIFO_DEPTH 32
+
+/*! The UART clock is PLLP through a 7.1 divider, oversampled 16 times. */
+#define UART_PLLP_RATE       408000000
+#define UART_SRC_CLK_DIV_EN  BIT24
+#define UART_MAX_BAUD_RATE   (UART_PLLP_RATE / 16)
+
+RETURN_STATUS
+UartInitialize
+(
+	IN     UINT32 Index,
+	IN OUT UINT64 *BaudRate
+);
+
+UINTN
+UartWrite
+(
+	IN UINT32       Index,
+	IN CONST UINT8  *Buffer,
+	IN UINTN        NumberOfBytes
+);
+
+UINTN
+UartRead
+(
+	IN  UINT32  Index,
+	OUT UINT8   *Buffer,
+	IN  UINTN   NumberOfBytes
+);
+
+BOOLEAN
+UartPoll
+(
+	IN UINT32 Index
+);
+
+VOID
+UartWaitIdle
+(
+	IN UINT32 Index
+);
+
+#endif
@@ -23,7 +23,44 @@ typedef struct _cfg_op_t
 	u32 val;
 } cfg_op_t;
 
+/*
+* Register program: a queue of masked register updates. Updates to the same
+* register are merged until the next fence or delay, so each register is
+* written once per batch, in the order it was first touched.
+*/
+typedef struct _reg_op_t
+{
+	u32 *reg;   // NULL for a fence or delay.
+	u32 clear;  // ~0 writes set as is, without reading the register.
+	u32 set;    // Delay in us for a delay.
+} reg_op_t;
+
+typedef struct _reg_trace_t
+{
+	u32 *reg;
+	u32 val;
+} reg_trace_t;
+
+typedef struct _reg_prog_t
+{
+	reg_op_t *ops;
+	u32 max_ops;
+	u32 num_ops;
+	u32 batch;  // First op after the last fence.
+	reg_trace_t *trace;
+	u32 max_trace;
+	u32 num_trace;
+} reg_prog_t;
+
 void exec_cfg(u32 *base, const cfg_op_t *ops, u32 num_ops);
+void reg_prog_init(reg_prog_t *prog, reg_op_t *ops, u32 max_ops);
+void reg_prog_set_trace(reg_prog_t *prog, reg_trace_t *trace, u32 max_trace);
+void reg_prog_update(reg_prog_t *prog, u32 *reg, u32 clear, u32 set);
+void reg_prog_write(reg_prog_t *prog, u32 *reg, u32 val);
+void reg_prog_cfg(reg_prog_t *prog, u32 *base, const cfg_op_t *ops, u32 num_ops);
+void reg_prog_fence(reg_prog_t *prog);
+void reg_prog_delay(reg_prog_t *prog, u32 us);
+void reg_prog_run(reg_prog_t *prog);
 int running_on_bpmp(void);
 void shutdown_using_pmic(void);
 
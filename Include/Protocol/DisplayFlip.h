@@ -0,0 +1,46 @@
+#ifndef __DISPLAY_FLIP_PROTOCOL_H__
+#define __DISPLAY_FLIP_PROTOCOL_H__
+
+#include <Uefi.h>
+
+/*
+ * Double-buffered drawing for the SimpleFbDxe GOP instance, installed on
+ * the same handle. While enabled, Blt draws into a back buffer that only
+ * reaches the panel on Present(), which points display window A at it
+ * from the next frame on.
+ */
+#define NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL_GUID \
+    { 0xf80c62b9, 0xe44e, 0x4893, { 0x80, 0x0c, 0xcc, 0x2a, 0xdb, 0x2e, 0xfb, 0x64 } }
+
+#define NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL_REVISION  0x00010000
+
+typedef struct _NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL;
+
+/*
+ * Start or stop double buffering. Stopping presents what was drawn and
+ * moves it back into the framebuffer at GOP's FrameBufferBase.
+ */
+typedef EFI_STATUS (EFIAPI* display_flip_enable_t)(
+    IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL    *This,
+    IN BOOLEAN                                  Enable
+);
+
+/*
+ * Show the back buffer. The flip takes effect at the start of the next
+ * frame; with WaitForFlip FALSE this returns right away and only the next
+ * Blt waits for it, if it comes that early.
+ */
+typedef EFI_STATUS (EFIAPI* display_flip_present_t)(
+    IN NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL    *This,
+    IN BOOLEAN                                  WaitForFlip
+);
+
+struct _NINTENDO_SWITCH_DISPLAY_FLIP_PROTOCOL {
+    UINT32 Revision;
+    display_flip_enable_t Enable;
+    display_flip_present_t Present;
+};
+
+extern EFI_GUID gNintendoSwitchDisplayFlipProtocolGuid;
+
+#endif
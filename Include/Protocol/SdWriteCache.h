@@ -0,0 +1,36 @@
+#ifndef __SD_WRITE_CACHE_PROTOCOL_H__
+#define __SD_WRITE_CACHE_PROTOCOL_H__
+
+#include <Uefi.h>
+
+/*
+ * Installed on the SD card's Block I/O handle while SdMmcDxe coalesces
+ * writes. WriteBlocks may return before the data reaches the card, this
+ * tells callers how much data that can be and for how long.
+ */
+#define NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL_GUID \
+    { 0xf83674e1, 0x98cf, 0x4e40, { 0x8f, 0x11, 0x96, 0x3d, 0xc8, 0xce, 0xb2, 0x80 } }
+
+#define NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL_REVISION  0x00010000
+
+typedef struct _NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL;
+
+/*
+ * Return the largest amount of acknowledged data, in bytes, that may not
+ * be on the card yet. Pending data is written out at the latest after
+ * FlushIntervalMs, on FlushBlocks and at ExitBootServices.
+ */
+typedef EFI_STATUS (EFIAPI* sd_write_cache_get_pending_bound_t)(
+    IN NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL  *This,
+    OUT UINTN                                   *PendingBytes,
+    OUT UINT32                                  *FlushIntervalMs OPTIONAL
+);
+
+struct _NINTENDO_SWITCH_SD_WRITE_CACHE_PROTOCOL {
+    UINT32 Revision;
+    sd_write_cache_get_pending_bound_t GetPendingBound;
+};
+
+extern EFI_GUID gNintendoSwitchSdWriteCacheProtocolGuid;
+
+#endif
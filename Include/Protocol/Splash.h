@@ -0,0 +1,29 @@
+#ifndef __SPLASH_PROTOCOL_H__
+#define __SPLASH_PROTOCOL_H__
+
+#include <Uefi.h>
+
+/*
+ * Installed by SimpleFbDxe on its GOP handle when the firmware volume
+ * carries a splash (Guid/Splash.h).
+ */
+#define NINTENDO_SWITCH_SPLASH_PROTOCOL_GUID \
+    { 0x480bdf50, 0x117f, 0x4251, { 0xa2, 0x26, 0x9e, 0x83, 0xc6, 0x1b, 0x63, 0x85 } }
+
+#define NINTENDO_SWITCH_SPLASH_PROTOCOL_REVISION    0x00010000
+
+typedef struct _NINTENDO_SWITCH_SPLASH_PROTOCOL NINTENDO_SWITCH_SPLASH_PROTOCOL;
+
+/* Put the splash back on screen, whatever GOP mode is set */
+typedef EFI_STATUS (EFIAPI* splash_show_t)(
+    IN NINTENDO_SWITCH_SPLASH_PROTOCOL  *This
+);
+
+struct _NINTENDO_SWITCH_SPLASH_PROTOCOL {
+    UINT32 Revision;
+    splash_show_t Show;
+};
+
+extern EFI_GUID gNintendoSwitchSplashProtocolGuid;
+
+#endif
@@ -20,6 +20,14 @@ typedef void (EFIAPI *rst_periph_t)(UINT64 PeriphId, int Delay);
 typedef enum clock_osc_freq (EFIAPI *get_osc_freq_t)(VOID);
 typedef unsigned long (EFIAPI *clk_start_pll_t)(enum clock_id clkid, u32 divm, 
     u32 divn, u32 divp, u32 cpcon, u32 lfcon);
+// M/N/P for the highest PLL output not above Rate, returns 0 if none fits
+typedef unsigned long (EFIAPI *clk_solve_pll_t)(enum clock_id clkid,
+    unsigned long rate, u32 *divm, u32 *divn, u32 *divp);
+// Hold a group of peripherals in reset with their clocks enabled
+typedef void (EFIAPI *periph_hold_t)(CONST UINT64 *PeriphIds, UINTN Count);
+// Take a group out of reset, waiting Delay us once for all of them
+typedef void (EFIAPI *periph_release_t)(CONST UINT64 *PeriphIds, UINTN Count,
+    int Delay);
 
 struct _TEGRA210_UBOOT_CLOCK_MANAGEMENT_PROTOCOL {
     clk_get_rate_t GetRate;
@@ -31,6 +39,9 @@ struct _TEGRA210_UBOOT_CLOCK_MANAGEMENT_PROTOCOL {
     rst_periph_t ResetPeriph;
     get_osc_freq_t GetOscFreq;
     clk_start_pll_t StartPll;
+    periph_hold_t HoldPeriphs;
+    periph_release_t ReleasePeriphs;
+    clk_solve_pll_t SolvePll;
 };
 
 extern EFI_GUID gTegraUBootClockManagementProtocolGuid;
@@ -131,6 +131,52 @@ void reset_periph(enum periph_id periph_id, int us_delay);
  */
 void reset_set_enable(enum periph_id periph_id, int enable);
 
+/**
+ * Add a peripheral to a set of per-bank masks.
+ *
+ * @param mask		PERIPH_BANK_COUNT masks, one per bank
+ * @param periph_id	peripheral to add
+ */
+void periph_mask_add(UINT32 *mask, enum periph_id periph_id);
+
+/**
+ * Enable or disable the clocks of every peripheral in a set of bank masks,
+ * with at most one write per bank. Other clocks are left alone.
+ *
+ * @param mask		PERIPH_BANK_COUNT masks, one per bank
+ * @param enable	1 to enable, 0 to disable
+ */
+void clock_set_enable_mask(const UINT32 *mask, int enable);
+
+/**
+ * Put every peripheral in a set of bank masks into or out of reset, with at
+ * most one write per bank. Other peripherals are left alone.
+ *
+ * @param mask		PERIPH_BANK_COUNT masks, one per bank
+ * @param enable	1 to put into reset, 0 to take out of reset
+ */
+void reset_set_enable_mask(const UINT32 *mask, int enable);
+
+/**
+ * Hold a group of peripherals in reset and enable their clocks. Each bank's
+ * reset and clock enable registers are written at most once for the group.
+ *
+ * @param periph_ids	peripherals to start
+ * @param count		number of entries in periph_ids
+ */
+void periph_hold_set(const UINT64 *periph_ids, int count);
+
+/**
+ * Take a group of peripherals out of reset. The delay is applied once for
+ * the whole group before and after the reset bits are cleared, rather than
+ * once per peripheral as with reset_periph().
+ *
+ * @param periph_ids	peripherals to release
+ * @param count		number of entries in periph_ids
+ * @param us_delay	time to delay in microseconds
+ */
+void periph_release_set(const UINT64 *periph_ids, int count, int us_delay);
+
 
 /* CLK_RST_CONTROLLER_RST_CPU_CMPLX_SET/CLR_0 */
 enum crc_reset_id {
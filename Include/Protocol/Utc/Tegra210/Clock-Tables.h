@@ -558,6 +558,19 @@ enum periphc_internal_id {
 /* Mask value for a clock (within PERIPH_REG(id)) */
 #define PERIPH_MASK(id) (1 << ((id) & 0x1f))
 
+/* Clock enable and reset banks, for masks covering several peripherals */
+enum periph_bank {
+	PERIPH_BANK_L,
+	PERIPH_BANK_H,
+	PERIPH_BANK_U,
+	PERIPH_BANK_V,
+	PERIPH_BANK_W,
+	PERIPH_BANK_X,
+	PERIPH_BANK_Y,
+
+	PERIPH_BANK_COUNT,
+};
+
 /* return 1 if a PLL ID is in range */
 #define clock_id_is_pll(id) ((id) >= CLOCK_ID_FIRST && (id) < CLOCK_ID_COUNT)
 
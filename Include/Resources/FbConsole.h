@@ -0,0 +1,111 @@
+#ifndef _FB_CONSOLE_H_
+#define _FB_CONSOLE_H_
+
+#include <Foundation/Types.h>
+#include <Device/T210.h>
+#include <Library/DisplayInitLib.h>
+
+// Bytes per framebuffer line. The line stride equals PcdMipiFrameBufferWidth.
+#define FBCON_ROW_BYTES \
+	(FixedPcdGet32(PcdMipiFrameBufferWidth) * (FixedPcdGet32(PcdMipiFrameBufferPixelBpp) / 8))
+
+/*
+ * Shared state of the hardware-panned console. The console scrolls by moving
+ * window A over a framebuffer of PcdMipiFrameBufferVirtualHeight lines, and
+ * this block sits in the line right after it, inside the display carveout.
+ * Every module linking FrameBufferSerialPortLib, and SimpleFbDxe, therefore
+ * agree on where the visible screen currently starts.
+ */
+#define FBCON_PAN_SIGNATURE			SIGNATURE_32('f', 'b', 'p', 'n')
+
+// The display belongs to GOP now, the window must stay at the framebuffer base.
+#define FBCON_PAN_FLAG_RELEASED		BIT0
+
+typedef struct {
+	UINT32 Signature;
+	UINT32 Flags;
+	volatile UINT32 PanRow;		// First framebuffer line scanned out by window A
+	UINT32 Reserved;
+} FBCON_PAN_CONTROL;
+
+#define FBCON_PAN_CONTROL_ADDRESS \
+	(FixedPcdGet32(PcdMipiFrameBufferAddress) + \
+	 FixedPcdGet32(PcdMipiFrameBufferVirtualHeight) * FBCON_ROW_BYTES)
+
+// A window of Height lines starting at PanRow stays inside the virtual framebuffer.
+#define FBCON_PAN_FITS(PanRow, Height) \
+	((UINTN)(PanRow) + (Height) <= FixedPcdGet32(PcdMipiFrameBufferVirtualHeight))
+
+/*
+ * Character grid of the console, right after the pan state. Every module
+ * linking FrameBufferSerialPortLib writes its text into this one grid and
+ * continues at the cursor the previous module left. Cells are only drawn
+ * when their content changed, tracked by a per-row dirty bitmap. The grid
+ * of the previous boot is dropped in ArmPlatformInitialize.
+ *
+ * The header is followed by UINT64 Dirty[Rows][FBCON_GRID_DIRTY_WORDS] and
+ * UINT16 Cells[Rows][Columns]. A cell holds the character in its low byte
+ * and the attribute in its high byte.
+ */
+#define FBCON_GRID_SIGNATURE		SIGNATURE_32('f', 'b', 'g', 'd')
+
+// The cursor was placed by an escape sequence, leading blanks are kept.
+#define FBCON_GRID_FLAG_ADDRESSED	BIT0
+
+// Attribute: foreground palette index in the low nibble, background in the high one.
+#define FBCON_ATTR(Fg, Bg)			((UINT8)(((Bg) << 4) | (Fg)))
+#define FBCON_ATTR_FG(Attr)			((Attr) & 0xf)
+#define FBCON_ATTR_BG(Attr)			(((Attr) >> 4) & 0xf)
+#define FBCON_ATTR_DEFAULT			FBCON_ATTR(15, 0)
+
+#define FBCON_CELL(Char, Attr)		((UINT16)(((Attr) << 8) | (UINT8)(Char)))
+#define FBCON_CELL_CHAR(Cell)		((char)((Cell) & 0xff))
+#define FBCON_CELL_ATTR(Cell)		((UINT8)((Cell) >> 8))
+
+#define FBCON_GRID_DIRTY_WORDS(Columns)	(((Columns) + 63) / 64)
+
+typedef struct {
+	UINT32 Signature;
+	UINT16 Columns;
+	UINT16 Rows;
+	UINT32 Flags;
+	INT32 CursorX;
+	INT32 CursorY;
+	INT32 SavedX;
+	INT32 SavedY;
+	UINT8 Attribute;			// Attribute of new text
+	UINT8 SavedAttribute;
+	UINT16 Reserved;
+} FBCON_GRID;
+
+#define FBCON_GRID_ADDRESS \
+	(FBCON_PAN_CONTROL_ADDRESS + sizeof(FBCON_PAN_CONTROL))
+
+/*
+ * Log ring for deferred console rendering (PcdFrameBufferConsoleAsync).
+ * There is one ring for all of DXE: SimpleFbDxe allocates it, publishes it
+ * as the gNintendoSwitchConsoleRingGuid configuration table and drains it
+ * from a timer. Every module linking DxeFrameBufferSerialPortLib queues into
+ * it once the table is there and writes synchronously before that, so the
+ * output of all modules stays in order.
+ */
+typedef struct {
+	UINT8 *Buffer;				// NULL while output is synchronous
+	UINT32 Mask;				// Ring size - 1, size is a power of two
+	volatile UINT32 Reserve;	// Bytes claimed by writers
+	volatile UINT32 Commit;		// Bytes completely written
+	volatile UINT32 Tail;		// Bytes handed to the renderer
+	volatile UINT32 Dropped;	// Bytes lost because the ring was full
+	volatile UINT32 Draining;
+} FBCON_RING;
+
+/*! Point window A at a new start address, latched by the DC on the next frame. */
+#define FBCON_PAN_WINDOW(Address) \
+	do { \
+		DISPLAY_A(_DIREG(DC_CMD_DISPLAY_WINDOW_HEADER)) = WINDOW_A_SELECT; \
+		DISPLAY_A(_DIREG(DC_X_WINBUF_XD_START_ADDR)) = (UINT32)(UINTN)(Address); \
+		DISPLAY_A(_DIREG(DC_CMD_STATE_CONTROL)) = GENERAL_UPDATE | WIN_A_UPDATE; \
+		DISPLAY_A(_DIREG(DC_CMD_STATE_CONTROL)) = GENERAL_ACT_REQ | WIN_A_ACT_REQ; \
+	} while (0)
+
+#endif
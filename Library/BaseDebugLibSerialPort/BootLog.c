@@ -0,0 +1,528 @@
+/** @file
+  Persistent boot log sink for the serial port debug library.
+
+  Every message that DebugPrint() or DebugAssert() send to the serial port is
+  also appended to the boot log carveout described by Guid/BootLog.h. The
+  header is set up once per boot by the platform library in SEC; until then
+  a log left over from the previous boot is simply extended.
+
+  Modules built with PcdDebugBinaryLog skip formatting altogether. Their
+  messages are stored as the format string address plus the raw argument
+  words and are only turned into text when the log is read.
+
+**/
+
+#include <Base.h>
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PcdLib.h>
+#include <Library/ArmGenericTimerCounterLib.h>
+#include <Guid/BootLog.h>
+
+#include "BootLog.h"
+
+//
+// Bytes available for copies of string, GUID and time arguments
+//
+#define BOOT_LOG_MAX_DATA       192
+#define BOOT_LOG_MAX_STRING     96
+#define BOOT_LOG_NO_DATA        MAX_UINT32
+
+//
+// Module record of this module for the current boot
+//
+STATIC UINT32  mBootLogModuleBoot     = MAX_UINT32;
+STATIC UINT32  mBootLogModuleSequence = 0;
+STATIC UINT16  mBootLogModule         = 0;
+
+//
+// Level of this module from the level table, resolved once per generation
+//
+STATIC UINT32  mBootLogLevelGeneration = 0;
+STATIC BOOLEAN mBootLogLevelFound      = FALSE;
+STATIC UINT32  mBootLogLevel           = 0;
+
+/**
+  Return the boot log if it is enabled and has been set up.
+
+  @return The boot log header or NULL.
+
+**/
+STATIC
+BOOT_LOG_HEADER *
+BootLogGet (
+  VOID
+  )
+{
+  BOOT_LOG_HEADER  *Log;
+
+  if (!FeaturePcdGet (PcdBootLogEnable)) {
+    return NULL;
+  }
+
+  Log = (BOOT_LOG_HEADER *)(UINTN)FixedPcdGet64 (PcdBootLogBase);
+  if (Log->Signature != BOOT_LOG_SIGNATURE || Log->Version != BOOT_LOG_VERSION) {
+    return NULL;
+  }
+
+  return Log;
+}
+
+/**
+  Discard the oldest record of the log.
+
+  @param  Log  The boot log header.
+
+**/
+STATIC
+VOID
+BootLogDropFirst (
+  IN OUT BOOT_LOG_HEADER  *Log
+  )
+{
+  Log->First = BOOT_LOG_NEXT_OFFSET (Log, Log->First);
+  if (Log->First == Log->Next) {
+    Log->Used = 0;
+  }
+}
+
+/**
+  Make room for a record and fill in its header. Must be called with
+  interrupts masked.
+
+  @param  Log         The boot log header.
+  @param  Type        BOOT_LOG_TYPE_* of the record.
+  @param  ErrorLevel  The error level of the message.
+  @param  Length      The number of payload bytes, at most half the log.
+
+  @return The new record, its payload follows the header.
+
+**/
+STATIC
+BOOT_LOG_RECORD *
+BootLogAppend (
+  IN OUT BOOT_LOG_HEADER  *Log,
+  IN     UINT8            Type,
+  IN     UINTN            ErrorLevel,
+  IN     UINTN            Length
+  )
+{
+  BOOT_LOG_RECORD  *Record;
+  UINT32           Size;
+
+  Size = ALIGN_VALUE (sizeof (BOOT_LOG_RECORD) + (UINT32)Length, BOOT_LOG_ALIGNMENT);
+
+  if (Log->Next + Size > Log->DataSize) {
+    //
+    // Records between Next and the end of the space are lost with the wrap.
+    //
+    while (Log->Used && Log->First >= Log->Next) {
+      BootLogDropFirst (Log);
+    }
+    if (Log->Next + sizeof (BOOT_LOG_RECORD) <= Log->DataSize) {
+      BOOT_LOG_RECORD_AT (Log, Log->Next)->Length = 0;
+    }
+    Log->Next = 0;
+  }
+
+  while (Log->Used && Log->First >= Log->Next && Log->First < Log->Next + Size) {
+    BootLogDropFirst (Log);
+  }
+
+  if (!Log->Used) {
+    Log->First = Log->Next;
+  }
+
+  Record = BOOT_LOG_RECORD_AT (Log, Log->Next);
+  Record->Length     = (UINT16)Size;
+  Record->TextLength = (UINT16)Length;
+  Record->Type       = Type;
+  Record->Reserved   = 0;
+  Record->Module     = 0;
+  Record->ErrorLevel = (UINT32)ErrorLevel;
+  Record->Boot       = Log->BootCount;
+  Record->Sequence   = Log->Sequence++;
+  Record->Timestamp  = ArmGenericTimerGetSystemCount ();
+  Record->Reserved2  = 0;
+
+  Log->Next += Size;
+  if (Log->Next + sizeof (BOOT_LOG_RECORD) > Log->DataSize) {
+    Log->Next = 0;
+  }
+  Log->Used = 1;
+
+  return Record;
+}
+
+/**
+  Append a message to the persistent boot log.
+
+  The cost is one copy of the already formatted text. Interrupts are masked
+  while the record is placed, so messages from a higher TPL cannot interleave.
+
+  @param  ErrorLevel  The error level of the message.
+  @param  Text        The message text, not necessarily NUL terminated.
+  @param  Length      The number of characters in Text.
+
+**/
+VOID
+BootLogWrite (
+  IN UINTN        ErrorLevel,
+  IN CONST CHAR8  *Text,
+  IN UINTN        Length
+  )
+{
+  BOOT_LOG_HEADER  *Log;
+  BOOT_LOG_RECORD  *Record;
+  BOOLEAN          InterruptState;
+
+  Log = BootLogGet ();
+  if (Log == NULL) {
+    return;
+  }
+
+  if (Length > Log->DataSize / 2 - sizeof (BOOT_LOG_RECORD)) {
+    Length = Log->DataSize / 2 - sizeof (BOOT_LOG_RECORD);
+  }
+
+  InterruptState = SaveAndDisableInterrupts ();
+
+  Record = BootLogAppend (Log, BOOT_LOG_TYPE_TEXT, ErrorLevel, Length);
+  CopyMem (Record + 1, Text, Length);
+
+  SetInterruptState (InterruptState);
+}
+
+/**
+  Write the module record of the calling module unless the one written
+  earlier in this boot is still in the log. Must be called with interrupts
+  masked.
+
+  @param  Log  The boot log header.
+
+**/
+STATIC
+VOID
+BootLogRegisterModule (
+  IN OUT BOOT_LOG_HEADER  *Log
+  )
+{
+  BOOT_LOG_RECORD  *Record;
+  BOOT_LOG_MODULE  *Module;
+  UINTN            NameLength;
+
+  if (mBootLogModuleBoot == Log->BootCount) {
+    //
+    // Sequence numbers only grow, so the record is still there as long as
+    // the oldest record is not younger than it.
+    //
+    if (Log->Used &&
+        (INT32)(BOOT_LOG_RECORD_AT (Log, Log->First)->Sequence - mBootLogModuleSequence) <= 0) {
+      return;
+    }
+  } else {
+    mBootLogModuleBoot = Log->BootCount;
+    mBootLogModule     = (UINT16)Log->ModuleCount++;
+  }
+
+  NameLength = AsciiStrLen (gEfiCallerBaseName) + 1;
+  Record = BootLogAppend (Log, BOOT_LOG_TYPE_MODULE, 0, sizeof (BOOT_LOG_MODULE) + NameLength);
+  Record->Module = mBootLogModule;
+
+  Module = (BOOT_LOG_MODULE *)(Record + 1);
+  CopyGuid (&Module->FileGuid, &gEfiCallerIdGuid);
+  Module->Anchor = (UINT64)(UINTN)&gEfiCallerIdGuid;
+  CopyMem (Module + 1, gEfiCallerBaseName, NameLength);
+
+  mBootLogModuleSequence = Record->Sequence;
+}
+
+/**
+  Copy the data behind a pointer argument into the argument data area.
+
+  @param  Data        The argument data area.
+  @param  DataLength  On input the bytes used in Data, updated on return.
+  @param  Source      The data to copy.
+  @param  Size        The number of bytes to copy from Source.
+  @param  Terminator  The number of zero bytes to append.
+
+  @return The offset of the copy in Data, or BOOT_LOG_NO_DATA if it did
+          not fit.
+
+**/
+STATIC
+UINT32
+BootLogStash (
+  IN OUT UINT8        *Data,
+  IN OUT UINT32       *DataLength,
+  IN     CONST VOID   *Source,
+  IN     UINTN        Size,
+  IN     UINTN        Terminator
+  )
+{
+  UINT32  Offset;
+
+  Offset = *DataLength;
+  if (Offset + Size + Terminator > BOOT_LOG_MAX_DATA) {
+    return BOOT_LOG_NO_DATA;
+  }
+
+  CopyMem (Data + Offset, Source, Size);
+  ZeroMem (Data + Offset + Size, Terminator);
+  *DataLength = ALIGN_VALUE (Offset + (UINT32)(Size + Terminator), BOOT_LOG_ALIGNMENT);
+
+  return Offset;
+}
+
+/**
+  Convert a variable argument list to BASE_LIST words, following the rules
+  PrintLib uses to consume arguments for each conversion.
+
+  @param  Format      The format string of the message.
+  @param  Marker      The arguments of the message.
+  @param  Arguments   Receives one UINT64 per argument.
+  @param  DataOffset  Receives the offset in Data of each copied argument,
+                      BOOT_LOG_NO_DATA for arguments passed by value.
+  @param  Data        Receives copies of string, GUID and time arguments.
+  @param  DataLength  Receives the number of bytes used in Data.
+
+  @return The number of arguments.
+
+**/
+STATIC
+UINT32
+BootLogCollectArguments (
+  IN  CONST CHAR8  *Format,
+  IN  VA_LIST      Marker,
+  OUT UINT64       *Arguments,
+  OUT UINT32       *DataOffset,
+  OUT UINT8        *Data,
+  OUT UINT32       *DataLength
+  )
+{
+  UINT32        Count;
+  BOOLEAN       Long;
+  BOOLEAN       Done;
+  CHAR8         Type;
+  CONST CHAR8   *Ascii;
+  CONST CHAR16  *Unicode;
+  CONST VOID    *Pointer;
+  UINTN         Size;
+
+  Count       = 0;
+  *DataLength = 0;
+
+  while (*Format != '\0' && Count < BOOT_LOG_MAX_ARGUMENTS) {
+    if (*Format++ != '%') {
+      continue;
+    }
+
+    Long = FALSE;
+    for (Done = FALSE; !Done && *Format != '\0' && Count < BOOT_LOG_MAX_ARGUMENTS; ) {
+      Type = *Format++;
+      DataOffset[Count] = BOOT_LOG_NO_DATA;
+
+      switch (Type) {
+      case 'l':
+      case 'L':
+        Long = TRUE;
+        break;
+
+      case '*':
+        Arguments[Count++] = VA_ARG (Marker, UINTN);
+        break;
+
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'x':
+      case 'X':
+        if (Long) {
+          Arguments[Count++] = (UINT64)VA_ARG (Marker, INT64);
+        } else {
+          Arguments[Count++] = (UINT64)(INT64)VA_ARG (Marker, int);
+        }
+        Done = TRUE;
+        break;
+
+      case 'c':
+      case 'p':
+      case 'r':
+        Arguments[Count++] = VA_ARG (Marker, UINTN);
+        Done = TRUE;
+        break;
+
+      case 'a':
+        Ascii = VA_ARG (Marker, CONST CHAR8 *);
+        for (Size = 0; Ascii != NULL && Size < BOOT_LOG_MAX_STRING && Ascii[Size] != '\0'; Size++) {
+        }
+        DataOffset[Count] = (Ascii == NULL) ? BOOT_LOG_NO_DATA : BootLogStash (Data, DataLength, Ascii, Size, sizeof (CHAR8));
+        Arguments[Count++] = 0;
+        Done = TRUE;
+        break;
+
+      case 's':
+      case 'S':
+        Unicode = VA_ARG (Marker, CONST CHAR16 *);
+        for (Size = 0; Unicode != NULL && Size < BOOT_LOG_MAX_STRING / 2 && Unicode[Size] != L'\0'; Size++) {
+        }
+        DataOffset[Count] = (Unicode == NULL) ? BOOT_LOG_NO_DATA : BootLogStash (Data, DataLength, Unicode, Size * sizeof (CHAR16), sizeof (CHAR16));
+        Arguments[Count++] = 0;
+        Done = TRUE;
+        break;
+
+      case 'g':
+      case 't':
+        Pointer = VA_ARG (Marker, CONST VOID *);
+        Size    = (Type == 'g') ? sizeof (GUID) : sizeof (EFI_TIME);
+        DataOffset[Count] = (Pointer == NULL) ? BOOT_LOG_NO_DATA : BootLogStash (Data, DataLength, Pointer, Size, 0);
+        Arguments[Count++] = 0;
+        Done = TRUE;
+        break;
+
+      default:
+        //
+        // Flags, width and precision digits keep going, anything else
+        // (including %%) ends the conversion without taking an argument.
+        //
+        Done = !(Type == '-' || Type == '+' || Type == ' ' || Type == ',' ||
+                 Type == '.' || (Type >= '0' && Type <= '9'));
+        break;
+      }
+    }
+  }
+
+  return Count;
+}
+
+/**
+  Return the DEBUG() level of the calling module.
+
+  The level table is only searched when its generation changes, after that
+  the cost is a compare of the generation number.
+
+  @param  DefaultLevel  The level to use if the table has no entry for
+                        this module.
+
+  @return The error level mask that DebugPrint() should apply.
+
+**/
+UINT32
+BootLogGetModuleLevel (
+  IN UINT32  DefaultLevel
+  )
+{
+  BOOT_LOG_HEADER       *Log;
+  BOOT_LOG_LEVEL_TABLE  *Table;
+  BOOT_LOG_LEVEL_ENTRY  *Entry;
+  UINT32                Index;
+
+  Log = BootLogGet ();
+  if (Log == NULL || Log->LevelGeneration == 0) {
+    return DefaultLevel;
+  }
+
+  if (Log->LevelGeneration != mBootLogLevelGeneration) {
+    Table = (BOOT_LOG_LEVEL_TABLE *)(UINTN)Log->LevelTable;
+    Entry = (BOOT_LOG_LEVEL_ENTRY *)(Table + 1);
+
+    mBootLogLevelFound = FALSE;
+    for (Index = 0; Index < Table->Count; Index++, Entry++) {
+      if (AsciiStrCmp (Entry->Name, gEfiCallerBaseName) == 0) {
+        mBootLogLevel      = Entry->ErrorLevel;
+        mBootLogLevelFound = TRUE;
+        break;
+      }
+      if (AsciiStrCmp (Entry->Name, "*") == 0) {
+        mBootLogLevel      = Entry->ErrorLevel;
+        mBootLogLevelFound = TRUE;
+      }
+    }
+
+    mBootLogLevelGeneration = Log->LevelGeneration;
+  }
+
+  return mBootLogLevelFound ? mBootLogLevel : DefaultLevel;
+}
+
+/**
+  Append a message to the persistent boot log without formatting it.
+
+  Only the format string address and the argument words are stored, so the
+  cost no longer depends on the conversions in the message. The text is
+  produced when the log is read, by BootLogDump while the module is still
+  loaded or offline by Tools/BootLogDecode.py.
+
+  @param  ErrorLevel  The error level of the message.
+  @param  Format      The format string of the message.
+  @param  Marker      The arguments of the message.
+
+  @retval TRUE   The message was logged.
+  @retval FALSE  The boot log is not available, the caller has to format
+                 and print the message itself.
+
+**/
+BOOLEAN
+BootLogWriteBinary (
+  IN UINTN        ErrorLevel,
+  IN CONST CHAR8  *Format,
+  IN VA_LIST      Marker
+  )
+{
+  BOOT_LOG_HEADER  *Log;
+  BOOT_LOG_RECORD  *Record;
+  BOOT_LOG_BINARY  *Binary;
+  UINT64           Arguments[BOOT_LOG_MAX_ARGUMENTS];
+  UINT32           DataOffset[BOOT_LOG_MAX_ARGUMENTS];
+  UINT64           Data[BOOT_LOG_MAX_DATA / sizeof (UINT64)];
+  UINT32           DataLength;
+  UINT32           Count;
+  UINT32           Index;
+  UINT64           *Slots;
+  UINT8            *Copies;
+  BOOLEAN          InterruptState;
+
+  Log = BootLogGet ();
+  if (Log == NULL) {
+    return FALSE;
+  }
+
+  //
+  // Gather everything before masking interrupts, the copy into the log
+  // is then a single CopyMem.
+  //
+  Count = BootLogCollectArguments (Format, Marker, Arguments, DataOffset, (UINT8 *)Data, &DataLength);
+
+  InterruptState = SaveAndDisableInterrupts ();
+
+  BootLogRegisterModule (Log);
+
+  Record = BootLogAppend (
+             Log,
+             BOOT_LOG_TYPE_BINARY,
+             ErrorLevel,
+             sizeof (BOOT_LOG_BINARY) + Count * sizeof (UINT64) + DataLength
+             );
+  Record->Module = mBootLogModule;
+
+  Binary = (BOOT_LOG_BINARY *)(Record + 1);
+  Binary->Format        = (UINT64)(UINTN)Format;
+  Binary->ArgumentCount = Count;
+  Binary->Reserved      = 0;
+
+  Slots  = (UINT64 *)(Binary + 1);
+  Copies = (UINT8 *)(Slots + Count);
+  CopyMem (Copies, Data, DataLength);
+
+  //
+  // Copied arguments point at their copy inside the log
+  //
+  for (Index = 0; Index < Count; Index++) {
+    Slots[Index] = (DataOffset[Index] == BOOT_LOG_NO_DATA) ?
+                   Arguments[Index] : (UINT64)(UINTN)(Copies + DataOffset[Index]);
+  }
+
+  SetInterruptState (InterruptState);
+  return TRUE;
+}
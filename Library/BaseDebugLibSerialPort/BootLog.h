@@ -0,0 +1,28 @@
+/** @file
+  Persistent boot log sink for the serial port debug library.
+
+**/
+
+#ifndef __BOOT_LOG_H__
+#define __BOOT_LOG_H__
+
+VOID
+BootLogWrite (
+  IN UINTN        ErrorLevel,
+  IN CONST CHAR8  *Text,
+  IN UINTN        Length
+  );
+
+UINT32
+BootLogGetModuleLevel (
+  IN UINT32  DefaultLevel
+  );
+
+BOOLEAN
+BootLogWriteBinary (
+  IN UINTN        ErrorLevel,
+  IN CONST CHAR8  *Format,
+  IN VA_LIST      Marker
+  );
+
+#endif
@@ -26,12 +26,20 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/SerialPortLib.h>
 #include <Library/DebugPrintErrorLevelLib.h>
+#include <Library/ArmGenericTimerCounterLib.h>
+
+#include "BootLog.h"
 
 //
 // Define the maximum debug and assert message length that this library supports 
 //
 #define MAX_DEBUG_MESSAGE_LENGTH  0x100
 
+//
+// TRUE when the last message of this module ended a line
+//
+STATIC BOOLEAN  mDebugAtLineStart = TRUE;
+
 /**
   The constructor function initialize the Serial Port Library
 
@@ -47,6 +55,41 @@ BaseDebugLibSerialPortConstructor (
   return SerialPortInitialize ();
 }
 
+/**
+  Print the generic timer count as seconds since reset, as a line prefix.
+
+  @param  Buffer  The buffer that receives the prefix.
+  @param  Size    The size of Buffer in bytes.
+
+  @return The number of characters written to Buffer.
+
+**/
+STATIC
+UINTN
+DebugTimestamp (
+  OUT CHAR8  *Buffer,
+  IN  UINTN  Size
+  )
+{
+  UINT64  Frequency;
+  UINT64  Seconds;
+  UINT64  Remainder;
+
+  Frequency = ArmGenericTimerGetTimerFreq ();
+  if (Frequency == 0) {
+    return 0;
+  }
+
+  Seconds = DivU64x64Remainder (ArmGenericTimerGetSystemCount (), Frequency, &Remainder);
+  return AsciiSPrint (
+           Buffer,
+           Size,
+           "[%5lu.%06lu] ",
+           Seconds,
+           DivU64x64Remainder (MultU64x32 (Remainder, 1000000), Frequency, NULL)
+           );
+}
+
 /**
   Prints a debug message to the debug output device if the specified error level is enabled.
 
@@ -72,6 +115,10 @@ DebugPrint (
 {
   CHAR8    Buffer[MAX_DEBUG_MESSAGE_LENGTH];
   VA_LIST  Marker;
+  UINTN    Length;
+  UINTN    Prefix;
+  UINT32   Level;
+  BOOLEAN  Logged;
 
   //
   // If Format is NULL, then ASSERT().
@@ -79,23 +126,56 @@ DebugPrint (
   ASSERT (Format != NULL);
 
   //
-  // Check driver debug mask value and global mask
+  // Check driver debug mask value and global mask, a per-module level
+  // from the DebugLevels variable replaces the global one
   //
-  if ((ErrorLevel & GetDebugPrintErrorLevel ()) == 0) {
+  Level = GetDebugPrintErrorLevel ();
+  if (FeaturePcdGet (PcdDebugModuleLevelEnable)) {
+    Level = BootLogGetModuleLevel (Level);
+  }
+  if ((ErrorLevel & Level) == 0) {
     return;
   }
 
+  //
+  // Modules built with PcdDebugBinaryLog leave formatting to whoever reads
+  // the boot log. Errors are still printed right away.
+  //
+  if (FeaturePcdGet (PcdDebugBinaryLog) && (ErrorLevel & DEBUG_ERROR) == 0) {
+    VA_START (Marker, Format);
+    Logged = BootLogWriteBinary (ErrorLevel, Format, Marker);
+    VA_END (Marker);
+    if (Logged) {
+      return;
+    }
+  }
+
   //
   // Convert the DEBUG() message to an ASCII String
   //
+  Prefix = 0;
+  if (FeaturePcdGet (PcdDebugPrintTimestamp) && mDebugAtLineStart) {
+    Prefix = DebugTimestamp (Buffer, sizeof (Buffer));
+  }
+
   VA_START (Marker, Format);
-  AsciiVSPrint (Buffer, sizeof (Buffer), Format, Marker);
+  Length = Prefix + AsciiVSPrint (Buffer + Prefix, sizeof (Buffer) - Prefix, Format, Marker);
   VA_END (Marker);
 
+  if (Length > Prefix) {
+    mDebugAtLineStart = (BOOLEAN)(Buffer[Length - 1] == '\n');
+  }
+
+  //
+  // Keep a copy in the persistent boot log, records carry their own
+  // timestamp
+  //
+  BootLogWrite (ErrorLevel, Buffer + Prefix, Length - Prefix);
+
   //
   // Send the print string to a Serial Port 
   //
-  SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+  SerialPortWrite ((UINT8 *)Buffer, Length);
 }
 
 
@@ -129,16 +209,22 @@ DebugAssert (
   )
 {
   CHAR8  Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+  UINTN  Length;
 
   //
   // Generate the ASSERT() message in Ascii format
   //
-  AsciiSPrint (Buffer, sizeof (Buffer), "ASSERT [%a] %a(%d): %a\n", gEfiCallerBaseName, FileName, LineNumber, Description);
+  Length = AsciiSPrint (Buffer, sizeof (Buffer), "ASSERT [%a] %a(%d): %a\n", gEfiCallerBaseName, FileName, LineNumber, Description);
+
+  //
+  // Keep a copy in the persistent boot log
+  //
+  BootLogWrite (DEBUG_ERROR, Buffer, Length);
 
   //
   // Send the print string to the Console Output device
   //
-  SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+  SerialPortWrite ((UINT8 *)Buffer, Length);
 
   //
   // Generate a Breakpoint, DeadLoop, or NOP based on PCD settings
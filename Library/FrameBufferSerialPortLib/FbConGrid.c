@@ -0,0 +1,428 @@
+#include <PiDxe.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PcdLib.h>
+
+#include <Resources/FbConsole.h>
+
+#include "FrameBufferSerialPortLib.h"
+
+/*
+ * Character grid and escape sequence handling. Text only changes cells here;
+ * a cell whose value changed gets its bit set in the dirty bitmap, and
+ * FbConGridRender draws just those cells when the console flushes. Rewriting
+ * a status line in place therefore costs the characters that differ.
+ */
+FBCON_GRID *m_Grid = NULL;
+
+#define FBCON_ANSI_NORMAL		0
+#define FBCON_ANSI_ESCAPE		1
+#define FBCON_ANSI_CSI			2
+
+#define FBCON_ANSI_MAX_PARAMS	8
+
+typedef struct {
+	UINT8 State;
+	BOOLEAN Private;			// '?' sequences, none of them is supported
+	BOOLEAN Bold;
+	UINTN Count;
+	UINT32 Params[FBCON_ANSI_MAX_PARAMS];
+} FBCON_ANSI;
+
+STATIC FBCON_ANSI m_Ansi;
+
+STATIC
+UINT64 *
+FbConGridDirty(UINTN Row)
+{
+	return (UINT64*)(m_Grid + 1) + Row * FBCON_GRID_DIRTY_WORDS(m_Grid->Columns);
+}
+
+STATIC
+UINT16 *
+FbConGridCells(UINTN Row)
+{
+	return (UINT16*)FbConGridDirty(m_Grid->Rows) + Row * m_Grid->Columns;
+}
+
+STATIC
+VOID
+FbConGridBlankRow(UINTN Row)
+{
+	SetMem16(FbConGridCells(Row), m_Grid->Columns * sizeof(UINT16), FBCON_CELL(' ', m_Grid->Attribute));
+	ZeroMem(FbConGridDirty(Row), FBCON_GRID_DIRTY_WORDS(m_Grid->Columns) * sizeof(UINT64));
+}
+
+/*
+ * Continue on the grid of an earlier module, or set up an empty one when
+ * this is the first console instance of the boot. An empty grid is taken to
+ * match the screen as it is, nothing is drawn for it.
+ */
+VOID FbConGridInitialize(UINTN Columns, UINTN Rows)
+{
+	FBCON_GRID *Grid = (FBCON_GRID*)FBCON_GRID_ADDRESS;
+	UINTN Row;
+
+	m_Grid = Grid;
+
+	if (Grid->Signature == FBCON_GRID_SIGNATURE &&
+		Grid->Columns == Columns &&
+		Grid->Rows == Rows &&
+		Grid->CursorX >= 0 && Grid->CursorX < (INT32)Columns &&
+		Grid->CursorY >= 0 && Grid->CursorY < (INT32)Rows)
+	{
+		return;
+	}
+
+	Grid->Signature = 0;
+	Grid->Columns = (UINT16)Columns;
+	Grid->Rows = (UINT16)Rows;
+	Grid->Flags = 0;
+	Grid->CursorX = Grid->CursorY = 0;
+	Grid->SavedX = Grid->SavedY = 0;
+	Grid->Attribute = Grid->SavedAttribute = FBCON_ATTR_DEFAULT;
+	Grid->Reserved = 0;
+
+	for (Row = 0; Row < Rows; Row++) FbConGridBlankRow(Row);
+
+	Grid->Signature = FBCON_GRID_SIGNATURE;
+}
+
+VOID FbConGridSet(UINTN Column, UINTN Row, UINT16 Cell)
+{
+	UINT16 *Cells = FbConGridCells(Row);
+
+	if (Cells[Column] == Cell) return;
+
+	Cells[Column] = Cell;
+	FbConGridDirty(Row)[Column / 64] |= LShiftU64(1, Column % 64);
+}
+
+/*
+ * Draw the cells changed since the last render and clear their bits.
+ */
+VOID FbConGridRender(VOID)
+{
+	UINTN Words = FBCON_GRID_DIRTY_WORDS(m_Grid->Columns);
+	UINTN Row, Word;
+	UINT64 *Dirty;
+	UINT16 *Cells;
+	UINT64 Bits;
+	INTN Bit;
+
+	for (Row = 0; Row < m_Grid->Rows; Row++)
+	{
+		Dirty = FbConGridDirty(Row);
+		Cells = FbConGridCells(Row);
+
+		for (Word = 0; Word < Words; Word++)
+		{
+			Bits = Dirty[Word];
+			if (Bits == 0) continue;
+			Dirty[Word] = 0;
+
+			while (Bits != 0)
+			{
+				Bit = LowBitSet64(Bits);
+				Bits &= Bits - 1;
+				FbConDrawCell(Word * 64 + Bit, Row, Cells[Word * 64 + Bit]);
+			}
+		}
+	}
+}
+
+/*
+ * Rebuild the whole text area from the grid. The background is filled in
+ * one pass, so only cells that are not blank on that background are drawn.
+ */
+VOID FbConGridRedraw(VOID)
+{
+	UINT8 Background = FBCON_ATTR_BG(m_Grid->Attribute);
+	UINTN Row, Column;
+	UINT16 *Cells;
+	UINT16 Cell;
+
+	FbConFillCellRows(0, m_Grid->Rows, m_Grid->Attribute);
+
+	for (Row = 0; Row < m_Grid->Rows; Row++)
+	{
+		Cells = FbConGridCells(Row);
+		ZeroMem(FbConGridDirty(Row), FBCON_GRID_DIRTY_WORDS(m_Grid->Columns) * sizeof(UINT64));
+
+		for (Column = 0; Column < m_Grid->Columns; Column++)
+		{
+			Cell = Cells[Column];
+			if (FBCON_CELL_CHAR(Cell) == ' ' && FBCON_ATTR_BG(FBCON_CELL_ATTR(Cell)) == Background) continue;
+			FbConDrawCell(Column, Row, Cell);
+		}
+	}
+}
+
+/*
+ * Move the grid up with the pixels. Callers render first, so no dirty bits
+ * are pending and the rows brought in are blank both here and on screen.
+ */
+VOID FbConGridScrollUp(UINTN Lines)
+{
+	UINTN Rows = m_Grid->Rows;
+	UINTN Row;
+
+	if (Lines > Rows) Lines = Rows;
+
+	CopyMem(FbConGridCells(0), FbConGridCells(Lines), (Rows - Lines) * m_Grid->Columns * sizeof(UINT16));
+	for (Row = Rows - Lines; Row < Rows; Row++) FbConGridBlankRow(Row);
+}
+
+/*
+ * Blank whole rows [Top, Bottom). The pixels are filled directly, which is
+ * cheaper than drawing every cell.
+ */
+VOID FbConGridEraseRows(UINTN Top, UINTN Bottom)
+{
+	UINTN Row;
+
+	if (Top >= Bottom) return;
+
+	for (Row = Top; Row < Bottom; Row++) FbConGridBlankRow(Row);
+	FbConFillCellRows(Top, Bottom, m_Grid->Attribute);
+}
+
+// Blank cells [First, Last] of a row, cells that are blank already stay clean.
+STATIC
+VOID
+FbConGridEraseCells(UINTN Row, UINTN First, UINTN Last)
+{
+	UINT16 Blank = FBCON_CELL(' ', m_Grid->Attribute);
+
+	if (First == 0 && Last + 1 >= m_Grid->Columns)
+	{
+		FbConGridEraseRows(Row, Row + 1);
+		return;
+	}
+
+	for (; First <= Last; First++) FbConGridSet(First, Row, Blank);
+}
+
+STATIC
+UINT32
+FbConAnsiParam(UINTN Index, UINT32 Default)
+{
+	if (Index >= m_Ansi.Count || m_Ansi.Params[Index] == 0) return Default;
+	return m_Ansi.Params[Index];
+}
+
+STATIC
+VOID
+FbConAnsiMoveTo(INTN Column, INTN Row)
+{
+	if (Column < 0) Column = 0;
+	if (Column >= m_Grid->Columns) Column = m_Grid->Columns - 1;
+	if (Row < 0) Row = 0;
+	if (Row >= m_Grid->Rows) Row = m_Grid->Rows - 1;
+
+	m_Grid->CursorX = (INT32)Column;
+	m_Grid->CursorY = (INT32)Row;
+	m_Grid->Flags |= FBCON_GRID_FLAG_ADDRESSED;
+}
+
+STATIC
+VOID
+FbConAnsiSelectGraphics(VOID)
+{
+	UINT8 Foreground = FBCON_ATTR_FG(m_Grid->Attribute);
+	UINT8 Background = FBCON_ATTR_BG(m_Grid->Attribute);
+	UINT32 Param;
+	UINTN i;
+
+	// An empty parameter list is a reset.
+	if (m_Ansi.Count == 0) m_Ansi.Count = 1;
+
+	for (i = 0; i < m_Ansi.Count && i < FBCON_ANSI_MAX_PARAMS; i++)
+	{
+		Param = m_Ansi.Params[i];
+
+		if (Param == 0)
+		{
+			Foreground = FBCON_ATTR_FG(FBCON_ATTR_DEFAULT);
+			Background = FBCON_ATTR_BG(FBCON_ATTR_DEFAULT);
+			m_Ansi.Bold = FALSE;
+		}
+		else if (Param == 1)
+		{
+			m_Ansi.Bold = TRUE;
+			Foreground |= 8;
+		}
+		else if (Param == 22)
+		{
+			m_Ansi.Bold = FALSE;
+			Foreground &= 7;
+		}
+		else if (Param == 7)
+		{
+			Param = Foreground;
+			Foreground = Background;
+			Background = (UINT8)Param;
+		}
+		else if (Param >= 30 && Param <= 37)
+		{
+			Foreground = (UINT8)(Param - 30) | (m_Ansi.Bold ? 8 : 0);
+		}
+		else if (Param == 39)
+		{
+			Foreground = FBCON_ATTR_FG(FBCON_ATTR_DEFAULT);
+		}
+		else if (Param >= 40 && Param <= 47)
+		{
+			Background = (UINT8)(Param - 40);
+		}
+		else if (Param == 49)
+		{
+			Background = FBCON_ATTR_BG(FBCON_ATTR_DEFAULT);
+		}
+		else if (Param >= 90 && Param <= 97)
+		{
+			Foreground = (UINT8)(Param - 90 + 8);
+		}
+		else if (Param >= 100 && Param <= 107)
+		{
+			Background = (UINT8)(Param - 100 + 8);
+		}
+	}
+
+	m_Grid->Attribute = FBCON_ATTR(Foreground, Background);
+}
+
+STATIC
+VOID
+FbConAnsiExecute(char Final)
+{
+	INTN Column = m_Grid->CursorX;
+	INTN Row = m_Grid->CursorY;
+	UINT32 Count = FbConAnsiParam(0, 1);
+
+	if (m_Ansi.Private) return;
+
+	switch (Final)
+	{
+	case 'A': FbConAnsiMoveTo(Column, Row - Count); break;
+	case 'B': FbConAnsiMoveTo(Column, Row + Count); break;
+	case 'C': FbConAnsiMoveTo(Column + Count, Row); break;
+	case 'D': FbConAnsiMoveTo(Column - Count, Row); break;
+	case 'G': FbConAnsiMoveTo(Count - 1, Row); break;
+	case 'd': FbConAnsiMoveTo(Column, Count - 1); break;
+	case 'H':
+	case 'f':
+		FbConAnsiMoveTo(FbConAnsiParam(1, 1) - 1, Count - 1);
+		break;
+	case 'J':
+		switch (FbConAnsiParam(0, 0))
+		{
+		case 0:
+			FbConGridEraseCells(Row, Column, m_Grid->Columns - 1);
+			FbConGridEraseRows(Row + 1, m_Grid->Rows);
+			break;
+		case 1:
+			FbConGridEraseRows(0, Row);
+			FbConGridEraseCells(Row, 0, Column);
+			break;
+		default:
+			FbConGridEraseRows(0, m_Grid->Rows);
+			break;
+		}
+		break;
+	case 'K':
+		switch (FbConAnsiParam(0, 0))
+		{
+		case 0: FbConGridEraseCells(Row, Column, m_Grid->Columns - 1); break;
+		case 1: FbConGridEraseCells(Row, 0, Column); break;
+		default: FbConGridEraseRows(Row, Row + 1); break;
+		}
+		break;
+	case 'm':
+		FbConAnsiSelectGraphics();
+		break;
+	case 's':
+		m_Grid->SavedX = m_Grid->CursorX;
+		m_Grid->SavedY = m_Grid->CursorY;
+		m_Grid->SavedAttribute = m_Grid->Attribute;
+		break;
+	case 'u':
+		m_Grid->Attribute = m_Grid->SavedAttribute;
+		FbConAnsiMoveTo(m_Grid->SavedX, m_Grid->SavedY);
+		break;
+	default:
+		// Scroll regions, modes and the like are not supported.
+		break;
+	}
+}
+
+/*
+ * Feed one byte through the VT100 parser. Returns TRUE when the byte was
+ * part of an escape sequence and must not be printed.
+ */
+BOOLEAN FbConAnsiInput(char c)
+{
+	switch (m_Ansi.State)
+	{
+	case FBCON_ANSI_NORMAL:
+		if (c != 0x1b) return FALSE;
+		m_Ansi.State = FBCON_ANSI_ESCAPE;
+		return TRUE;
+
+	case FBCON_ANSI_ESCAPE:
+		m_Ansi.State = FBCON_ANSI_NORMAL;
+		if (c == '[')
+		{
+			m_Ansi.State = FBCON_ANSI_CSI;
+			m_Ansi.Private = FALSE;
+			m_Ansi.Count = 0;
+			m_Ansi.Params[0] = 0;
+		}
+		else if (c == '7' || c == '8')
+		{
+			m_Ansi.Private = FALSE;
+			m_Ansi.Count = 0;
+			FbConAnsiExecute(c == '7' ? 's' : 'u');
+		}
+		else if (c == 'c')
+		{
+			m_Ansi.Bold = FALSE;
+			m_Grid->Attribute = FBCON_ATTR_DEFAULT;
+			FbConGridEraseRows(0, m_Grid->Rows);
+			FbConAnsiMoveTo(0, 0);
+		}
+		return TRUE;
+
+	default:
+		if (c >= '0' && c <= '9')
+		{
+			if (m_Ansi.Count == 0) m_Ansi.Count = 1;
+			if (m_Ansi.Params[m_Ansi.Count - 1] < 10000)
+			{
+				m_Ansi.Params[m_Ansi.Count - 1] = m_Ansi.Params[m_Ansi.Count - 1] * 10 + (c - '0');
+			}
+		}
+		else if (c == ';')
+		{
+			if (m_Ansi.Count == 0) m_Ansi.Count = 1;
+			if (m_Ansi.Count < FBCON_ANSI_MAX_PARAMS) m_Ansi.Params[m_Ansi.Count++] = 0;
+		}
+		else if (c >= 0x3c && c <= 0x3f)
+		{
+			m_Ansi.Private = TRUE;
+		}
+		else if (c >= 0x40 && c <= 0x7e)
+		{
+			m_Ansi.State = FBCON_ANSI_NORMAL;
+			FbConAnsiExecute(c);
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			// A control character cancels the sequence and is printed.
+			m_Ansi.State = FBCON_ANSI_NORMAL;
+			return FALSE;
+		}
+		return TRUE;
+	}
+}
@@ -0,0 +1,121 @@
+#include <PiDxe.h>
+
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+#include <Library/SynchronizationLib.h>
+
+#include "FrameBufferSerialPortLib.h"
+
+/*
+ * Log ring for deferred console rendering, shared by all modules, see
+ * FBCON_RING. Writers claim space by advancing Reserve with a
+ * compare-exchange, copy their bytes and then add them to Commit. UEFI runs
+ * on one core, so the only concurrency is a writer being interrupted by a
+ * writer at a higher TPL. Nested writers always finish before the one they
+ * interrupted, which means everything up to Reserve is complete whenever
+ * Commit catches up with it.
+ */
+FBCON_RING *m_Ring = NULL;
+
+STATIC
+VOID
+FbConRingAdd(volatile UINT32 *Value, UINT32 Count)
+{
+	UINT32 Old;
+
+	do
+	{
+		Old = *Value;
+	} while (InterlockedCompareExchange32((UINT32*)Value, Old, Old + Count) != Old);
+}
+
+BOOLEAN FbConRingActive(VOID)
+{
+	return m_Ring != NULL && m_Ring->Buffer != NULL;
+}
+
+UINTN FbConRingWrite(IN UINT8 *Buffer, IN UINTN NumberOfBytes)
+{
+	UINT32 Start;
+	UINT32 Count = (UINT32)NumberOfBytes;
+	UINT32 i;
+
+	do
+	{
+		Start = m_Ring->Reserve;
+		if (Start - m_Ring->Tail + Count > m_Ring->Mask + 1)
+		{
+			// Never block a DEBUG() caller, account for the loss instead.
+			FbConRingAdd(&m_Ring->Dropped, Count);
+			return NumberOfBytes;
+		}
+	} while (InterlockedCompareExchange32((UINT32*)&m_Ring->Reserve, Start, Start + Count) != Start);
+
+	for (i = 0; i < Count; i++)
+	{
+		m_Ring->Buffer[(Start + i) & m_Ring->Mask] = Buffer[i];
+	}
+
+	FbConRingAdd(&m_Ring->Commit, Count);
+	return NumberOfBytes;
+}
+
+/*
+ * Render everything committed so far. Only one drain runs at a time; a drain
+ * requested while another one is in progress (for example from a higher TPL)
+ * returns immediately and leaves the work to the one already running.
+ */
+VOID FbConRingDrain(VOID)
+{
+	UINT8 Chunk[64];
+	CHAR8 Note[48];
+	UINT32 End, Dropped;
+	UINTN Length;
+
+	if (!FbConRingActive()) return;
+	if (InterlockedCompareExchange32((UINT32*)&m_Ring->Draining, 0, 1) != 0) return;
+
+	for (;;)
+	{
+		End = m_Ring->Commit;
+		if (End != m_Ring->Reserve || End == m_Ring->Tail) break;
+
+		while (m_Ring->Tail != End)
+		{
+			for (Length = 0; Length < sizeof(Chunk) && m_Ring->Tail + Length != End; Length++)
+			{
+				Chunk[Length] = m_Ring->Buffer[(m_Ring->Tail + Length) & m_Ring->Mask];
+			}
+
+			// Free the space before rendering so writers are not held off.
+			m_Ring->Tail += (UINT32)Length;
+			FbConRender(Chunk, Length);
+		}
+	}
+
+	do
+	{
+		Dropped = m_Ring->Dropped;
+	} while (InterlockedCompareExchange32((UINT32*)&m_Ring->Dropped, Dropped, 0) != Dropped);
+
+	if (Dropped != 0)
+	{
+		Length = AsciiSPrint(Note, sizeof(Note), "\n[%d console bytes dropped]\n", Dropped);
+		FbConRender((UINT8*)Note, Length);
+	}
+
+	m_Ring->Draining = 0;
+}
+
+/*
+ * Render what is queued and stop deferring output. Used on panic paths and
+ * before boot services go away.
+ */
+VOID
+EnableSynchronousSerialPortIO(VOID)
+{
+	FbConRingDrain();
+
+	// A drain that was interrupted still needs the ring, leave it alone.
+	if (m_Ring != NULL && m_Ring->Draining == 0) m_Ring->Buffer = NULL;
+}
@@ -1,31 +1,75 @@
 #include <PiDxe.h>
 
 #include <Library/ArmLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/CacheMaintenanceLib.h>
 #include <Library/HobLib.h>
 #include <Library/SerialPortLib.h>
+#include <Library/UartLib.h>
 
 #include <Resources/font5x12.h>
 #include <Resources/FbColor.h>
+#include <Resources/FbConsole.h>
 
 #include "FrameBufferSerialPortLib.h"
 
-FBCON_POSITION m_Position;
+// Grid size in character cells, the cursor lives in the shared grid.
 FBCON_POSITION m_MaxPosition;
 FBCON_COLOR m_Color;
 BOOLEAN m_Initialized = FALSE;
 
+#define FBCON_CELL_WIDTH		((FONT_WIDTH + 1) * SCALE_FACTOR)
+#define FBCON_CELL_HEIGHT		(FONT_HEIGHT * SCALE_FACTOR)
+
+// ANSI colors 0-7 followed by their bright variants, see FBCON_ATTR.
+STATIC CONST UINT32 m_Palette[16] = {
+	FB_BGRA8888_BLACK, 0xffaa0000, 0xff00aa00, 0xffaa5500,
+	0xff0000aa, 0xffaa00aa, 0xff00aaaa, FB_BGRA8888_SILVER,
+	0xff555555, FB_BGRA8888_RED, FB_BGRA8888_GREEN, FB_BGRA8888_YELLOW,
+	FB_BGRA8888_BLUE, 0xffff00ff, FB_BGRA8888_CYAN, FB_BGRA8888_WHITE,
+};
+
+#define FBCON_PALETTE_YELLOW	11
+
+// Pre-expanded 32bpp glyph row spans per color pair, see FbConBuildAtlas.
+#define FBCON_ATLAS_PATTERNS	(1 << FONT_WIDTH)
+#define FBCON_ATLAS_MAX_SCALE	2
+#define FBCON_ATLAS_SLOTS		4
+
+typedef struct {
+	FBCON_COLOR Color;
+	unsigned Scale;				// 0 while the slot is unused
+	UINT32 Spans[FBCON_ATLAS_PATTERNS * (FONT_WIDTH + 1) * FBCON_ATLAS_MAX_SCALE];
+} FBCON_ATLAS;
+
+FBCON_ATLAS m_Atlas[FBCON_ATLAS_SLOTS];
+unsigned m_AtlasNext = 0;
+
+// Spans are UINT32 pixels sized for at most FBCON_ATLAS_MAX_SCALE.
+STATIC_ASSERT(FixedPcdGet32(PcdMipiFrameBufferPixelBpp) == 32, "Glyph atlas only supports 32bpp");
+STATIC_ASSERT(SCALE_FACTOR >= 1 && SCALE_FACTOR <= FBCON_ATLAS_MAX_SCALE, "Glyph atlas scale too large");
+
+// Framebuffer pixel rows written since the last FbConFlush, [Top, Bottom).
+UINTN m_DirtyTop = MAX_UINTN;
+UINTN m_DirtyBottom = 0;
+
+// Shared pan state when PcdFrameBufferConsoleHardwareScroll is set.
+FBCON_PAN_CONTROL *m_Pan = NULL;
+
+// Set once the mirror UART is clocked, it must not be touched before.
+BOOLEAN m_UartReady = FALSE;
+#define FBCON_UART_ACTIVE() (FeaturePcdGet(PcdSerialUartEnable) && m_UartReady)
+
 UINTN gWidth = FixedPcdGet32(PcdMipiFrameBufferWidth);
 // Reserve half screen for output
 UINTN gHeight = FixedPcdGet32(PcdMipiFrameBufferHeight);
 UINTN gBpp = FixedPcdGet32(PcdMipiFrameBufferPixelBpp);
 
 // Module-used internal routine
-void FbConPutCharWithFactor
+void FbConPutChar
 (
 	char c,
-	int type,
-	unsigned scale_factor
+	int type
 );
 
 void FbConDrawglyph
@@ -37,9 +81,16 @@ void FbConDrawglyph
 	unsigned scale_factor
 );
 
+UINT32 *FbConAtlasLookup(unsigned scale_factor);
+void FbConMarkDirty(UINTN top, UINTN bottom);
 void FbConReset(void);
-void FbConScrollUp(void);
+void FbConNewLine(void);
+void FbConFillRows(UINTN top, UINTN bottom, UINT32 color);
+void FbConScrollUp(unsigned lines);
 void FbConFlush(void);
+void FbConPanInitialize(void);
+void FbConPanScroll(UINTN shift);
+char *FbConVisibleBase(void);
 
 RETURN_STATUS
 EFIAPI
@@ -57,8 +108,18 @@ SerialPortInitialize
 	InterruptState = ArmGetInterruptState();
 	ArmDisableInterrupts();
 
-	// Reset console
+	// Reset console, keep the text of earlier modules
 	FbConReset();
+	FbConGridInitialize(m_MaxPosition.x, m_MaxPosition.y);
+	FbConAtlasLookup(SCALE_FACTOR);
+	if (FeaturePcdGet(PcdFrameBufferConsoleHardwareScroll)) FbConPanInitialize();
+
+	// Mirror everything to the hardware UART.
+	if (FeaturePcdGet(PcdSerialUartEnable))
+	{
+		UINT64 BaudRate = FixedPcdGet64(PcdSerialUartBaudRate);
+		m_UartReady = !RETURN_ERROR(UartInitialize(FixedPcdGet32(PcdSerialUartIndex), &BaudRate));
+	}
 
 	// Set flag
 	m_Initialized = TRUE;
@@ -67,121 +128,166 @@ SerialPortInitialize
 	return RETURN_SUCCESS;
 }
 
-void ResetFb(void)
-{
-	// Clear current screen.
-	char* Pixels = (void*)FixedPcdGet32(PcdMipiFrameBufferAddress);
-	UINTN BgColor = FB_BGRA8888_BLACK;
-
-	// Set to black color.
-	for (UINTN i = 0; i < gWidth; i++)
-	{
-		for (UINTN j = 0; j < gHeight; j++)
-		{
-			BgColor = FB_BGRA8888_BLACK;
-			// Set pixel bit
-			for (UINTN p = 0; p < (gBpp / 8); p++)
-			{
-				*Pixels = (unsigned char)BgColor;
-				BgColor = BgColor >> 8;
-				Pixels++;
-			}
-		}
-	}
-}
-
 void FbConReset(void)
 {
-	// Reset position.
-	m_Position.x = 0;
-	m_Position.y = 0;
-
 	// Calc max position.
-	m_MaxPosition.x = gWidth / (FONT_WIDTH + 1);
-	m_MaxPosition.y = (gHeight - 1) / FONT_HEIGHT;
+	m_MaxPosition.x = gWidth / FBCON_CELL_WIDTH;
+	m_MaxPosition.y = (gHeight - 1) / FBCON_CELL_HEIGHT;
 
 	// Reset color.
 	m_Color.Foreground = FB_BGRA8888_WHITE;
 	m_Color.Background = FB_BGRA8888_BLACK;
 }
 
-void FbConPutCharWithFactor
+/*
+ * Callers run with interrupts disabled. Text only goes into the grid here,
+ * FbConFlush draws the cells that changed.
+ */
+void FbConPutChar
 (
 	char c,
-	int type,
-	unsigned scale_factor
+	int type
 )
 {
-	char* Pixels;
-
 	if (!m_Initialized) return;
 
-paint:
+	if (FbConAnsiInput(c)) return;
 
 	if ((unsigned char)c > 127) return;
 
 	if ((unsigned char)c < 32)
 	{
-		if (c == '\n')
+		if (c == '\r')
 		{
-			goto newline;
+			m_Grid->CursorX = 0;
 		}
-		else if (c == '\r')
+		else if (c == '\n')
 		{
-			m_Position.x = 0;
-			return;
+			FbConNewLine();
 		}
-		else
+		else if (c == '\b')
 		{
-			return;
+			if (m_Grid->CursorX > 0) m_Grid->CursorX--;
 		}
+		return;
 	}
 
-	// Save some space
-	if (m_Position.x == 0 && (unsigned char)c == ' ' &&
+	// Save some space, unless a client placed the cursor on purpose
+	if (m_Grid->CursorX == 0 && (unsigned char)c == ' ' &&
+		!(m_Grid->Flags & FBCON_GRID_FLAG_ADDRESSED) &&
 		type != FBCON_SUBTITLE_MSG &&
 		type != FBCON_TITLE_MSG)
 		return;
 
-	BOOLEAN intstate = ArmGetInterruptState();
-	ArmDisableInterrupts();
+	FbConGridSet(m_Grid->CursorX, m_Grid->CursorY, FBCON_CELL(c, m_Grid->Attribute));
+
+	m_Grid->CursorX++;
+
+	if (m_Grid->CursorX >= m_MaxPosition.x) FbConNewLine();
+}
+
+void FbConNewLine(void)
+{
+	m_Grid->CursorY++;
+	m_Grid->CursorX = 0;
+	m_Grid->Flags &= ~FBCON_GRID_FLAG_ADDRESSED;
 
-	Pixels = (void*)FixedPcdGet32(PcdMipiFrameBufferAddress);
-	Pixels += m_Position.y * ((gBpp / 8) * FONT_HEIGHT * gWidth);
-	Pixels += m_Position.x * scale_factor * ((gBpp / 8) * (FONT_WIDTH + 1));
+	// Keep the cursor on the last full line and move the text up instead.
+	if (m_Grid->CursorY >= m_MaxPosition.y)
+	{
+		FbConScrollUp(m_Grid->CursorY - m_MaxPosition.y + 1);
+		m_Grid->CursorY = m_MaxPosition.y - 1;
+	}
+
+	FbConFlush();
+}
+
+void FbConDrawCell(UINTN x, UINTN y, UINT16 cell)
+{
+	char c = FBCON_CELL_CHAR(cell);
+	UINT8 attr = FBCON_CELL_ATTR(cell);
+	char *Pixels;
+
+	if ((unsigned char)c < 32 || (unsigned char)c > 127) c = ' ';
+
+	Pixels = FbConVisibleBase();
+	Pixels += y * FBCON_CELL_HEIGHT * gWidth * (gBpp / 8);
+	Pixels += x * FBCON_CELL_WIDTH * (gBpp / 8);
+
+	m_Color.Foreground = m_Palette[FBCON_ATTR_FG(attr)];
+	m_Color.Background = m_Palette[FBCON_ATTR_BG(attr)];
 
 	FbConDrawglyph(
 		Pixels,
 		gWidth,
 		(gBpp / 8),
 		font5x12 + (c - 32) * 2,
-		scale_factor);
+		SCALE_FACTOR);
 
-	m_Position.x++;
+	FbConMarkDirty(y * FBCON_CELL_HEIGHT, (y + 1) * FBCON_CELL_HEIGHT);
+}
 
-	if (m_Position.x >= (int)(m_MaxPosition.x / scale_factor)) goto newline;
+// Fill text rows [top, bottom) with the background of the attribute.
+void FbConFillCellRows(UINTN top, UINTN bottom, UINT8 attr)
+{
+	FbConFillRows(top * FBCON_CELL_HEIGHT, bottom * FBCON_CELL_HEIGHT, m_Palette[FBCON_ATTR_BG(attr)]);
+}
 
-	if (intstate) ArmEnableInterrupts();
-	return;
+/*
+ * Every glyph row of font5x12 is a 5-bit pattern, so a row of any glyph is
+ * one of 32 spans. Expand those spans once for a pair of colors and a scale
+ * factor, then draw a character as FONT_HEIGHT * scale_factor span copies.
+ * The span covers the whole cell including the spacing column, which keeps
+ * rows 8-byte sized and aligned for 32bpp.
+ */
+void FbConBuildAtlas(FBCON_ATLAS *atlas, unsigned scale_factor)
+{
+	UINT32 *span = atlas->Spans;
+	unsigned pattern, x, j;
 
-newline:
-	m_Position.y += scale_factor;
-	m_Position.x = 0;
-	if (m_Position.y >= m_MaxPosition.y - scale_factor)
+	for (pattern = 0; pattern < FBCON_ATLAS_PATTERNS; pattern++)
 	{
-		ResetFb();
-		FbConFlush();
-		m_Position.y = 0;
-
-		if (intstate) ArmEnableInterrupts();
-		goto paint;
+		for (x = 0; x < FONT_WIDTH + 1; x++)
+		{
+			for (j = 0; j < scale_factor; j++)
+			{
+				*span++ = (x < FONT_WIDTH && (pattern & (1 << x))) ?
+					(UINT32)m_Color.Foreground :
+					(UINT32)m_Color.Background;
+			}
+		}
 	}
-	else
+
+	atlas->Color = m_Color;
+	atlas->Scale = scale_factor;
+}
+
+/*
+ * Return the spans for the current colors. Each color pair gets a slot of
+ * its own, so cells of different attributes side by side reuse their spans;
+ * a pair that is not cached replaces the oldest slot.
+ */
+UINT32 *FbConAtlasLookup(unsigned scale_factor)
+{
+	FBCON_ATLAS *atlas;
+	unsigned i;
+
+	for (i = 0; i < FBCON_ATLAS_SLOTS; i++)
 	{
-		FbConFlush();
-		if (intstate) ArmEnableInterrupts();
+		atlas = &m_Atlas[i];
+		if (atlas->Scale == scale_factor &&
+			atlas->Color.Foreground == m_Color.Foreground &&
+			atlas->Color.Background == m_Color.Background)
+		{
+			return atlas->Spans;
+		}
 	}
 
+	atlas = &m_Atlas[m_AtlasNext];
+	m_AtlasNext = (m_AtlasNext + 1) % FBCON_ATLAS_SLOTS;
+	FbConBuildAtlas(atlas, scale_factor);
+
+	return atlas->Spans;
 }
 
 void FbConDrawglyph
@@ -193,160 +299,225 @@ void FbConDrawglyph
 	unsigned scale_factor
 )
 {
-	char *bg_pixels = pixels;
-	unsigned x, y, i, j, k;
-	unsigned data, temp;
-	unsigned int fg_color = m_Color.Foreground;
-	unsigned int bg_color = m_Color.Background;
-	stride -= FONT_WIDTH * scale_factor;
-
-	for (y = 0; y < FONT_HEIGHT / 2; ++y)
-	{
-		for (i = 0; i < scale_factor; i++)
-		{
-			for (x = 0; x < FONT_WIDTH; ++x)
-			{
-				for (j = 0; j < scale_factor; j++)
-				{
-					bg_color = m_Color.Background;
-					for (k = 0; k < bpp; k++)
-					{
-						*bg_pixels = (unsigned char)bg_color;
-						bg_color = bg_color >> 8;
-						bg_pixels++;
-					}
-				}
-			}
-			bg_pixels += (stride * bpp);
-		}
-	}
+	UINT32 *atlas;
+	UINT32 *span;
+	unsigned y, i, half, k;
+	unsigned data;
+	unsigned span_pixels;
 
-	for (y = 0; y < FONT_HEIGHT / 2; ++y)
-	{
-		for (i = 0; i < scale_factor; i++)
-		{
-			for (x = 0; x < FONT_WIDTH; ++x)
-			{
-				for (j = 0; j < scale_factor; j++)
-				{
-					bg_color = m_Color.Background;
-					for (k = 0; k < bpp; k++)
-					{
-						*bg_pixels = (unsigned char)bg_color;
-						bg_color = bg_color >> 8;
-						bg_pixels++;
-					}
-				}
-			}
-			bg_pixels += (stride * bpp);
-		}
-	}
+	// bpp and scale_factor are held to what the atlas supports by the STATIC_ASSERTs above.
+	atlas = FbConAtlasLookup(scale_factor);
 
-	data = glyph[0];
-	for (y = 0; y < FONT_HEIGHT / 2; ++y)
+	span_pixels = (FONT_WIDTH + 1) * scale_factor;
+	stride *= bpp;
+
+	for (half = 0; half < 2; half++)
 	{
-		temp = data;
-		for (i = 0; i < scale_factor; i++)
+		data = glyph[half];
+		for (y = 0; y < FONT_HEIGHT / 2; ++y)
 		{
-			data = temp;
-			for (x = 0; x < FONT_WIDTH; ++x)
+			span = atlas + (data & (FBCON_ATLAS_PATTERNS - 1)) * span_pixels;
+			for (i = 0; i < scale_factor; i++)
 			{
-				if (data & 1)
+				if ((span_pixels & 1) == 0 && ((UINTN)pixels & 7) == 0)
 				{
-					for (j = 0; j < scale_factor; j++)
-					{
-						fg_color = m_Color.Foreground;
-						for (k = 0; k < bpp; k++)
-						{
-							*pixels = (unsigned char)fg_color;
-							fg_color = fg_color >> 8;
-							pixels++;
-						}
-					}
+					UINT64 *dst = (UINT64 *)pixels;
+					UINT64 *src = (UINT64 *)span;
+					for (k = 0; k < span_pixels / 2; k++) dst[k] = src[k];
 				}
 				else
 				{
-					for (j = 0; j < scale_factor; j++)
-					{
-						pixels = pixels + bpp;
-					}
+					UINT32 *dst = (UINT32 *)pixels;
+					for (k = 0; k < span_pixels; k++) dst[k] = span[k];
 				}
-				data >>= 1;
+				pixels += stride;
 			}
-			pixels += (stride * bpp);
+			data >>= FONT_WIDTH;
 		}
 	}
+}
+
+void FbConFillRows(UINTN top, UINTN bottom, UINT32 color)
+{
+	char *pixels = FbConVisibleBase();
+	UINTN row_bytes = gWidth * (gBpp / 8);
+	UINTN count, k;
+
+	if (top >= bottom) return;
+
+	pixels += top * row_bytes;
+	count = (bottom - top) * row_bytes;
 
-	data = glyph[1];
-	for (y = 0; y < FONT_HEIGHT / 2; ++y)
+	if (gBpp == 32)
 	{
-		temp = data;
-		for (i = 0; i < scale_factor; i++)
+		SetMem32(pixels, count, color);
+	}
+	else
+	{
+		for (; count >= (gBpp / 8); count -= (gBpp / 8))
 		{
-			data = temp;
-			for (x = 0; x < FONT_WIDTH; ++x)
-			{
-				if (data & 1)
-				{
-					for (j = 0; j < scale_factor; j++)
-					{
-						fg_color = m_Color.Foreground;
-						for (k = 0; k < bpp; k++)
-						{
-							*pixels = (unsigned char)fg_color;
-							fg_color = fg_color >> 8;
-							pixels++;
-						}
-					}
-				}
-				else
-				{
-					for (j = 0; j < scale_factor; j++)
-					{
-						pixels = pixels + bpp;
-					}
-				}
-				data >>= 1;
-			}
-			pixels += (stride * bpp);
+			for (k = 0; k < (gBpp / 8); k++) *pixels++ = (char)(color >> (k * 8));
 		}
 	}
+
+	FbConMarkDirty(top, bottom);
 }
 
-/* TODO: Take stride into account */
-void FbConScrollUp(void)
+/*
+ * Move the text area up by the given number of text lines. The framebuffer
+ * stride is gWidth pixels, so the text area is one contiguous block and the
+ * move is a single CopyMem. Only the exposed band at the bottom is cleared.
+ * The grid moves along, after its pending cells are drawn.
+ */
+void FbConScrollUp(unsigned lines)
 {
-	unsigned short *dst = (void*)FixedPcdGet32(PcdMipiFrameBufferAddress);
-	unsigned short *src = dst + (gWidth * FONT_HEIGHT);
-	unsigned count = gWidth * (gHeight - FONT_HEIGHT);
+	char *base = FbConVisibleBase();
+	UINTN row_bytes = gWidth * (gBpp / 8);
+	UINTN text_rows = m_MaxPosition.y * FBCON_CELL_HEIGHT;
+	UINTN shift = lines * FBCON_CELL_HEIGHT;
 
-	while (count--)
+	if (shift > text_rows) shift = text_rows;
+
+	FbConGridRender();
+	FbConGridScrollUp(lines);
+
+	if (m_Pan != NULL && !(m_Pan->Flags & FBCON_PAN_FLAG_RELEASED))
 	{
-		*dst++ = *src++;
+		FbConPanScroll(shift);
+		return;
 	}
 
-	count = gWidth * FONT_HEIGHT;
-	while (count--)
+	CopyMem(base, base + shift * row_bytes, (text_rows - shift) * row_bytes);
+	FbConMarkDirty(0, text_rows - shift);
+
+	FbConFillRows(text_rows - shift, text_rows, m_Palette[FBCON_ATTR_BG(m_Grid->Attribute)]);
+}
+
+void FbConMarkDirty(UINTN top, UINTN bottom)
+{
+	if (bottom > gHeight) bottom = gHeight;
+	if (top < m_DirtyTop) m_DirtyTop = top;
+	if (bottom > m_DirtyBottom) m_DirtyBottom = bottom;
+}
+
+/*
+ * Clean only the rows touched since the last flush. Rows are contiguous in
+ * memory, so a single range operation covers the dirty band. Callers batch
+ * this at line or message boundaries rather than per character.
+ */
+void FbConFlush(void)
+{
+	UINTN row_bytes;
+
+	if (m_Grid != NULL) FbConGridRender();
+
+	if (m_DirtyTop >= m_DirtyBottom) return;
+
+	row_bytes = gWidth * (gBpp / 8);
+
+	WriteBackDataCacheRange(
+		FbConVisibleBase() + m_DirtyTop * row_bytes,
+		(m_DirtyBottom - m_DirtyTop) * row_bytes
+	);
+
+	m_DirtyTop = MAX_UINTN;
+	m_DirtyBottom = 0;
+}
+
+char *FbConVisibleBase(void)
+{
+	char *base = (char*)FixedPcdGet32(PcdMipiFrameBufferAddress);
+
+	if (m_Pan != NULL) base += m_Pan->PanRow * FBCON_ROW_BYTES;
+	return base;
+}
+
+/*
+ * Attach to the pan state left by an earlier module, or create it when this
+ * is the first console instance to run. Window A still points at the
+ * framebuffer base at that point, which matches PanRow 0.
+ */
+void FbConPanInitialize(void)
+{
+	FBCON_PAN_CONTROL *pan = (FBCON_PAN_CONTROL*)FBCON_PAN_CONTROL_ADDRESS;
+
+	if (FixedPcdGet32(PcdMipiFrameBufferVirtualHeight) < gHeight) return;
+
+	if (pan->Signature != FBCON_PAN_SIGNATURE || !FBCON_PAN_FITS(pan->PanRow, gHeight))
+	{
+		pan->Signature = FBCON_PAN_SIGNATURE;
+		pan->Flags = 0;
+		pan->PanRow = 0;
+		pan->Reserved = 0;
+		WriteBackDataCacheRange(pan, sizeof(*pan));
+	}
+
+	m_Pan = pan;
+}
+
+/*
+ * Scroll by moving window A down the virtual framebuffer. The text that stays
+ * on screen is not touched, only the exposed band is cleared. Once the window
+ * reaches the end of the virtual framebuffer it goes back to the top and the
+ * text is redrawn there from the (already scrolled) grid, which only has to
+ * draw the cells that are not blank. That happens once per
+ * (VirtualHeight - gHeight) lines.
+ */
+void FbConPanScroll(UINTN shift)
+{
+	UINTN text_rows = m_MaxPosition.y * FBCON_CELL_HEIGHT;
+	UINTN pan_row = m_Pan->PanRow;
+	UINTN top;
+
+	// Dirty rows are relative to the current window.
+	FbConFlush();
+
+	if (FBCON_PAN_FITS(pan_row + shift, gHeight))
 	{
-		*dst++ = m_Color.Background;
+		m_Pan->PanRow = pan_row + shift;
+		top = text_rows - shift;
+	}
+	else
+	{
+		m_Pan->PanRow = 0;
+		FbConGridRedraw();
+		top = text_rows;
 	}
 
+	FbConFillRows(top, gHeight, m_Palette[FBCON_ATTR_BG(m_Grid->Attribute)]);
 	FbConFlush();
+	WriteBackDataCacheRange(m_Pan, sizeof(*m_Pan));
+
+	FBCON_PAN_WINDOW(FbConVisibleBase());
 }
 
-void FbConFlush(void)
+void FbConRender(UINT8 *Buffer, UINTN NumberOfBytes)
 {
-	unsigned total_x, total_y;
-	unsigned bytes_per_bpp;
+	UINT8* CONST Final = &Buffer[NumberOfBytes];
+	UINT8* Chunk;
+	UINTN  InterruptState = ArmGetInterruptState();
+	ArmDisableInterrupts();
 
-	total_x = gWidth;
-	total_y = gHeight;
-	bytes_per_bpp = (gBpp / 8);
+	while (Buffer < Final)
+	{
+		// Hand the UART one FIFO worth, then draw the same bytes while
+		// it shifts them out.
+		Chunk = Buffer + MIN((UINTN)(Final - Buffer), UART_FIFO_DEPTH);
+		if (FBCON_UART_ACTIVE())
+		{
+			UartWrite(FixedPcdGet32(PcdSerialUartIndex), Buffer, Chunk - Buffer);
+		}
 
-	WriteBackInvalidateDataCacheRange(
-		(void*)FixedPcdGet32(PcdMipiFrameBufferAddress),
-		(total_x * total_y * bytes_per_bpp)
-	);
+		while (Buffer < Chunk)
+		{
+			FbConPutChar(*Buffer++, FBCON_COMMON_MSG);
+		}
+	}
+
+	// Push out a trailing partial line.
+	FbConFlush();
+
+	if (InterruptState) ArmEnableInterrupts();
 }
 
 UINTN
@@ -357,16 +528,18 @@ SerialPortWrite
 	IN UINTN     NumberOfBytes
 )
 {
-	UINT8* CONST Final = &Buffer[NumberOfBytes];
-	UINTN  InterruptState = ArmGetInterruptState();
-	ArmDisableInterrupts();
-
-	while (Buffer < Final)
+	// A zero length write flushes, as it does for BaseSerialPortLib16550.
+	// SimpleFbDxe drains the shared log ring this way.
+	if (NumberOfBytes == 0)
 	{
-		FbConPutCharWithFactor(*Buffer++, FBCON_COMMON_MSG, SCALE_FACTOR);
+		FbConRingDrain();
+		return 0;
 	}
 
-	if (InterruptState) ArmEnableInterrupts();
+	// Deferred mode, the drain timer renders it later.
+	if (FbConRingActive()) return FbConRingWrite(Buffer, NumberOfBytes);
+
+	FbConRender(Buffer, NumberOfBytes);
 	return NumberOfBytes;
 }
 
@@ -379,18 +552,32 @@ SerialPortWriteCritical
 )
 {
 	UINT8* CONST Final = &Buffer[NumberOfBytes];
-	UINTN  CurrentForeground = m_Color.Foreground;
-	UINTN  InterruptState = ArmGetInterruptState();
+	UINT8  Attribute = 0;
+	UINTN  InterruptState;
+
+	// Keep the order of queued output.
+	FbConRingDrain();
 
+	InterruptState = ArmGetInterruptState();
 	ArmDisableInterrupts();
-	m_Color.Foreground = FB_BGRA8888_YELLOW;
+	if (m_Grid != NULL)
+	{
+		Attribute = m_Grid->Attribute;
+		m_Grid->Attribute = FBCON_ATTR(FBCON_PALETTE_YELLOW, FBCON_ATTR_BG(Attribute));
+	}
+
+	if (FBCON_UART_ACTIVE())
+	{
+		UartWrite(FixedPcdGet32(PcdSerialUartIndex), Buffer, NumberOfBytes);
+	}
 
 	while (Buffer < Final)
 	{
-		FbConPutCharWithFactor(*Buffer++, FBCON_COMMON_MSG, SCALE_FACTOR);
+		FbConPutChar(*Buffer++, FBCON_COMMON_MSG);
 	}
 
-	m_Color.Foreground = CurrentForeground;
+	if (m_Grid != NULL) m_Grid->Attribute = Attribute;
+	FbConFlush();
 
 	if (InterruptState) ArmEnableInterrupts();
 	return NumberOfBytes;
@@ -404,7 +591,8 @@ SerialPortRead
 	IN  UINTN     NumberOfBytes
 )
 {
-	return 0;
+	if (!FBCON_UART_ACTIVE()) return 0;
+	return UartRead(FixedPcdGet32(PcdSerialUartIndex), Buffer, NumberOfBytes);
 }
 
 BOOLEAN
@@ -414,7 +602,8 @@ SerialPortPoll
 	VOID
 )
 {
-	return FALSE;
+	if (!FBCON_UART_ACTIVE()) return FALSE;
+	return UartPoll(FixedPcdGet32(PcdSerialUartIndex));
 }
 
 RETURN_STATUS
@@ -449,16 +638,34 @@ SerialPortSetAttributes
 	IN OUT EFI_STOP_BITS_TYPE *StopBits
 )
 {
-	return RETURN_UNSUPPORTED;
+	RETURN_STATUS Status;
+	UINT64 Rate;
+
+	if (!FeaturePcdGet(PcdSerialUartEnable)) return RETURN_UNSUPPORTED;
+
+	// Only the baud rate is adjustable, the port stays 8n1.
+	if ((*Parity != DefaultParity && *Parity != NoParity) ||
+		(*DataBits != 0 && *DataBits != 8) ||
+		(*StopBits != DefaultStopBits && *StopBits != OneStopBit))
+	{
+		return RETURN_INVALID_PARAMETER;
+	}
+
+	Rate = (*BaudRate != 0) ? *BaudRate : FixedPcdGet64(PcdSerialUartBaudRate);
+	Status = UartInitialize(FixedPcdGet32(PcdSerialUartIndex), &Rate);
+	if (RETURN_ERROR(Status)) return Status;
+	m_UartReady = TRUE;
+
+	*BaudRate = Rate;
+	*ReceiveFifoDepth = UART_FIFO_DEPTH;
+	*Parity = NoParity;
+	*DataBits = 8;
+	*StopBits = OneStopBit;
+	return RETURN_SUCCESS;
 }
 
 UINTN SerialPortFlush(VOID)
 {
+	FbConRingDrain();
 	return 0;
-}
-
-VOID
-EnableSynchronousSerialPortIO(VOID)
-{
-	// Already synchronous
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef _FRAMEBUFFER_SERIALPORT_LIB_H_
 #define _FRAMEBUFFER_SERIALPORT_LIB_H_
 
+#include <Resources/FbConsole.h>
+
 typedef struct _FBCON_POSITION {
     INTN x;
     INTN y;
@@ -28,7 +30,30 @@ enum FbConMsgType {
 	FBCON_SELECT_MSG_BG_COLOR,
 };
 
-void ResetFb(void);
+// Shared log ring, NULL until this module found it
+extern FBCON_RING *m_Ring;
+
+BOOLEAN FbConRingActive(VOID);
+UINTN FbConRingWrite(IN UINT8 *Buffer, IN UINTN NumberOfBytes);
+VOID FbConRingDrain(VOID);
+VOID EnableSynchronousSerialPortIO(VOID);
+
+void FbConRender(UINT8 *Buffer, UINTN NumberOfBytes);
+
+// Character grid and escape sequences, FbConGrid.c
+extern FBCON_GRID *m_Grid;
+
+VOID FbConGridInitialize(UINTN Columns, UINTN Rows);
+VOID FbConGridSet(UINTN Column, UINTN Row, UINT16 Cell);
+VOID FbConGridRender(VOID);
+VOID FbConGridRedraw(VOID);
+VOID FbConGridScrollUp(UINTN Lines);
+VOID FbConGridEraseRows(UINTN Top, UINTN Bottom);
+BOOLEAN FbConAnsiInput(char c);
+
+// Drawing primitives for the grid
+void FbConDrawCell(UINTN x, UINTN y, UINT16 cell);
+void FbConFillCellRows(UINTN top, UINTN bottom, UINT8 attr);
 
 UINTN
 EFIAPI
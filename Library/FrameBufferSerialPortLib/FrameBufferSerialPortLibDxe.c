@@ -0,0 +1,136 @@
+#include <PiDxe.h>
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "FrameBufferSerialPortLib.h"
+
+/*
+ * The log ring and its drain timer belong to SimpleFbDxe, see FBCON_RING.
+ * A module only looks the ring up, so all of them queue into one ring and
+ * none of them leaves a timer behind.
+ */
+STATIC EFI_EVENT mRingPublishedEvent = NULL;
+STATIC EFI_EVENT mExitBootServicesEvent = NULL;
+
+STATIC
+BOOLEAN
+FbConRingAttach
+(
+	VOID
+)
+{
+	UINTN Index;
+
+	for (Index = 0; Index < gST->NumberOfTableEntries; Index++)
+	{
+		if (CompareGuid(&gNintendoSwitchConsoleRingGuid, &gST->ConfigurationTable[Index].VendorGuid))
+		{
+			m_Ring = gST->ConfigurationTable[Index].VendorTable;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Installing the configuration table signals the event group of its GUID.
+ * Output of this module was synchronous up to here, nothing was queued yet.
+ */
+STATIC
+VOID
+EFIAPI
+FbConRingPublishedNotify
+(
+	IN EFI_EVENT Event,
+	IN VOID      *Context
+)
+{
+	if (!FbConRingAttach()) return;
+
+	gBS->CloseEvent(Event);
+	mRingPublishedEvent = NULL;
+}
+
+/*
+ * Timer events stop firing once boot services are gone. Render whatever is
+ * left and fall back to synchronous output; the first module to get here
+ * does it for all of them. The ring is boot services memory, so this module
+ * must not look at it again.
+ */
+STATIC
+VOID
+EFIAPI
+FbConExitBootServicesNotify
+(
+	IN EFI_EVENT Event,
+	IN VOID      *Context
+)
+{
+	EnableSynchronousSerialPortIO();
+	m_Ring = NULL;
+}
+
+RETURN_STATUS
+EFIAPI
+FrameBufferSerialPortLibDxeConstructor
+(
+	VOID
+)
+{
+	EFI_STATUS Status;
+
+	if (!FeaturePcdGet(PcdFrameBufferConsoleAsync)) return RETURN_SUCCESS;
+
+	// Synchronous until SimpleFbDxe publishes the ring.
+	if (!FbConRingAttach())
+	{
+		Status = gBS->CreateEventEx(
+			EVT_NOTIFY_SIGNAL,
+			TPL_CALLBACK,
+			FbConRingPublishedNotify,
+			NULL,
+			&gNintendoSwitchConsoleRingGuid,
+			&mRingPublishedEvent);
+		if (EFI_ERROR(Status)) return RETURN_SUCCESS;
+	}
+
+	Status = gBS->CreateEvent(
+		EVT_SIGNAL_EXIT_BOOT_SERVICES,
+		TPL_NOTIFY,
+		FbConExitBootServicesNotify,
+		NULL,
+		&mExitBootServicesEvent);
+	if (EFI_ERROR(Status))
+	{
+		// Asynchronous output is an optimization, keep the synchronous console.
+		if (mRingPublishedEvent != NULL) gBS->CloseEvent(mRingPublishedEvent);
+		mRingPublishedEvent = NULL;
+		m_Ring = NULL;
+	}
+
+	return RETURN_SUCCESS;
+}
+
+/*
+ * The events point into this image, so they must be gone before an
+ * application or a failed driver is unloaded. What it queued stays in the
+ * ring and is rendered by SimpleFbDxe.
+ */
+RETURN_STATUS
+EFIAPI
+FrameBufferSerialPortLibDxeDestructor
+(
+	VOID
+)
+{
+	if (mRingPublishedEvent != NULL) gBS->CloseEvent(mRingPublishedEvent);
+	if (mExitBootServicesEvent != NULL) gBS->CloseEvent(mExitBootServicesEvent);
+
+	mRingPublishedEvent = mExitBootServicesEvent = NULL;
+	m_Ring = NULL;
+
+	return RETURN_SUCCESS;
+}
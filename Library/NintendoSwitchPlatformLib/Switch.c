@@ -17,8 +17,12 @@
 
 #include <Library/IoLib.h>
 #include <Library/ArmPlatformLib.h>
+#include <Library/ArmGenericTimerCounterLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
 #include <Ppi/ArmMpCoreInfo.h>
+#include <Guid/BootLog.h>
+#include <Resources/FbConsole.h>
 
 /**
   Return the current Boot Mode
@@ -36,6 +40,54 @@ ArmPlatformGetBootMode(
 	return BOOT_WITH_FULL_CONFIGURATION;
 }
 
+/**
+  Claim the persistent boot log for this boot. A log that survived a warm
+  reset intact is kept and continued, anything else is reset.
+**/
+STATIC
+VOID
+InitializeBootLog(
+	VOID
+)
+{
+	BOOT_LOG_HEADER *Log = (BOOT_LOG_HEADER *)(UINTN)FixedPcdGet64(PcdBootLogBase);
+	UINT32 DataSize = FixedPcdGet32(PcdBootLogSize) - sizeof(BOOT_LOG_HEADER);
+
+	if (Log->Signature == BOOT_LOG_SIGNATURE &&
+		Log->Version == BOOT_LOG_VERSION &&
+		Log->HeaderSize == sizeof(BOOT_LOG_HEADER) &&
+		Log->DataSize == DataSize &&
+		Log->First + sizeof(BOOT_LOG_RECORD) <= DataSize &&
+		Log->Next + sizeof(BOOT_LOG_RECORD) <= DataSize &&
+		(Log->First % BOOT_LOG_ALIGNMENT) == 0 &&
+		(Log->Next % BOOT_LOG_ALIGNMENT) == 0)
+	{
+		Log->BootCount++;
+	}
+	else
+	{
+		// Hide the header from the debug library while it is rebuilt
+		Log->Signature = 0;
+		Log->Version = BOOT_LOG_VERSION;
+		Log->HeaderSize = sizeof(BOOT_LOG_HEADER);
+		Log->DataSize = DataSize;
+		Log->BootCount = 0;
+		Log->Sequence = 0;
+		Log->First = 0;
+		Log->Next = 0;
+		Log->Used = 0;
+		Log->Signature = BOOT_LOG_SIGNATURE;
+	}
+
+	// Module indices and the level table are only valid within one boot
+	Log->ModuleCount = 0;
+	Log->LevelGeneration = 0;
+	Log->LevelTable = 0;
+	Log->Reserved = 0;
+	Log->Base = (UINT64)(UINTN)Log;
+	Log->TimerFrequency = ArmGenericTimerGetTimerFreq();
+}
+
 /**
   This function is called by PrePeiCore, in the SEC phase.
 **/
@@ -44,6 +96,14 @@ ArmPlatformInitialize(
 	IN  UINTN                     MpId
 )
 {
+	if (FeaturePcdGet(PcdBootLogEnable))
+	{
+		InitializeBootLog();
+	}
+
+	// The console grid holds the text of the previous boot, not this screen
+	((FBCON_GRID *)FBCON_GRID_ADDRESS)->Signature = 0;
+
 	return RETURN_SUCCESS;
 }
 
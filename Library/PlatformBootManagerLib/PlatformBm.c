@@ -30,6 +30,7 @@
 #include <Protocol/LoadedImage.h>
 #include <Protocol/PciIo.h>
 #include <Protocol/PciRootBridgeIo.h>
+#include <Protocol/Splash.h>
 #include <Guid/EventGroup.h>
 #include <Guid/TtyTerm.h>
 
@@ -534,9 +535,10 @@ PlatformBootManagerAfterConsole (
   VOID
   )
 {
-  ESRT_MANAGEMENT_PROTOCOL      *EsrtManagement;
-  EFI_STATUS                    Status;
-  EFI_GRAPHICS_OUTPUT_PROTOCOL  *GraphicsOutput;
+  ESRT_MANAGEMENT_PROTOCOL        *EsrtManagement;
+  EFI_STATUS                      Status;
+  EFI_GRAPHICS_OUTPUT_PROTOCOL    *GraphicsOutput;
+  NINTENDO_SWITCH_SPLASH_PROTOCOL *Splash;
   UINTN                         FirmwareVerLength;
   UINTN                         PosX;
   UINTN                         PosY;
@@ -544,9 +546,15 @@ PlatformBootManagerAfterConsole (
   FirmwareVerLength = StrLen (PcdGetPtr (PcdFirmwareVersionString));
 
   //
-  // Show the splash screen.
+  // Show the splash screen. Connecting the consoles has cleared the screen,
+  // so ask the display driver to put its native splash back up; there is
+  // no logo provider for BootLogoEnableLogo () on this platform.
   //
-  Status = BootLogoEnableLogo ();
+  Status = gBS->LocateProtocol (&gNintendoSwitchSplashProtocolGuid, NULL,
+                  (VOID **)&Splash);
+  if (!EFI_ERROR (Status)) {
+    Status = Splash->Show (Splash);
+  }
   if (EFI_ERROR (Status)) {
     if (FirmwareVerLength > 0) {
       Print (VERSION_STRING_PREFIX L"%s\n",
@@ -0,0 +1,210 @@
+#include <PiDxe.h>
+
+#include <Library/BaseLib.h>
+
+#include <Foundation/Types.h>
+#include <Device/T210.h>
+#include <Library/ClockLib.h>
+#include <Library/EarlyTimerLib.h>
+#include <Library/PinmuxLib.h>
+#include <Library/UartLib.h>
+
+static const u32 _uart_base_offset[] = { 0x0, 0x40, 0x200, 0x300 };
+
+/*! Reset, enable and source registers, mirrors _clock_uart in ClockLib. */
+static const clock_t _uart_clock[] = {
+	{ CLK_RST_CONTROLLER_RST_DEVICES_L, CLK_RST_CONTROLLER_CLK_OUT_ENB_L, CLK_RST_CONTROLLER_CLK_SOURCE_UARTA, 6 , 0, 0 },
+	{ CLK_RST_CONTROLLER_RST_DEVICES_L, CLK_RST_CONTROLLER_CLK_OUT_ENB_L, CLK_RST_CONTROLLER_CLK_SOURCE_UARTB, 7 , 0, 0 },
+	{ CLK_RST_CONTROLLER_RST_DEVICES_H, CLK_RST_CONTROLLER_CLK_OUT_ENB_H, CLK_RST_CONTROLLER_CLK_SOURCE_UARTC, 23, 0, 0 },
+	{ CLK_RST_CONTROLLER_RST_DEVICES_U, CLK_RST_CONTROLLER_CLK_OUT_ENB_U, CLK_RST_CONTROLLER_CLK_SOURCE_UARTD, 1 , 0, 0 }
+};
+
+#define UART_COUNT (sizeof(_uart_base_offset) / sizeof(_uart_base_offset[0]))
+#define UART(idx, off) _REG(UART_BASE + _uart_base_offset[idx], off)
+
+/*
+ * Split the baud rate between the clock source divider and the 16550
+ * divisor latch. Rates that PLLP divides exactly (3M, 1.5M, 1M, ...) are
+ * produced by the source divider alone with a divisor latch of 1, which
+ * keeps them free of rounding error. Everything else runs the UART at full
+ * PLLP rate and rounds the divisor latch.
+ */
+static void UartSolveBaudRate(u64 baud, u32 *src_div, u32 *latch, u64 *actual)
+{
+	u64 clk = 16 * baud;
+
+	if (((u64)UART_PLLP_RATE * 2) % clk == 0 &&
+		((u64)UART_PLLP_RATE * 2) / clk - 2 <= 0xFFFF)
+	{
+		*src_div = (u32)(((u64)UART_PLLP_RATE * 2) / clk - 2);
+		*latch = 1;
+		*actual = baud;
+		return;
+	}
+
+	*src_div = 0;
+	*latch = (u32)((UART_PLLP_RATE + clk / 2) / clk);
+	if (*latch == 0) *latch = 1;
+	if (*latch > 0xFFFF) *latch = 0xFFFF;
+	*actual = UART_PLLP_RATE / (16 * (u64)*latch);
+}
+
+static BOOLEAN UartIsClocked(UINT32 Index)
+{
+	const clock_t *clk = &_uart_clock[Index];
+
+	// Touching the UART while it is gated or in reset aborts.
+	return !(CLOCK(clk->reset) & (1 << clk->index)) &&
+		(CLOCK(clk->enable) & (1 << clk->index));
+}
+
+static u32 UartGetLatch(UINT32 Index)
+{
+	u32 latch;
+
+	UART(Index, UART_LCR) = UART_LCR_DLAB | UART_LCR_WORD_LENGTH_8;
+	latch = (UART(Index, UART_THR_DLAB) & 0xFF) | ((UART(Index, UART_IER_DLAB) & 0xFF) << 8);
+	UART(Index, UART_LCR) = UART_LCR_WORD_LENGTH_8;
+
+	return latch;
+}
+
+/*
+ * Function: UartInitialize
+ * Flow    : Every module carries its own SerialPortLib instance, so this
+ *           runs many times per boot. Reprogramming the port flushes the
+ *           FIFO, so only do it when the settings actually change, and let
+ *           the previous owner's output drain first.
+ */
+RETURN_STATUS
+UartInitialize
+(
+	IN     UINT32 Index,
+	IN OUT UINT64 *BaudRate
+)
+{
+	u32 src_div, latch, source;
+	u64 actual;
+
+	if (Index >= UART_COUNT) return RETURN_INVALID_PARAMETER;
+	if (*BaudRate == 0 || *BaudRate > UART_MAX_BAUD_RATE) return RETURN_INVALID_PARAMETER;
+
+	UartSolveBaudRate(*BaudRate, &src_div, &latch, &actual);
+	source = UART_SRC_CLK_DIV_EN | src_div;	// Source 0 is PLLP_OUT0
+
+	if (UartIsClocked(Index))
+	{
+		// Same source, 8n1 and divisor: an earlier module already brought
+		// the port up, leave its FIFO alone.
+		if (CLOCK(_uart_clock[Index].source) == source &&
+			UART(Index, UART_LCR) == UART_LCR_WORD_LENGTH_8 &&
+			UartGetLatch(Index) == latch)
+		{
+			*BaudRate = actual;
+			return RETURN_SUCCESS;
+		}
+
+		UartWaitIdle(Index);
+	}
+
+	// Pins: TX driven, RX pulled up so a floating line reads as idle.
+	PINMUX_AUX(PINMUX_AUX_UARTX_TX(Index)) = 0;
+	PINMUX_AUX(PINMUX_AUX_UARTX_RX(Index)) = PINMUX_INPUT_ENABLE | PINMUX_PULL_UP;
+
+	clock_enable_uart(Index);
+	CLOCK(_uart_clock[Index].source) = source;
+
+	UART(Index, UART_IER_DLAB) = 0;
+	UART(Index, UART_LCR) = UART_LCR_DLAB | UART_LCR_WORD_LENGTH_8;
+	UART(Index, UART_THR_DLAB) = (u8)latch;
+	UART(Index, UART_IER_DLAB) = (u8)(latch >> 8);
+	UART(Index, UART_LCR) = UART_LCR_WORD_LENGTH_8;
+	(void)UART(Index, UART_SPR);
+
+	// Enable and flush the FIFOs.
+	UART(Index, UART_IIR_FCR) = UART_FCR_EN_FIFO;
+	(void)UART(Index, UART_SPR);
+	sleep(20);
+	UART(Index, UART_MCR) = 0;
+	sleep(96);
+	UART(Index, UART_IIR_FCR) = UART_FCR_EN_FIFO | UART_FCR_TX_CLR | UART_FCR_RX_CLR;
+	(void)UART(Index, UART_SPR);
+
+	*BaudRate = actual;
+	return RETURN_SUCCESS;
+}
+
+/*
+ * Function: UartWrite
+ * Flow    : Once THRE reports an empty FIFO, fill all of it without looking
+ *           at LSR again. Otherwise top it up one byte at a time while the
+ *           Tegra FIFO-full bit is clear, so the line never goes idle
+ *           waiting for a full drain.
+ */
+UINTN
+UartWrite
+(
+	IN UINT32       Index,
+	IN CONST UINT8  *Buffer,
+	IN UINTN        NumberOfBytes
+)
+{
+	CONST UINT8* CONST Final = &Buffer[NumberOfBytes];
+	u32 lsr;
+	UINTN burst;
+
+	while (Buffer < Final)
+	{
+		lsr = UART(Index, UART_LSR);
+		if (lsr & UART_LSR_THRE)
+		{
+			burst = MIN((UINTN)(Final - Buffer), UART_FIFO_DEPTH);
+			while (burst--) UART(Index, UART_THR_DLAB) = *Buffer++;
+		}
+		else if (!(lsr & UART_LSR_TX_FIFO_FULL))
+		{
+			UART(Index, UART_THR_DLAB) = *Buffer++;
+		}
+	}
+
+	return NumberOfBytes;
+}
+
+UINTN
+UartRead
+(
+	IN  UINT32  Index,
+	OUT UINT8   *Buffer,
+	IN  UINTN   NumberOfBytes
+)
+{
+	UINTN Count;
+
+	// Block for the first byte, then take whatever else is already queued.
+	for (Count = 0; Count < NumberOfBytes; Count++)
+	{
+		if (Count != 0 && !UartPoll(Index)) break;
+		while (!UartPoll(Index)) {}
+		Buffer[Count] = (UINT8)UART(Index, UART_THR_DLAB);
+	}
+
+	return Count;
+}
+
+BOOLEAN
+UartPoll
+(
+	IN UINT32 Index
+)
+{
+	return (UART(Index, UART_LSR) & UART_LSR_RDR) != 0;
+}
+
+VOID
+UartWaitIdle
+(
+	IN UINT32 Index
+)
+{
+	while (!(UART(Index, UART_LSR) & UART_LSR_TMTY)) {}
+}
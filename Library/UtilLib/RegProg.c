@@ -0,0 +1,127 @@
+/*
+ * Batched register programs: queued masked updates, merged per register.
+ *
+ * SPDX-License-Identifier:	GPL-2.0
+ */
+
+#include <PiDxe.h>
+
+#include <Library/IoLib.h>
+
+#include <Foundation/Types.h>
+#include <Library/EarlyTimerLib.h>
+#include <Library/UtilLib.h>
+
+void reg_prog_init(reg_prog_t *prog, reg_op_t *ops, u32 max_ops)
+{
+	prog->ops = ops;
+	prog->max_ops = max_ops;
+	prog->num_ops = 0;
+	prog->batch = 0;
+	prog->trace = NULL;
+	prog->max_trace = 0;
+	prog->num_trace = 0;
+}
+
+// Record every register write made by reg_prog_run() in trace.
+void reg_prog_set_trace(reg_prog_t *prog, reg_trace_t *trace, u32 max_trace)
+{
+	prog->trace = trace;
+	prog->max_trace = max_trace;
+	prog->num_trace = 0;
+}
+
+static reg_op_t *_reg_prog_add(reg_prog_t *prog)
+{
+	// Running what is queued so far keeps the ordering, it only ends the batch early.
+	if (prog->num_ops == prog->max_ops)
+		reg_prog_run(prog);
+
+	return &prog->ops[prog->num_ops++];
+}
+
+void reg_prog_update(reg_prog_t *prog, u32 *reg, u32 clear, u32 set)
+{
+	reg_op_t *op;
+
+	// Most programs touch the same register several times in a row, so search backwards.
+	for (u32 i = prog->num_ops; i > prog->batch; i--)
+	{
+		op = &prog->ops[i - 1];
+		if (op->reg == reg)
+		{
+			op->set = (op->set & ~clear) | set;
+			op->clear |= clear;
+			return;
+		}
+	}
+
+	op = _reg_prog_add(prog);
+	op->reg = reg;
+	op->clear = clear;
+	op->set = set;
+}
+
+void reg_prog_write(reg_prog_t *prog, u32 *reg, u32 val)
+{
+	reg_prog_update(prog, reg, 0xFFFFFFFF, val);
+}
+
+void reg_prog_cfg(reg_prog_t *prog, u32 *base, const cfg_op_t *ops, u32 num_ops)
+{
+	for (u32 i = 0; i < num_ops; i++)
+		reg_prog_write(prog, &base[ops[i].off], ops[i].val);
+}
+
+// Updates queued after a fence are written after everything queued before it.
+void reg_prog_fence(reg_prog_t *prog)
+{
+	reg_prog_delay(prog, 0);
+}
+
+void reg_prog_delay(reg_prog_t *prog, u32 us)
+{
+	reg_op_t *op;
+
+	// Nothing to separate.
+	if (!us && prog->num_ops == prog->batch)
+		return;
+
+	op = _reg_prog_add(prog);
+	op->reg = NULL;
+	op->clear = 0;
+	op->set = us;
+	prog->batch = prog->num_ops;
+}
+
+void reg_prog_run(reg_prog_t *prog)
+{
+	for (u32 i = 0; i < prog->num_ops; i++)
+	{
+		reg_op_t *op = &prog->ops[i];
+		u32 val;
+
+		if (!op->reg)
+		{
+			if (op->set)
+				sleep(op->set);
+			continue;
+		}
+
+		if (op->clear == 0xFFFFFFFF)
+			val = op->set;
+		else
+			val = (MmioRead32((UINTN)op->reg) & ~op->clear) | op->set;
+		MmioWrite32((UINTN)op->reg, val);
+
+		if (prog->trace && prog->num_trace < prog->max_trace)
+		{
+			prog->trace[prog->num_trace].reg = op->reg;
+			prog->trace[prog->num_trace].val = val;
+			prog->num_trace++;
+		}
+	}
+
+	prog->num_ops = 0;
+	prog->batch = 0;
+}
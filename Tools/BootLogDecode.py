@@ -0,0 +1,381 @@
+#!/usr/bin/env python3
+#
+# Decode a copy of the persistent boot log (Include/Guid/BootLog.h).
+#
+# Text records are printed as they are. Binary records, written by modules
+# built with PcdDebugBinaryLog, only hold the address of their format string
+# and the raw argument words; the format string is looked up in the module's
+# .debug file from the build output and formatted here.
+#
+# Get the log from a running system by copying PcdBootLogSize bytes at
+# PcdBootLogBase (or at the address of the boot log configuration table),
+# for example from Linux:
+#   dd if=/dev/mem of=bootlog.bin bs=4096 skip=$((0xdfb40000 / 4096)) count=64
+# then:
+#   BootLogDecode.py bootlog.bin -d Build/NintendoSwitch-AARCH64/DEBUG_GCC5/AARCH64
+#
+
+import argparse
+import os
+import struct
+import sys
+
+BOOT_LOG_SIGNATURE = 0x676f6c62  # 'blog'
+BOOT_LOG_VERSION = 3
+
+HEADER = struct.Struct('<IIIIQIIIIIIQQII')
+RECORD = struct.Struct('<HHBBHIIIQI')
+BINARY = struct.Struct('<QII')
+MODULE = struct.Struct('<16sQ')
+
+TYPE_TEXT = 0
+TYPE_BINARY = 1
+TYPE_MODULE = 2
+
+# Anchor symbol recorded in BOOT_LOG_MODULE
+ANCHOR_SYMBOL = 'gEfiCallerIdGuid'
+
+EFI_ERRORS = [
+    'Success', 'Load Error', 'Invalid Parameter', 'Unsupported',
+    'Bad Buffer Size', 'Buffer Too Small', 'Not Ready', 'Device Error',
+    'Write Protected', 'Out of Resources', 'Volume Corrupt', 'Volume Full',
+    'No Media', 'Media changed', 'Not Found', 'Access Denied',
+    'No Response', 'No mapping', 'Time out', 'Not started',
+    'Already started', 'Aborted', 'ICMP Error', 'TFTP Error',
+    'Protocol Error', 'Incompatible Version', 'Security Violation',
+    'CRC Error', 'End of Media', 'Reserved (29)', 'Reserved (30)',
+    'End of File', 'Invalid Language', 'Compromised Data',
+]
+
+EFI_WARNINGS = [
+    'Success', 'Warning Unknown Glyph', 'Warning Delete Failure',
+    'Warning Write Failure', 'Warning Buffer Too Small',
+    'Warning Stale Data',
+]
+
+
+class DebugImage:
+    """Allocated sections and symbols of an ELF64 .debug file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 2:
+            raise ValueError('%s is not an ELF64 file' % path)
+
+        shoff, = struct.unpack_from('<Q', self.data, 0x28)
+        shentsize, shnum = struct.unpack_from('<HH', self.data, 0x3a)
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset, size, link, info, align,
+             entsize) = struct.unpack_from('<IIQQQQIIQQ', self.data, shoff + i * shentsize)
+            self.sections.append((stype, flags, addr, offset, size, link))
+
+    def symbol(self, wanted):
+        for stype, flags, addr, offset, size, link in self.sections:
+            if stype != 2:  # SHT_SYMTAB
+                continue
+            strtab = self.sections[link]
+            for pos in range(offset, offset + size, 24):
+                name, info, other, shndx, value, symsize = struct.unpack_from('<IBBHQQ', self.data, pos)
+                start = strtab[3] + name
+                end = self.data.index(b'\0', start)
+                if self.data[start:end].decode('ascii', 'replace') == wanted:
+                    return value
+        return None
+
+    def string(self, address):
+        for stype, flags, addr, offset, size, link in self.sections:
+            # Allocated sections with file contents
+            if (flags & 2) and stype != 8 and addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b'\0', start)
+                return self.data[start:end].decode('ascii', 'replace')
+        return None
+
+
+class Module:
+    def __init__(self, name, guid, anchor, search):
+        self.name = name
+        self.guid = guid
+        self.image = None
+        self.bias = 0
+
+        path = search.get(name + '.debug')
+        if path is None:
+            return
+        try:
+            image = DebugImage(path)
+        except (OSError, ValueError) as e:
+            sys.stderr.write('%s\n' % e)
+            return
+        value = image.symbol(ANCHOR_SYMBOL)
+        if value is None:
+            sys.stderr.write('%s: no %s symbol\n' % (path, ANCHOR_SYMBOL))
+            return
+        self.image = image
+        self.bias = anchor - value
+
+    def format_string(self, address):
+        if self.image is None:
+            return None
+        return self.image.string(address - self.bias)
+
+
+def format_guid(raw):
+    a, b, c = struct.unpack_from('<IHH', raw)
+    return '%08x-%04x-%04x-%s-%s' % (a, b, c, raw[8:10].hex(), raw[10:16].hex())
+
+
+def format_status(value):
+    if value & (1 << 63):
+        code = value & ~(1 << 63)
+        if code < len(EFI_ERRORS):
+            return EFI_ERRORS[code]
+    elif value < len(EFI_WARNINGS):
+        return EFI_WARNINGS[value]
+    return '%08X' % value
+
+
+class LogReader:
+    def __init__(self, data):
+        self.data = data
+        (self.signature, self.version, self.header_size, self.data_size,
+         self.frequency, self.boot_count, self.sequence, self.first,
+         self.next, self.used, self.module_count, self.base,
+         self.level_table, self.level_generation,
+         _) = HEADER.unpack_from(data, 0)
+
+    def valid(self):
+        return (self.signature == BOOT_LOG_SIGNATURE and
+                self.version == BOOT_LOG_VERSION and
+                self.header_size == HEADER.size)
+
+    def record(self, offset):
+        return RECORD.unpack_from(self.data, self.header_size + offset)
+
+    def payload(self, offset, length):
+        start = self.header_size + offset + RECORD.size
+        return self.data[start:start + length]
+
+    def next_offset(self, offset):
+        length = self.record(offset)[0]
+        if length == 0 or offset + length + RECORD.size > self.data_size:
+            return 0
+        return offset + length
+
+    def records(self):
+        if not self.used:
+            return
+        offset = self.first
+        while True:
+            yield offset, self.record(offset)
+            offset = self.next_offset(offset)
+            if offset == self.next:
+                break
+
+    def pointer(self, address, size=None):
+        """Data copied into the log for a pointer argument, or None."""
+        if address == 0:
+            return None
+        start = address - self.base
+        if start < 0 or start >= len(self.data):
+            return None
+        if size is not None:
+            return self.data[start:start + size]
+        return self.data[start:]
+
+
+def c_string(raw, unicode=False):
+    if raw is None:
+        return None
+    if unicode:
+        chars = []
+        for i in range(0, len(raw) - 1, 2):
+            ch, = struct.unpack_from('<H', raw, i)
+            if ch == 0:
+                break
+            chars.append(chr(ch))
+        return ''.join(chars)
+    return raw.split(b'\0', 1)[0].decode('ascii', 'replace')
+
+
+def edk2_format(fmt, args, log):
+    """Format like PrintLib does with a BASE_LIST of UINT64 words."""
+    out = []
+    args = list(args)
+    i = 0
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    while i < len(fmt):
+        ch = fmt[i]
+        i += 1
+        if ch != '%':
+            out.append(ch)
+            continue
+
+        left = plus = space = comma = zero = long_type = False
+        width = 0
+        precision = None
+        in_precision = False
+        conv = None
+        while i < len(fmt):
+            c = fmt[i]
+            i += 1
+            if c == '-':
+                left = True
+            elif c == '+':
+                plus = True
+            elif c == ' ':
+                space = True
+            elif c == ',':
+                comma = True
+            elif c == '.':
+                in_precision = True
+                precision = 0
+            elif c in 'lL':
+                long_type = True
+            elif c == '*':
+                if in_precision:
+                    precision = next_arg()
+                else:
+                    width = next_arg()
+            elif c.isdigit():
+                if c == '0' and not in_precision and width == 0:
+                    zero = True
+                elif in_precision:
+                    precision = precision * 10 + int(c)
+                else:
+                    width = width * 10 + int(c)
+            else:
+                conv = c
+                break
+
+        if conv is None:
+            break
+
+        text = None
+        if conv in 'diuxXp':
+            value = next_arg()
+            if conv == 'p':
+                long_type = True
+                zero = True
+                width = 16
+                conv = 'X'
+            if not long_type:
+                value &= 0xffffffff
+            if conv in 'xX':
+                text = ('%X' if conv == 'X' else '%x') % value
+                comma = False
+            else:
+                bits = 64 if long_type else 32
+                if conv in 'di' and value & (1 << (bits - 1)):
+                    value -= 1 << bits
+                text = '{:,}'.format(value) if comma else str(value)
+                if value >= 0 and plus:
+                    text = '+' + text
+                elif value >= 0 and space:
+                    text = ' ' + text
+            if precision is not None and len(text.lstrip('-+ ')) < precision:
+                sign = text[0] if text[0] in '-+ ' else ''
+                text = sign + text.lstrip('-+ ').rjust(precision, '0')
+            if zero and not left and len(text) < width:
+                sign = text[0] if text[0] in '-+ ' else ''
+                text = sign + text[len(sign):].rjust(width - len(sign), '0')
+        elif conv == 'c':
+            text = chr(next_arg() & 0xffff)
+        elif conv == 'r':
+            text = format_status(next_arg())
+        elif conv == 'a' or conv in 'sS':
+            text = c_string(log.pointer(next_arg()), unicode=(conv != 'a'))
+            if text is None:
+                text = '<null string>'
+            if precision is not None:
+                text = text[:precision]
+        elif conv == 'g':
+            raw = log.pointer(next_arg(), 16)
+            text = format_guid(raw) if raw is not None and len(raw) == 16 else '<null guid>'
+        elif conv == 't':
+            raw = log.pointer(next_arg(), 16)
+            if raw is not None and len(raw) == 16:
+                year, month, day, hour, minute = struct.unpack_from('<HBBBB', raw)
+                text = '%02d/%02d/%04d  %02d:%02d' % (month, day, year, hour, minute)
+            else:
+                text = '<null time>'
+        else:
+            # %% and unknown conversions print the character itself
+            text = conv
+
+        if len(text) < width:
+            text = text.ljust(width) if left else text.rjust(width)
+        out.append(text)
+
+    return ''.join(out)
+
+
+def find_debug_files(directories):
+    found = {}
+    for directory in directories:
+        for root, dirs, files in os.walk(directory):
+            for name in files:
+                if name.endswith('.debug'):
+                    found.setdefault(name, os.path.join(root, name))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a persistent boot log dump.')
+    parser.add_argument('log', help='raw copy of the boot log carveout')
+    parser.add_argument('-d', '--debug-dir', action='append', default=[],
+                        help='build output directory to search for <Module>.debug files')
+    parser.add_argument('-a', '--all', action='store_true',
+                        help='print every boot in the log, not only the last one')
+    options = parser.parse_args()
+
+    with open(options.log, 'rb') as f:
+        log = LogReader(f.read())
+    if not log.valid():
+        sys.exit('%s: not a version %d boot log' % (options.log, BOOT_LOG_VERSION))
+
+    search = find_debug_files(options.debug_dir)
+    frequency = log.frequency or 1
+    modules = {}
+
+    for offset, record in log.records():
+        (length, payload_length, rtype, reserved, module, level, boot,
+         sequence, timestamp, reserved2) = record
+        if length == 0:
+            continue
+        payload = log.payload(offset, payload_length)
+
+        if rtype == TYPE_MODULE:
+            guid, anchor = MODULE.unpack_from(payload)
+            name = c_string(payload[MODULE.size:])
+            modules[(boot, module)] = Module(name, format_guid(guid), anchor, search)
+            continue
+
+        if not options.all and boot != log.boot_count:
+            continue
+
+        if rtype == TYPE_BINARY:
+            fmt_address, count, _ = BINARY.unpack_from(payload)
+            words = struct.unpack_from('<%dQ' % count, payload, BINARY.size)
+            owner = modules.get((boot, module))
+            fmt = owner.format_string(fmt_address) if owner else None
+            if fmt is None:
+                text = '<%s: format 0x%x, arguments %s>\n' % (
+                    owner.name if owner else 'unknown module', fmt_address,
+                    ' '.join('0x%x' % w for w in words))
+            else:
+                text = edk2_format(fmt, words, log)
+        else:
+            text = payload.decode('ascii', 'replace')
+
+        seconds, remainder = divmod(timestamp, frequency)
+        sys.stdout.write('[%u %u.%06u] %s' % (boot, seconds, remainder * 1000000 // frequency, text))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# Convert a BMP into the native boot splash (Include/Guid/Splash.h).
+#
+# The image is centered on the portrait scanout buffer and stored as the
+# full scanout lines it covers, in the framebuffer's BGRA layout, so the
+# firmware shows it with a single copy. With --landscape the image is
+# turned to read upright in the landscape GOP mode, the way SimpleFbDxe
+# rotates it: landscape (x, y) is portrait (y, landscape width - 1 - x).
+#
+#   SplashConvert.py logo.bmp -o Splash.bin --landscape --lz4
+#
+
+import argparse
+import struct
+import sys
+
+SPLASH_SIGNATURE = 0x736c7073  # 'spls'
+SPLASH_VERSION = 1
+SPLASH_FLAG_LZ4 = 1
+
+HEADER = struct.Struct('<8I')
+
+
+def read_bmp(path):
+    """Rows of (b, g, r) tuples, top line first."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:2] != b'BM':
+        raise ValueError('%s is not a BMP file' % path)
+
+    offset, = struct.unpack_from('<I', data, 10)
+    width, height, planes, bpp, compression = struct.unpack_from('<iiHHI', data, 18)
+    if bpp not in (24, 32) or compression not in (0, 3):
+        raise ValueError('%s: only uncompressed 24 and 32 bit BMPs are supported' % path)
+
+    top_down = height < 0
+    height = abs(height)
+    stride = (width * bpp // 8 + 3) & ~3
+    step = bpp // 8
+
+    rows = []
+    for y in range(height):
+        start = offset + y * stride
+        rows.append([tuple(data[start + x * step:start + x * step + 3]) for x in range(width)])
+    if not top_down:
+        rows.reverse()
+    return rows
+
+
+def rotate_for_landscape(rows):
+    """Turn a landscape image so it lands upright in portrait memory."""
+    height = len(rows)
+    width = len(rows[0])
+    # Portrait line p holds landscape column (width - 1 - p), top to bottom
+    return [[rows[y][width - 1 - p] for y in range(height)] for p in range(width)]
+
+
+def lz4_compress(data):
+    """Greedy LZ4 block compressor, good enough for mostly flat artwork."""
+    out = bytearray()
+    table = {}
+    n = len(data)
+    anchor = 0
+    i = 0
+
+    def length(value):
+        while value >= 255:
+            out.append(255)
+            value -= 255
+        out.append(value)
+
+    def sequence(literals_end, offset=None, match=0):
+        literals = literals_end - anchor
+        token = min(literals, 15) << 4
+        if offset is not None:
+            token |= min(match - 4, 15)
+        out.append(token)
+        if literals >= 15:
+            length(literals - 15)
+        out.extend(data[anchor:literals_end])
+        if offset is not None:
+            out.extend(struct.pack('<H', offset))
+            if match - 4 >= 15:
+                length(match - 19)
+
+    # The format wants the last 5 bytes as literals and no match starting
+    # in the last 12
+    while i < n - 12:
+        key = data[i:i + 4]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > 0xffff:
+            i += 1
+            continue
+
+        match = 4
+        while i + match < n - 5 and data[candidate + match] == data[i + match]:
+            match += 1
+        sequence(i, i - candidate, match)
+        i += match
+        anchor = i
+
+    sequence(n)
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a BMP into the native boot splash.')
+    parser.add_argument('image', help='24 or 32 bit uncompressed BMP')
+    parser.add_argument('-o', '--output', required=True, help='splash file for the FV')
+    parser.add_argument('--width', type=int, default=768, help='scanout width (PcdMipiFrameBufferWidth)')
+    parser.add_argument('--height', type=int, default=1280, help='scanout height (PcdMipiFrameBufferHeight)')
+    parser.add_argument('--visible-width', type=int, default=720,
+                        help='scanout columns the panel shows (PcdMipiFrameBufferVisibleWidth)')
+    parser.add_argument('--landscape', action='store_true', help='artwork is meant for the landscape mode')
+    parser.add_argument('--lz4', action='store_true', help='compress the pixels')
+    options = parser.parse_args()
+
+    try:
+        rows = read_bmp(options.image)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+    if options.landscape:
+        rows = rotate_for_landscape(rows)
+
+    height = len(rows)
+    width = len(rows[0])
+    if width > options.visible_width or height > options.height:
+        sys.exit('%dx%d image does not fit the %dx%d screen' % (
+            width, height, options.visible_width, options.height))
+
+    left = (options.visible_width - width) // 2
+    first = (options.height - height) // 2
+    black = b'\0\0\0\0'
+
+    pixels = bytearray()
+    for row in rows:
+        pixels += black * left
+        for b, g, r in row:
+            pixels += bytes((b, g, r, 0))
+        pixels += black * (options.width - left - width)
+
+    flags = 0
+    if options.lz4:
+        pixels = lz4_compress(bytes(pixels))
+        flags |= SPLASH_FLAG_LZ4
+
+    with open(options.output, 'wb') as f:
+        f.write(HEADER.pack(SPLASH_SIGNATURE, SPLASH_VERSION, options.width, options.height,
+                            first, height, flags, len(pixels)))
+        f.write(pixels)
+
+
+if __name__ == '__main__':
+    main()
@@ -9,7 +9,8 @@
 Param
 (
     [switch] $Clean,
-    [switch] $UseNewerGcc
+    [switch] $UseNewerGcc,
+    [switch] $LandscapeSplash
 )
 
 Import-Module $PSScriptRoot/PsModules/redirector.psm1
@@ -94,10 +95,28 @@ if ($commit)
 	Set-Content -Path NintendoSwitchPkg/Include/FwReleaseInfo.h -Value $releaseInfoContent -ErrorAction SilentlyContinue -Force
 }
 
+# Convert the boot splash into the scanout format if one is provided.
+$buildDefines = @()
+if ($true -eq (Test-Path -Path "NintendoSwitchPkg/Resources/Splash.bmp"))
+{
+	Write-Output "Convert boot splash."
+	$splashArgs = @("NintendoSwitchPkg/Resources/Splash.bmp", "-o", "NintendoSwitchPkg/Resources/Splash.bin", "--lz4")
+	if ($true -eq $LandscapeSplash) { $splashArgs += "--landscape" }
+	python3 NintendoSwitchPkg/Tools/SplashConvert.py @splashArgs
+
+	if (-not $?)
+	{
+		Write-Error "Boot splash conversion failed."
+		return $?
+	}
+
+	$buildDefines += @("-D", "SPLASH_ENABLE=TRUE")
+}
+
 foreach ($target in $availableTargets)
 {
 	Write-Output "Build NintendoSwitchPkg for $($target) (DEBUG)."
-	build -a AARCH64 -p NintendoSwitchPkg/$($target).dsc -t GCC5
+	build -a AARCH64 -p NintendoSwitchPkg/$($target).dsc -t GCC5 @buildDefines
 
 	if (-not $?)
 	{
@@ -0,0 +1,180 @@
+/*
+ * C transliteration of AArch64/BltKernels.S for hosts which cannot run it.
+ * Each kernel moves data in the same order and chunk sizes as the NEON one
+ * (64 byte blocks loaded in full before they are stored, 4x4 tiles, four
+ * pixel groups), so overlap and tail handling behave the same. Calls the
+ * NEON kernels cannot take, such as a Count which is not a multiple of 4 or
+ * a copy direction that smears an overlap, are counted as violations.
+ */
+#include <string.h>
+
+#include <Uefi.h>
+
+#include "BltKernels.h"
+
+BLT_KERNEL_CALLS mBltKernelCalls;
+
+VOID
+BltFill32(
+    OUT VOID        *Destination,
+    IN  UINTN       Count,
+    IN  UINT32      Color
+)
+{
+    UINT32 *Pixel = Destination;
+    UINTN Index;
+
+    for (; Count >= 16; Count -= 16, Pixel += 16)
+    {
+        for (Index = 0; Index < 16; Index++)
+        {
+            Pixel[Index] = Color;
+        }
+    }
+
+    for (; Count != 0; Count--)
+    {
+        *Pixel++ = Color;
+    }
+}
+
+VOID
+BltCopyForward(
+    OUT VOID        *Destination,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Length
+)
+{
+    UINT8 *Dst = Destination;
+    CONST UINT8 *Src = Source;
+    UINT8 Block[64];
+
+    mBltKernelCalls.CopyForward++;
+    if ((Length & 3) || (Dst > Src && Dst < Src + Length))
+    {
+        mBltKernelCalls.Violations++;
+    }
+
+    for (; Length >= 64; Length -= 64, Src += 64, Dst += 64)
+    {
+        memcpy(Block, Src, 64);
+        memcpy(Dst, Block, 64);
+    }
+
+    for (; Length >= 4; Length -= 4, Src += 4, Dst += 4)
+    {
+        memcpy(Block, Src, 4);
+        memcpy(Dst, Block, 4);
+    }
+}
+
+VOID
+BltCopyBackward(
+    OUT VOID        *Destination,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Length
+)
+{
+    UINT8 *Dst = (UINT8 *)Destination + Length;
+    CONST UINT8 *Src = (CONST UINT8 *)Source + Length;
+    UINT8 Block[64];
+
+    mBltKernelCalls.CopyBackward++;
+    if ((Length & 3) ||
+        ((UINT8 *)Destination < (CONST UINT8 *)Source && Dst > (CONST UINT8 *)Source))
+    {
+        mBltKernelCalls.Violations++;
+    }
+
+    for (; Length >= 64; Length -= 64)
+    {
+        Src -= 64;
+        Dst -= 64;
+        memcpy(Block, Src, 64);
+        memcpy(Dst, Block, 64);
+    }
+
+    for (; Length >= 4; Length -= 4)
+    {
+        Src -= 4;
+        Dst -= 4;
+        memcpy(Block, Src, 4);
+        memcpy(Dst, Block, 4);
+    }
+}
+
+VOID
+BltTransposeStrip(
+    OUT VOID        *Destination,
+    IN  INTN        DestinationStride,
+    IN  CONST VOID  *Source,
+    IN  INTN        SourceStride,
+    IN  UINTN       Count
+)
+{
+    UINT8 *Dst = Destination;
+    CONST UINT8 *Src = Source;
+    UINT32 Tile[4][4];
+    UINTN Line, Column;
+
+    mBltKernelCalls.TransposeStrip++;
+    if (Count & 3)
+    {
+        mBltKernelCalls.Violations++;
+        return;
+    }
+
+    for (; Count != 0; Count -= 4)
+    {
+        for (Line = 0; Line < 4; Line++)
+        {
+            memcpy(Tile[Line], Src + (INTN)Line * SourceStride, 16);
+        }
+
+        for (Column = 0; Column < 4; Column++)
+        {
+            for (Line = 0; Line < 4; Line++)
+            {
+                memcpy(Dst + (INTN)Column * DestinationStride + Line * 4, &Tile[Line][Column], 4);
+            }
+        }
+
+        Src += 16;
+        Dst += 4 * DestinationStride;
+    }
+}
+
+VOID
+BltScale2xLine(
+    OUT VOID        *Destination,
+    IN  UINTN       DestinationStride,
+    IN  CONST VOID  *Source,
+    IN  UINTN       Count
+)
+{
+    UINT8 *Dst = Destination;
+    CONST UINT8 *Src = Source;
+    UINT32 In[4], Out[8];
+    UINTN Index;
+
+    mBltKernelCalls.Scale2xLine++;
+    if (Count & 3)
+    {
+        mBltKernelCalls.Violations++;
+        return;
+    }
+
+    for (; Count != 0; Count -= 4)
+    {
+        memcpy(In, Src, 16);
+        for (Index = 0; Index < 8; Index++)
+        {
+            Out[Index] = In[Index / 2];
+        }
+        memcpy(Dst, Out, 32);
+        memcpy(Dst + DestinationStride, Out, 32);
+
+        Src += 16;
+        Dst += 32;
+    }
+}
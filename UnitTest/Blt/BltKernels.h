@@ -0,0 +1,20 @@
+/*
+ * Bookkeeping of the C kernels (BltKernels.c), which stand in for
+ * AArch64/BltKernels.S on other hosts.
+ */
+#ifndef __BLT_KERNELS_MODEL_H__
+#define __BLT_KERNELS_MODEL_H__
+
+#include <Uefi.h>
+
+typedef struct {
+	UINTN CopyForward;
+	UINTN CopyBackward;
+	UINTN TransposeStrip;
+	UINTN Scale2xLine;
+	UINTN Violations;			// Calls outside what the NEON kernel handles
+} BLT_KERNEL_CALLS;
+
+extern BLT_KERNEL_CALLS mBltKernelCalls;
+
+#endif
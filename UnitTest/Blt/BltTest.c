@@ -0,0 +1,699 @@
+/*
+ * Host harness for the SimpleFbDxe Blt engine (Blt.c and its kernels).
+ *
+ * Correctness: every primitive is compared with a per-pixel reference on
+ * surfaces surrounded by guard bytes, which catches tail overruns. Fill
+ * covers every tail length, copy covers forward and backward overlap with
+ * the edges of the overlap test, transpose covers negative strides and
+ * ragged blocks, and scale covers odd widths. The four GOP Blt operations
+ * are then run the way DisplayBlt and DisplayBltLandscape call the engine,
+ * against a model of the logical screen.
+ *
+ * Throughput: "BltTest throughput" times the four operations on a full
+ * 768x1280 screen. Figures from the C kernels only compare runs on the same
+ * host; the NEON numbers come from an AArch64 host.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+
+#include "../../Drivers/SimpleFbDxe/Include/Blt.h"
+
+#include <HostTest.h>
+
+#ifdef BLT_KERNEL_MODEL
+#include "BltKernels.h"
+#endif
+
+#define GUARD_BYTES		256
+#define GUARD_BYTE		0xa5
+
+typedef enum {
+	EfiBltVideoFill,
+	EfiBltVideoToBltBuffer,
+	EfiBltBufferToVideo,
+	EfiBltVideoToVideo,
+	EfiGraphicsOutputBltOperationMax
+} EFI_GRAPHICS_OUTPUT_BLT_OPERATION;
+
+/* Lines of Stride bytes, Base is line 0 and GUARD_BYTES before/after */
+typedef struct {
+	UINT8 *Memory;
+	UINT8 *Base;
+	UINTN Stride;
+	UINTN Lines;
+} SURFACE;
+
+STATIC UINT32 mSeed = 0x12345678;
+
+STATIC UINT32 Random(VOID)
+{
+	mSeed ^= mSeed << 13;
+	mSeed ^= mSeed >> 17;
+	mSeed ^= mSeed << 5;
+	return mSeed;
+}
+
+/* Position up to 2 away from Position, within [0, Limit] */
+STATIC UINTN Nearby(UINTN Position, UINTN Limit)
+{
+	INTN Moved = (INTN)Position + (INTN)(Random() % 5) - 2;
+
+	return Moved < 0 ? 0 : MIN((UINTN)Moved, Limit);
+}
+
+STATIC VOID SurfaceInit(SURFACE *Surface, UINTN Stride, UINTN Lines)
+{
+	UINTN Size = Stride * Lines + 2 * GUARD_BYTES;
+	UINTN Index;
+
+	Surface->Memory = malloc(Size);
+	Surface->Base = Surface->Memory + GUARD_BYTES;
+	Surface->Stride = Stride;
+	Surface->Lines = Lines;
+
+	memset(Surface->Memory, GUARD_BYTE, Size);
+	for (Index = 0; Index < Stride * Lines; Index++)
+		Surface->Base[Index] = (UINT8)Random();
+}
+
+STATIC VOID SurfaceFree(SURFACE *Surface)
+{
+	free(Surface->Memory);
+}
+
+STATIC UINT32 *Pixel(SURFACE *Surface, UINTN X, UINTN Y)
+{
+	return (UINT32 *)(Surface->Base + Y * Surface->Stride + X * BLT_BYTES_PER_PIXEL);
+}
+
+STATIC BOOLEAN GuardsIntact(SURFACE *Surface)
+{
+	UINT8 *End = Surface->Base + Surface->Stride * Surface->Lines;
+	UINTN Index;
+
+	for (Index = 0; Index < GUARD_BYTES; Index++)
+		if (Surface->Memory[Index] != GUARD_BYTE || End[Index] != GUARD_BYTE)
+			return FALSE;
+	return TRUE;
+}
+
+STATIC UINT8 *Snapshot(SURFACE *Surface)
+{
+	UINT8 *Copy = malloc(Surface->Stride * Surface->Lines);
+
+	memcpy(Copy, Surface->Base, Surface->Stride * Surface->Lines);
+	return Copy;
+}
+
+STATIC VOID TestFill(VOID)
+{
+	UINTN Width, Height, Pad;
+
+	for (Pad = 0; Pad <= 3; Pad += 3)
+	{
+		for (Width = 1; Width <= 40; Width++)
+		{
+			for (Height = 1; Height <= 3; Height++)
+			{
+				UINTN X = Pad ? 1 : 0;
+				SURFACE Surface;
+				UINT8 *Before;
+				UINTN PixelX, Y;
+				BOOLEAN Match = TRUE;
+
+				// Pad 0 makes the rectangle as wide as the stride: one run
+				SurfaceInit(&Surface, (Width + Pad) * BLT_BYTES_PER_PIXEL, Height + 2);
+				Before = Snapshot(&Surface);
+
+				BltFill((UINT8 *)Pixel(&Surface, X, 1), Surface.Stride, Width, Height, 0xff102030);
+
+				for (Y = 0; Y < Surface.Lines; Y++)
+				{
+					for (PixelX = 0; PixelX < Width + Pad; PixelX++)
+					{
+						BOOLEAN Inside = PixelX >= X && PixelX < X + Width && Y >= 1 && Y <= Height;
+						UINT32 Expected = Inside ? 0xff102030 :
+							((UINT32 *)(Before + Y * Surface.Stride))[PixelX];
+
+						Match &= *Pixel(&Surface, PixelX, Y) == Expected;
+					}
+				}
+
+				CHECK(Match);
+				CHECK(GuardsIntact(&Surface));
+				free(Before);
+				SurfaceFree(&Surface);
+			}
+		}
+	}
+}
+
+/*
+ * Copy a rectangle within one surface and compare with copying from a
+ * snapshot, i.e. memmove semantics for the whole rectangle.
+ */
+STATIC BOOLEAN CopyOverlapped(UINTN SurfaceWidth, UINTN SourceX, UINTN SourceY,
+	UINTN DestinationX, UINTN DestinationY, UINTN Width, UINTN Height)
+{
+	SURFACE Surface;
+	UINT8 *Before;
+	UINTN X, Y;
+	BOOLEAN Match = TRUE;
+
+	SurfaceInit(&Surface, SurfaceWidth * BLT_BYTES_PER_PIXEL, 24);
+	Before = Snapshot(&Surface);
+
+	BltCopy(
+		(UINT8 *)Pixel(&Surface, DestinationX, DestinationY), Surface.Stride,
+		(UINT8 *)Pixel(&Surface, SourceX, SourceY), Surface.Stride,
+		Width, Height
+	);
+
+	for (Y = 0; Y < Surface.Lines; Y++)
+	{
+		for (X = 0; X < SurfaceWidth; X++)
+		{
+			UINT32 Expected = ((UINT32 *)(Before + Y * Surface.Stride))[X];
+
+			if (X >= DestinationX && X < DestinationX + Width &&
+				Y >= DestinationY && Y < DestinationY + Height)
+			{
+				Expected = ((UINT32 *)(Before + (Y - DestinationY + SourceY) * Surface.Stride))
+					[X - DestinationX + SourceX];
+			}
+
+			Match &= *Pixel(&Surface, X, Y) == Expected;
+		}
+	}
+
+	Match &= GuardsIntact(&Surface);
+	free(Before);
+	SurfaceFree(&Surface);
+	return Match;
+}
+
+STATIC VOID TestCopy(VOID)
+{
+	UINTN Width, Height;
+	INTN Dx, Dy;
+
+	// Separate surfaces with different strides, like BltBuffer and video.
+	for (Width = 1; Width <= 40; Width++)
+	{
+		for (Height = 1; Height <= 3; Height++)
+		{
+			SURFACE Source, Destination;
+			UINT8 *Before;
+			UINTN X, Y;
+			BOOLEAN Match = TRUE;
+
+			SurfaceInit(&Source, (Width + 5) * BLT_BYTES_PER_PIXEL, Height + 2);
+			SurfaceInit(&Destination, (Width + 2) * BLT_BYTES_PER_PIXEL, Height + 2);
+			Before = Snapshot(&Destination);
+
+			BltCopy((UINT8 *)Pixel(&Destination, 1, 1), Destination.Stride,
+				(UINT8 *)Pixel(&Source, 3, 1), Source.Stride, Width, Height);
+
+			for (Y = 0; Y < Destination.Lines; Y++)
+			{
+				for (X = 0; X < Width + 2; X++)
+				{
+					BOOLEAN Inside = X >= 1 && X <= Width && Y >= 1 && Y <= Height;
+					UINT32 Expected = Inside ? *Pixel(&Source, X + 2, Y) :
+						((UINT32 *)(Before + Y * Destination.Stride))[X];
+
+					Match &= *Pixel(&Destination, X, Y) == Expected;
+				}
+			}
+
+			CHECK(Match);
+			CHECK(GuardsIntact(&Destination));
+			free(Before);
+			SurfaceFree(&Source);
+			SurfaceFree(&Destination);
+		}
+	}
+
+	// Overlap in every direction, rows long enough for the 64 byte blocks.
+	for (Dy = -3; Dy <= 3; Dy++)
+	{
+		for (Dx = -19; Dx <= 19; Dx++)
+		{
+			CHECK(CopyOverlapped(64, 20, 8, 20 + Dx, 8 + Dy, 23, 5));
+			CHECK(CopyOverlapped(64, 20, 8, 20 + Dx, 8 + Dy, 3, 2));
+		}
+	}
+
+	// Full-width rows are merged into one run, which overlaps as a whole.
+	for (Dy = -5; Dy <= 5; Dy++)
+	{
+		CHECK(CopyOverlapped(17, 0, 8, 0, 8 + Dy, 17, 7));
+	}
+
+#ifdef BLT_KERNEL_MODEL
+	/*
+	 * Edges of Destination > Source && Destination < Source +
+	 * (Height - 1) * SourceStride + RowBytes: a destination starting on the
+	 * last source pixel goes backward, one just past it forward.
+	 */
+	mBltKernelCalls.CopyBackward = mBltKernelCalls.CopyForward = 0;
+	CHECK(CopyOverlapped(64, 10, 4, 10 + 7, 4 + 4, 8, 5));
+	CHECK_EQ(mBltKernelCalls.CopyBackward, 5);
+	CHECK_EQ(mBltKernelCalls.CopyForward, 0);
+
+	mBltKernelCalls.CopyBackward = mBltKernelCalls.CopyForward = 0;
+	CHECK(CopyOverlapped(64, 10, 4, 10 + 8, 4 + 4, 8, 5));
+	CHECK_EQ(mBltKernelCalls.CopyBackward, 0);
+	CHECK_EQ(mBltKernelCalls.CopyForward, 5);
+
+	// Same row, shifted right by one pixel: one backward run.
+	mBltKernelCalls.CopyBackward = mBltKernelCalls.CopyForward = 0;
+	CHECK(CopyOverlapped(64, 10, 4, 11, 4, 30, 1));
+	CHECK_EQ(mBltKernelCalls.CopyBackward, 1);
+
+	// Destination above the source (scrolling up) stays forward.
+	mBltKernelCalls.CopyBackward = mBltKernelCalls.CopyForward = 0;
+	CHECK(CopyOverlapped(64, 10, 6, 10, 4, 30, 10));
+	CHECK_EQ(mBltKernelCalls.CopyBackward, 0);
+#endif
+}
+
+/* Transpose with each stride sign; a negative one starts at the last line. */
+STATIC VOID TestTranspose(VOID)
+{
+	STATIC CONST UINTN Sizes[] = { 1, 3, 4, 5, 7, 8, 63, 64, 65, 70, 131 };
+	UINTN WidthIndex, HeightIndex, Signs;
+
+	for (WidthIndex = 0; WidthIndex < ARRAY_SIZE(Sizes); WidthIndex++)
+	{
+		for (HeightIndex = 0; HeightIndex < ARRAY_SIZE(Sizes); HeightIndex++)
+		{
+			for (Signs = 0; Signs < 4; Signs++)
+			{
+				UINTN Width = Sizes[WidthIndex];
+				UINTN Height = Sizes[HeightIndex];
+				BOOLEAN FlipSource = Signs & 1;
+				BOOLEAN FlipDestination = Signs & 2;
+				SURFACE Source, Destination;
+				UINT8 *Before;
+				UINTN X, Y;
+				BOOLEAN Match = TRUE;
+
+				SurfaceInit(&Source, (Width + 1) * BLT_BYTES_PER_PIXEL, Height);
+				SurfaceInit(&Destination, (Height + 2) * BLT_BYTES_PER_PIXEL, Width);
+				Before = Snapshot(&Destination);
+
+				BltTranspose(
+					(UINT8 *)Pixel(&Destination, 1, FlipDestination ? Width - 1 : 0),
+					FlipDestination ? -(INTN)Destination.Stride : (INTN)Destination.Stride,
+					(UINT8 *)Pixel(&Source, 0, FlipSource ? Height - 1 : 0),
+					FlipSource ? -(INTN)Source.Stride : (INTN)Source.Stride,
+					Width, Height
+				);
+
+				// Destination line X, pixel Y is source line Y, pixel X.
+				for (X = 0; X < Width; X++)
+				{
+					UINTN Line = FlipDestination ? Width - 1 - X : X;
+
+					for (Y = 0; Y < Height + 2; Y++)
+					{
+						UINT32 Expected = ((UINT32 *)(Before + Line * Destination.Stride))[Y];
+
+						if (Y >= 1 && Y <= Height)
+							Expected = *Pixel(&Source, X, FlipSource ? Height - Y : Y - 1);
+
+						Match &= *Pixel(&Destination, Y, Line) == Expected;
+					}
+				}
+
+				CHECK(Match);
+				CHECK(GuardsIntact(&Destination));
+				free(Before);
+				SurfaceFree(&Source);
+				SurfaceFree(&Destination);
+			}
+		}
+	}
+}
+
+STATIC VOID TestScale2x(VOID)
+{
+	UINTN Width, Height;
+
+	for (Width = 1; Width <= 40; Width++)
+	{
+		for (Height = 1; Height <= 3; Height++)
+		{
+			SURFACE Source, Destination;
+			UINT8 *Before;
+			UINTN X, Y;
+			BOOLEAN Match = TRUE;
+
+			SurfaceInit(&Source, (Width + 3) * BLT_BYTES_PER_PIXEL, Height);
+			SurfaceInit(&Destination, (2 * Width + 2) * BLT_BYTES_PER_PIXEL, 2 * Height + 2);
+			Before = Snapshot(&Destination);
+
+			BltScale2x((UINT8 *)Pixel(&Destination, 1, 1), Destination.Stride,
+				(UINT8 *)Pixel(&Source, 2, 0), Source.Stride, Width, Height);
+
+			for (Y = 0; Y < Destination.Lines; Y++)
+			{
+				for (X = 0; X < 2 * Width + 2; X++)
+				{
+					BOOLEAN Inside = X >= 1 && X <= 2 * Width && Y >= 1 && Y <= 2 * Height;
+					UINT32 Expected = Inside ? *Pixel(&Source, 2 + (X - 1) / 2, (Y - 1) / 2) :
+						((UINT32 *)(Before + Y * Destination.Stride))[X];
+
+					Match &= *Pixel(&Destination, X, Y) == Expected;
+				}
+			}
+
+			CHECK(Match);
+			CHECK(GuardsIntact(&Destination));
+			free(Before);
+			SurfaceFree(&Source);
+			SurfaceFree(&Destination);
+		}
+	}
+}
+
+/*
+ * The screen as DisplayBlt sees it: a portrait surface, shown either as it
+ * is or turned into a landscape mode where landscape (X, Y) is portrait
+ * (Y, W - 1 - X).
+ */
+typedef struct {
+	SURFACE Portrait;
+	UINTN PortraitWidth;
+	BOOLEAN Landscape;
+} SCREEN;
+
+STATIC UINTN ScreenWidth(SCREEN *Screen)
+{
+	return Screen->Landscape ? Screen->Portrait.Lines : Screen->PortraitWidth;
+}
+
+STATIC UINTN ScreenHeight(SCREEN *Screen)
+{
+	return Screen->Landscape ? Screen->PortraitWidth : Screen->Portrait.Lines;
+}
+
+STATIC UINT32 *ScreenPixel(SCREEN *Screen, UINTN X, UINTN Y)
+{
+	if (Screen->Landscape)
+		return Pixel(&Screen->Portrait, Y, ScreenWidth(Screen) - 1 - X);
+	return Pixel(&Screen->Portrait, X, Y);
+}
+
+#define POS_TO_FB(posX, posY)	((UINT8 *)Pixel(&Screen->Portrait, (posX), (posY)))
+
+/* The engine calls of DisplayBlt and DisplayBltLandscape, unscaled modes */
+STATIC VOID ScreenBlt(SCREEN *Screen, UINT8 *BltBuf, EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
+	UINTN SourceX, UINTN SourceY, UINTN DestinationX, UINTN DestinationY,
+	UINTN Width, UINTN Height, UINTN Delta)
+{
+	INTN Stride = Screen->Portrait.Stride;
+
+	if (Delta == 0)
+		Delta = Width * BLT_BYTES_PER_PIXEL;
+
+	if (Screen->Landscape)
+	{
+		UINTN LandscapeWidth = ScreenWidth(Screen);
+		UINTN X = DestinationY;
+		UINTN Y = LandscapeWidth - DestinationX - Width;
+
+		switch (BltOperation) {
+		case EfiBltVideoFill:
+			BltFill(POS_TO_FB(X, Y), Stride, Height, Width, *(UINT32 *) BltBuf);
+			break;
+		case EfiBltVideoToBltBuffer:
+			BltTranspose(
+				BltBuf + DestinationY * Delta + DestinationX * BLT_BYTES_PER_PIXEL, Delta,
+				POS_TO_FB(SourceY, LandscapeWidth - 1 - SourceX), -Stride,
+				Height, Width
+			);
+			break;
+		case EfiBltBufferToVideo:
+			BltTranspose(
+				POS_TO_FB(X, LandscapeWidth - 1 - DestinationX), -Stride,
+				BltBuf + SourceY * Delta + SourceX * BLT_BYTES_PER_PIXEL, Delta,
+				Width, Height
+			);
+			break;
+		case EfiBltVideoToVideo:
+			BltCopy(
+				POS_TO_FB(X, Y), Stride,
+				POS_TO_FB(SourceY, LandscapeWidth - SourceX - Width), Stride,
+				Height, Width
+			);
+			break;
+		default:
+			break;
+		}
+		return;
+	}
+
+	switch (BltOperation) {
+	case EfiBltVideoFill:
+		BltFill(POS_TO_FB(DestinationX, DestinationY), Stride, Width, Height, *(UINT32 *) BltBuf);
+		break;
+	case EfiBltVideoToBltBuffer:
+		BltCopy(
+			BltBuf + DestinationY * Delta + DestinationX * BLT_BYTES_PER_PIXEL, Delta,
+			POS_TO_FB(SourceX, SourceY), Stride,
+			Width, Height
+		);
+		break;
+	case EfiBltBufferToVideo:
+		BltCopy(
+			POS_TO_FB(DestinationX, DestinationY), Stride,
+			BltBuf + SourceY * Delta + SourceX * BLT_BYTES_PER_PIXEL, Delta,
+			Width, Height
+		);
+		break;
+	case EfiBltVideoToVideo:
+		BltCopy(
+			POS_TO_FB(DestinationX, DestinationY), Stride,
+			POS_TO_FB(SourceX, SourceY), Stride,
+			Width, Height
+		);
+		break;
+	default:
+		break;
+	}
+}
+
+/* GOP semantics of one Blt on plain arrays of the logical screen and buffer */
+STATIC VOID ReferenceBlt(UINT32 *Video, UINTN VideoWidth, UINT32 *Buffer, UINTN BufferWidth,
+	EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation, UINTN SourceX, UINTN SourceY,
+	UINTN DestinationX, UINTN DestinationY, UINTN Width, UINTN Height)
+{
+	UINT32 *Copy = malloc(Width * Height * sizeof(UINT32));
+	UINTN X, Y;
+
+	for (Y = 0; Y < Height; Y++)
+	{
+		for (X = 0; X < Width; X++)
+		{
+			switch (BltOperation) {
+			case EfiBltVideoFill:
+				Copy[Y * Width + X] = Buffer[0];
+				break;
+			case EfiBltBufferToVideo:
+				Copy[Y * Width + X] = Buffer[(SourceY + Y) * BufferWidth + SourceX + X];
+				break;
+			default:
+				Copy[Y * Width + X] = Video[(SourceY + Y) * VideoWidth + SourceX + X];
+				break;
+			}
+		}
+	}
+
+	for (Y = 0; Y < Height; Y++)
+	{
+		for (X = 0; X < Width; X++)
+		{
+			if (BltOperation == EfiBltVideoToBltBuffer)
+				Buffer[(DestinationY + Y) * BufferWidth + DestinationX + X] = Copy[Y * Width + X];
+			else
+				Video[(DestinationY + Y) * VideoWidth + DestinationX + X] = Copy[Y * Width + X];
+		}
+	}
+
+	free(Copy);
+}
+
+STATIC VOID TestOperations(BOOLEAN Landscape)
+{
+	SCREEN Screen = { .PortraitWidth = 72, .Landscape = Landscape };
+	SURFACE Buffer;
+	UINT32 *Video, *BufferModel;
+	UINTN BufferWidth = 90, BufferHeight = 90;
+	UINTN Width, Height, X, Y, Step;
+
+	SurfaceInit(&Screen.Portrait, Screen.PortraitWidth * BLT_BYTES_PER_PIXEL, 136);
+	SurfaceInit(&Buffer, BufferWidth * BLT_BYTES_PER_PIXEL, BufferHeight);
+	Width = ScreenWidth(&Screen);
+	Height = ScreenHeight(&Screen);
+
+	Video = malloc(Width * Height * sizeof(UINT32));
+	BufferModel = malloc(BufferWidth * BufferHeight * sizeof(UINT32));
+	for (Y = 0; Y < Height; Y++)
+		for (X = 0; X < Width; X++)
+			Video[Y * Width + X] = *ScreenPixel(&Screen, X, Y);
+	memcpy(BufferModel, Buffer.Base, BufferWidth * BufferHeight * sizeof(UINT32));
+
+	for (Step = 0; Step < 3000; Step++)
+	{
+		EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation = Step % EfiGraphicsOutputBltOperationMax;
+		UINTN BltWidth = 1 + Random() % MIN(Width, BufferWidth);
+		UINTN BltHeight = 1 + Random() % MIN(Height, BufferHeight);
+		UINTN SourceLimitX = BltOperation == EfiBltBufferToVideo ? BufferWidth : Width;
+		UINTN SourceLimitY = BltOperation == EfiBltBufferToVideo ? BufferHeight : Height;
+		UINTN DestinationLimitX = BltOperation == EfiBltVideoToBltBuffer ? BufferWidth : Width;
+		UINTN DestinationLimitY = BltOperation == EfiBltVideoToBltBuffer ? BufferHeight : Height;
+		UINTN SourceX = Random() % (SourceLimitX - BltWidth + 1);
+		UINTN SourceY = Random() % (SourceLimitY - BltHeight + 1);
+		UINTN DestinationX = Random() % (DestinationLimitX - BltWidth + 1);
+		UINTN DestinationY = Random() % (DestinationLimitY - BltHeight + 1);
+		BOOLEAN Match = TRUE;
+
+		if (BltOperation == EfiBltVideoFill)
+		{
+			// The fill color is the first pixel of BltBuffer
+			SourceX = SourceY = 0;
+			BufferModel[0] = *Pixel(&Buffer, 0, 0) = Random();
+		}
+
+		// Mostly small moves, as in scrolling, so that the copies overlap.
+		if (BltOperation == EfiBltVideoToVideo && (Step & 8))
+		{
+			DestinationX = Nearby(SourceX, Width - BltWidth);
+			DestinationY = Nearby(SourceY, Height - BltHeight);
+		}
+
+		ScreenBlt(&Screen, Buffer.Base, BltOperation, SourceX, SourceY, DestinationX, DestinationY,
+			BltWidth, BltHeight, Buffer.Stride);
+		ReferenceBlt(Video, Width, BufferModel, BufferWidth, BltOperation, SourceX, SourceY,
+			DestinationX, DestinationY, BltWidth, BltHeight);
+
+		for (Y = 0; Y < Height; Y++)
+			for (X = 0; X < Width; X++)
+				Match &= *ScreenPixel(&Screen, X, Y) == Video[Y * Width + X];
+		Match &= memcmp(Buffer.Base, BufferModel, BufferWidth * BufferHeight * sizeof(UINT32)) == 0;
+
+		if (!Match)
+		{
+			fprintf(stderr, "%s operation %d (%lu,%lu)->(%lu,%lu) %lux%lu differs\n",
+				Landscape ? "landscape" : "portrait", BltOperation, SourceX, SourceY,
+				DestinationX, DestinationY, BltWidth, BltHeight);
+			mHostTestFailures++;
+			break;
+		}
+	}
+
+	CHECK(GuardsIntact(&Screen.Portrait));
+	CHECK(GuardsIntact(&Buffer));
+	free(Video);
+	free(BufferModel);
+	SurfaceFree(&Screen.Portrait);
+	SurfaceFree(&Buffer);
+}
+
+STATIC double Seconds(VOID)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return Now.tv_sec + Now.tv_nsec / 1e9;
+}
+
+/* Full-screen figures in MPix/s for one mode of a 768x1280 panel */
+STATIC VOID Throughput(BOOLEAN Landscape)
+{
+	SCREEN Screen = { .PortraitWidth = 768, .Landscape = Landscape };
+	SURFACE Buffer, Scaled;
+	UINTN Width, Height, Pixels;
+	UINTN Operation;
+
+	SurfaceInit(&Screen.Portrait, Screen.PortraitWidth * BLT_BYTES_PER_PIXEL, 1280);
+	Width = ScreenWidth(&Screen);
+	Height = ScreenHeight(&Screen);
+	Pixels = Width * Height;
+	SurfaceInit(&Buffer, Width * BLT_BYTES_PER_PIXEL, Height);
+
+	for (Operation = 0; Operation < EfiGraphicsOutputBltOperationMax; Operation++)
+	{
+		STATIC CONST CHAR8 *Names[] = {
+			"VideoFill", "VideoToBltBuffer", "BufferToVideo", "VideoToVideo (scroll 16)"
+		};
+		UINTN Iterations = 0;
+		double Start = Seconds(), Elapsed;
+
+		do {
+			if (Operation == EfiBltVideoToVideo)
+				ScreenBlt(&Screen, Buffer.Base, Operation, 0, 16, 0, 0, Width, Height - 16, 0);
+			else
+				ScreenBlt(&Screen, Buffer.Base, Operation, 0, 0, 0, 0, Width, Height, 0);
+			Iterations++;
+			Elapsed = Seconds() - Start;
+		} while (Elapsed < 0.25);
+
+		printf("%-9s %-26s %8.1f MPix/s\n", Landscape ? "landscape" : "portrait", Names[Operation],
+			Iterations * (double)Pixels / Elapsed / 1e6);
+	}
+
+	if (!Landscape)
+	{
+		UINTN Iterations = 0;
+		double Start = Seconds(), Elapsed;
+
+		SurfaceInit(&Scaled, 384 * BLT_BYTES_PER_PIXEL, 640);
+		do {
+			BltScale2x(Screen.Portrait.Base, Screen.Portrait.Stride, Scaled.Base, Scaled.Stride, 384, 640);
+			Iterations++;
+			Elapsed = Seconds() - Start;
+		} while (Elapsed < 0.25);
+
+		printf("%-9s %-26s %8.1f MPix/s\n", "scaled", "Scale2x (written pixels)",
+			Iterations * (double)Pixels / Elapsed / 1e6);
+		SurfaceFree(&Scaled);
+	}
+
+	SurfaceFree(&Screen.Portrait);
+	SurfaceFree(&Buffer);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "throughput") == 0)
+	{
+#ifdef BLT_KERNEL_MODEL
+		printf("C kernels (BltKernels.c), not the NEON ones\n");
+#endif
+		Throughput(FALSE);
+		Throughput(TRUE);
+		return 0;
+	}
+
+	TestFill();
+	TestCopy();
+	TestTranspose();
+	TestScale2x();
+	TestOperations(FALSE);
+	TestOperations(TRUE);
+
+#ifdef BLT_KERNEL_MODEL
+	CHECK_EQ(mBltKernelCalls.Violations, 0);
+	CHECK(mBltKernelCalls.TransposeStrip > 0);
+	CHECK(mBltKernelCalls.Scale2xLine > 0);
+#endif
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,358 @@
+/*
+ * Blt offload: VicStream.c command streams run on the Host1x/VIC model
+ * must leave memory exactly as the CPU Blt does, and BltEngineFill/Copy
+ * must fall back to the CPU whenever the engine is missing, turns a
+ * rectangle down or the rectangle is small.
+ *
+ * VIC offsets are addresses divided by 256 in 32 bits, so the surfaces
+ * live in an arena mapped below 1 TiB; the test is skipped if the host
+ * cannot map one there.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <Uefi.h>
+
+#include "../../Drivers/SimpleFbDxe/Include/Blt.h"
+#include "../../Drivers/SimpleFbDxe/Include/Host1x.h"
+#include "../../Drivers/SimpleFbDxe/Include/Vic.h"
+
+#include <HostTest.h>
+
+#include "Host1xModel.h"
+
+#define SKIP_TEST			77
+
+#define ARENA_SIZE			(16 << 20)
+#define CONFIG_SLOTS		128
+#define PUSH_WORDS			4096
+#define BLT_SYNCPT			1
+
+/* Screen-sized surface, as DisplayBlt sees the portrait framebuffer */
+#define SURFACE_WIDTH		768
+#define SURFACE_HEIGHT		1280
+#define SURFACE_STRIDE		(SURFACE_WIDTH * BLT_BYTES_PER_PIXEL)
+#define SURFACE_BYTES		(SURFACE_STRIDE * SURFACE_HEIGHT)
+
+STATIC UINT8 *mArena;
+STATIC UINT8 *mSurface;			// Run through the engine
+STATIC UINT8 *mExpected;		// Same work on the CPU
+STATIC UINT32 mPush[PUSH_WORDS];
+STATIC VIC_STREAM mStream;
+STATIC UINT32 mSeed = 0x2545f491;
+
+STATIC UINT32 Random(VOID)
+{
+	mSeed ^= mSeed << 13;
+	mSeed ^= mSeed >> 17;
+	mSeed ^= mSeed << 5;
+	return mSeed;
+}
+
+STATIC VOID Scramble(VOID)
+{
+	UINTN Index;
+
+	for (Index = 0; Index < SURFACE_BYTES / 4; Index++)
+		((UINT32 *)mSurface)[Index] = Random();
+	memcpy(mExpected, mSurface, SURFACE_BYTES);
+}
+
+STATIC UINT8 *At(UINT8 *Surface, UINTN X, UINTN Y)
+{
+	return Surface + Y * SURFACE_STRIDE + X * BLT_BYTES_PER_PIXEL;
+}
+
+/* What Vic.c does around a stream, with the model standing in for MMIO */
+STATIC EFI_STATUS ModelRun(VOID)
+{
+	UINT32 Fence = mHost1x.Syncpt[BLT_SYNCPT] + 1;
+	EFI_STATUS Status;
+
+	Status = VicStreamFinish(&mStream, BLT_SYNCPT);
+	if (!EFI_ERROR(Status))
+	{
+		Host1xModelRun(mStream.Words, mStream.WordCount);
+		if (mHost1x.Syncpt[BLT_SYNCPT] != Fence)
+			Status = EFI_TIMEOUT;
+	}
+
+	VicStreamReset(&mStream);
+	return Status;
+}
+
+STATIC EFI_STATUS ModelFill(UINT8 *Destination, UINTN Stride, UINTN Width, UINTN Height, UINT32 Color)
+{
+	EFI_STATUS Status = VicStreamFill(&mStream, Destination, Stride, Width, Height, Color);
+
+	if (EFI_ERROR(Status))
+	{
+		VicStreamReset(&mStream);
+		return Status;
+	}
+	return ModelRun();
+}
+
+STATIC EFI_STATUS ModelCopy(UINT8 *Destination, UINTN DestinationStride, CONST UINT8 *Source,
+	UINTN SourceStride, UINTN Width, UINTN Height)
+{
+	EFI_STATUS Status = VicStreamCopy(&mStream, Destination, DestinationStride, Source, SourceStride,
+		Width, Height);
+
+	if (EFI_ERROR(Status))
+	{
+		VicStreamReset(&mStream);
+		return Status;
+	}
+	return ModelRun();
+}
+
+STATIC CONST BLT_ENGINE mModelEngine = { ModelFill, ModelCopy };
+
+/* Stream layout: class and application first, syncpoint increment last */
+STATIC VOID TestStreamShape(VOID)
+{
+	UINTN Index, Executes = 0;
+
+	VicStreamReset(&mStream);
+	CHECK_EQ(VicStreamFinish(&mStream, BLT_SYNCPT), EFI_NOT_READY);
+
+	CHECK_EQ(VicStreamFill(&mStream, At(mSurface, 3, 5), SURFACE_STRIDE, 10, 10, 0), EFI_SUCCESS);
+	CHECK_EQ(VicStreamCopy(&mStream, At(mSurface, 0, 0), SURFACE_STRIDE, At(mSurface, 0, 100),
+		SURFACE_STRIDE, 10, 10), EFI_SUCCESS);
+	CHECK_EQ(VicStreamFinish(&mStream, BLT_SYNCPT), EFI_SUCCESS);
+
+	CHECK_EQ(mStream.Words[0], HOST1X_OPCODE_SETCLASS(0, VIC_CLASS_ID, 0));
+	CHECK_EQ(mStream.Words[1], HOST1X_OPCODE_INCR(VIC_THI_METHOD0, 2));
+	CHECK_EQ(mStream.Words[2], VIC_SET_APPLICATION_ID >> 2);
+	CHECK_EQ(mStream.Words[mStream.WordCount - 1],
+		HOST1X_OPCODE_IMM(HOST1X_INCR_SYNCPT, HOST1X_INCR_SYNCPT_OP_DONE | BLT_SYNCPT));
+
+	for (Index = 1; Index + 2 < mStream.WordCount; Index += 3)
+	{
+		CHECK_EQ(mStream.Words[Index], HOST1X_OPCODE_INCR(VIC_THI_METHOD0, 2));
+		Executes += mStream.Words[Index + 1] == VIC_EXECUTE >> 2;
+	}
+	CHECK_EQ(Executes, 2);
+	CHECK_EQ(mStream.ConfigCount, 2);
+
+	// The fill starts 3 pixels into a 256 byte aligned surface.
+	CHECK_EQ(((VIC_BLT_CONFIG *)mStream.Configs)->DestinationX,
+		((UINTN)At(mSurface, 3, 5) % VIC_OFFSET_ALIGN) / BLT_BYTES_PER_PIXEL);
+
+	Host1xModelRun(mStream.Words, mStream.WordCount);
+	CHECK_EQ(mHost1x.Syncpt[BLT_SYNCPT], 1);
+	CHECK_EQ(mHost1x.Executes, 2);
+	CHECK_EQ(mHost1x.Errors, 0);
+	VicStreamReset(&mStream);
+	mHost1x.Syncpt[BLT_SYNCPT] = mHost1x.Executes = 0;
+}
+
+STATIC VOID TestFill(VOID)
+{
+	UINTN Step;
+
+	Scramble();
+	for (Step = 0; Step < 200; Step++)
+	{
+		UINTN Width = 1 + Random() % SURFACE_WIDTH;
+		UINTN Height = 1 + Random() % 64;
+		UINTN X = Random() % (SURFACE_WIDTH - Width + 1);
+		UINTN Y = Random() % (SURFACE_HEIGHT - Height + 1);
+		UINT32 Color = Random();
+
+		CHECK_EQ(ModelFill(At(mSurface, X, Y), SURFACE_STRIDE, Width, Height, Color), EFI_SUCCESS);
+		BltFill(At(mExpected, X, Y), SURFACE_STRIDE, Width, Height, Color);
+	}
+
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+	CHECK_EQ(mHost1x.Executes, 200);
+}
+
+/*
+ * Copy from (X, Y) to (X + Dx, Y + Dy) on the model and on the CPU.
+ * Returns the status of the engine, the CPU does the copy either way.
+ */
+STATIC EFI_STATUS Copy(UINTN X, UINTN Y, INTN Dx, INTN Dy, UINTN Width, UINTN Height)
+{
+	EFI_STATUS Status;
+
+	Status = ModelCopy(At(mSurface, X + Dx, Y + Dy), SURFACE_STRIDE, At(mSurface, X, Y), SURFACE_STRIDE,
+		Width, Height);
+	if (EFI_ERROR(Status))
+		BltCopy(At(mSurface, X + Dx, Y + Dy), SURFACE_STRIDE, At(mSurface, X, Y), SURFACE_STRIDE,
+			Width, Height);
+	BltCopy(At(mExpected, X + Dx, Y + Dy), SURFACE_STRIDE, At(mExpected, X, Y), SURFACE_STRIDE,
+		Width, Height);
+	return Status;
+}
+
+STATIC VOID TestCopy(VOID)
+{
+	STATIC CONST INTN Shifts[] = { 1, 2, 3, 7, 12, 16, 40, 200 };
+	UINTN Index, Executes;
+	INTN Sign;
+
+	Scramble();
+
+	// Scrolls: full-width rows, the stride equals the row length.
+	for (Index = 0; Index < ARRAY_SIZE(Shifts); Index++)
+	{
+		for (Sign = -1; Sign <= 1; Sign += 2)
+		{
+			INTN Dy = Sign * Shifts[Index];
+			UINTN Height = 400;
+			UINTN Bands = (Height + Shifts[Index] - 1) / Shifts[Index];
+
+			Executes = mHost1x.Executes;
+			CHECK_EQ(Copy(0, 300, 0, Dy, SURFACE_WIDTH, Height), Bands <= CONFIG_SLOTS ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES);
+			if (Bands <= CONFIG_SLOTS)
+				CHECK_EQ(mHost1x.Executes - Executes, Bands);
+			CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+		}
+	}
+
+	// Partial rows shifted diagonally: a band may be as tall as the shift.
+	for (Index = 0; Index < ARRAY_SIZE(Shifts); Index++)
+	{
+		for (Sign = -1; Sign <= 1; Sign += 2)
+		{
+			Executes = mHost1x.Executes;
+			CHECK_EQ(Copy(100, 300, Sign * 5, Sign * Shifts[Index], 300, 100), EFI_SUCCESS);
+			CHECK_EQ(mHost1x.Executes - Executes, (100 + Shifts[Index] - 1) / Shifts[Index]);
+			CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+		}
+	}
+
+	// Overlap within a row stays on the CPU.
+	CHECK_EQ(Copy(100, 300, 3, 0, 300, 100), EFI_UNSUPPORTED);
+	CHECK_EQ(Copy(100, 300, -3, 0, 300, 100), EFI_UNSUPPORTED);
+
+	// Apart from each other, a single rectangle of any size.
+	for (Index = 0; Index < 100; Index++)
+	{
+		UINTN Width = 1 + Random() % 300;
+		UINTN Height = 1 + Random() % 300;
+
+		Executes = mHost1x.Executes;
+		CHECK_EQ(Copy(Random() % (SURFACE_WIDTH - Width + 1) / 2, Random() % 200, 0, 400, Width, Height), EFI_SUCCESS);
+		CHECK_EQ(mHost1x.Executes - Executes, 1);
+	}
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+
+	// A stream without room for all bands is left as it was.
+	VicStreamReset(&mStream);
+	CHECK_EQ(VicStreamFill(&mStream, mSurface, SURFACE_STRIDE, 4, 4, 0), EFI_SUCCESS);
+	Executes = mStream.WordCount;
+	CHECK_EQ(VicStreamCopy(&mStream, At(mSurface, 0, 1), SURFACE_STRIDE, mSurface, SURFACE_STRIDE,
+		SURFACE_WIDTH, 1000), EFI_OUT_OF_RESOURCES);
+	CHECK_EQ(mStream.WordCount, Executes);
+	CHECK_EQ(mStream.ConfigCount, 1);
+	VicStreamReset(&mStream);
+
+	CHECK_EQ(mHost1x.Errors, 0);
+}
+
+/* Engine that records what it was offered and succeeds or declines */
+STATIC UINTN mFakeCalls;
+STATIC EFI_STATUS mFakeStatus;
+
+STATIC EFI_STATUS FakeFill(UINT8 *Destination, UINTN Stride, UINTN Width, UINTN Height, UINT32 Color)
+{
+	mFakeCalls++;
+	return mFakeStatus;
+}
+
+STATIC EFI_STATUS FakeCopy(UINT8 *Destination, UINTN DestinationStride, CONST UINT8 *Source,
+	UINTN SourceStride, UINTN Width, UINTN Height)
+{
+	mFakeCalls++;
+	return mFakeStatus;
+}
+
+STATIC CONST BLT_ENGINE mFakeEngine = { FakeFill, FakeCopy };
+
+STATIC VOID TestFallback(VOID)
+{
+	UINTN Large = SURFACE_WIDTH;
+	UINTN Small = BLT_ENGINE_MIN_PIXELS / SURFACE_WIDTH - 1;
+
+	// No engine: the CPU draws.
+	Scramble();
+	mBltEngine = NULL;
+	BltEngineFill(mSurface, SURFACE_STRIDE, SURFACE_WIDTH, Large, 0x11111111);
+	BltFill(mExpected, SURFACE_STRIDE, SURFACE_WIDTH, Large, 0x11111111);
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+
+	// Declined or failed: the CPU draws.
+	mBltEngine = &mFakeEngine;
+	mFakeCalls = 0;
+	mFakeStatus = EFI_UNSUPPORTED;
+	BltEngineFill(mSurface, SURFACE_STRIDE, SURFACE_WIDTH, Large, 0x22222222);
+	BltFill(mExpected, SURFACE_STRIDE, SURFACE_WIDTH, Large, 0x22222222);
+	mFakeStatus = EFI_TIMEOUT;
+	BltEngineCopy(mSurface, SURFACE_STRIDE, At(mSurface, 0, 16), SURFACE_STRIDE, SURFACE_WIDTH, Large);
+	BltCopy(mExpected, SURFACE_STRIDE, At(mExpected, 0, 16), SURFACE_STRIDE, SURFACE_WIDTH, Large);
+	CHECK_EQ(mFakeCalls, 2);
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+
+	// Taken: the CPU leaves it alone.
+	mFakeCalls = 0;
+	mFakeStatus = EFI_SUCCESS;
+	BltEngineFill(mSurface, SURFACE_STRIDE, SURFACE_WIDTH, Large, 0x33333333);
+	BltEngineCopy(mSurface, SURFACE_STRIDE, At(mSurface, 0, 16), SURFACE_STRIDE, SURFACE_WIDTH, Large);
+	CHECK_EQ(mFakeCalls, 2);
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+
+	// Small rectangles are not offered.
+	mFakeCalls = 0;
+	BltEngineFill(mSurface, SURFACE_STRIDE, SURFACE_WIDTH, Small, 0x44444444);
+	BltFill(mExpected, SURFACE_STRIDE, SURFACE_WIDTH, Small, 0x44444444);
+	BltEngineCopy(mSurface, SURFACE_STRIDE, At(mSurface, 0, 16), SURFACE_STRIDE, SURFACE_WIDTH, Small);
+	BltCopy(mExpected, SURFACE_STRIDE, At(mExpected, 0, 16), SURFACE_STRIDE, SURFACE_WIDTH, Small);
+	CHECK_EQ(mFakeCalls, 0);
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+
+	// Through the model engine, large work lands the same as on the CPU.
+	mBltEngine = &mModelEngine;
+	mHost1x.Executes = 0;
+	BltEngineFill(At(mSurface, 5, 7), SURFACE_STRIDE, 700, 1000, 0x55555555);
+	BltFill(At(mExpected, 5, 7), SURFACE_STRIDE, 700, 1000, 0x55555555);
+	BltEngineCopy(mSurface, SURFACE_STRIDE, At(mSurface, 0, 12), SURFACE_STRIDE, SURFACE_WIDTH, SURFACE_HEIGHT - 12);
+	BltCopy(mExpected, SURFACE_STRIDE, At(mExpected, 0, 12), SURFACE_STRIDE, SURFACE_WIDTH, SURFACE_HEIGHT - 12);
+	CHECK_EQ(mHost1x.Executes, 1 + (SURFACE_HEIGHT - 12 + 11) / 12);
+	CHECK(memcmp(mSurface, mExpected, SURFACE_BYTES) == 0);
+	mBltEngine = NULL;
+}
+
+int main(void)
+{
+	UINTN Configs = CONFIG_SLOTS * VIC_OFFSET_ALIGN;
+
+	// Below 1 TiB, where VIC offsets reach.
+	mArena = mmap((VOID *)(UINTN)0x40000000, ARENA_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mArena == MAP_FAILED || (UINTN)mArena + ARENA_SIZE > VIC_OFFSET_LIMIT)
+	{
+		printf("no arena below 1 TiB, skipped\n");
+		return SKIP_TEST;
+	}
+
+	mStream.Configs = mArena;
+	mStream.ConfigLimit = CONFIG_SLOTS;
+	mStream.Words = mPush;
+	mStream.WordLimit = PUSH_WORDS;
+	mSurface = mArena + Configs;
+	mExpected = malloc(SURFACE_BYTES);
+	Host1xModelReset(mArena, Configs + SURFACE_BYTES);
+
+	TestStreamShape();
+	TestFill();
+	TestCopy();
+	TestFallback();
+
+	CHECK_EQ(mHost1x.Errors, 0);
+	return HOST_TEST_RESULT();
+}
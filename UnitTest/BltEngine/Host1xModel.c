@@ -0,0 +1,178 @@
+/*
+ * Host model of a Host1x channel feeding VIC, see Host1xModel.h.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <Uefi.h>
+
+#include "../../Drivers/SimpleFbDxe/Include/Blt.h"
+#include "../../Drivers/SimpleFbDxe/Include/Host1x.h"
+#include "../../Drivers/SimpleFbDxe/Include/Vic.h"
+
+#include "Host1xModel.h"
+
+HOST1X_MODEL mHost1x;
+
+STATIC VOID Host1xModelError(CONST CHAR8 *What, UINT32 Value)
+{
+	fprintf(stderr, "host1x model: %s 0x%x\n", What, Value);
+	mHost1x.Errors++;
+}
+
+/* Pixel (X, Y) of the surface at Offset, NULL if VIC could not reach it */
+STATIC UINT32 *Host1xModelPixel(UINT32 Offset, UINTN X, UINTN Y, UINTN Stride)
+{
+	UINT8 *Address = (UINT8 *)((UINTN)Offset * VIC_OFFSET_ALIGN + Y * Stride + X * BLT_BYTES_PER_PIXEL);
+
+	if (Address < mHost1x.ArenaStart || Address + BLT_BYTES_PER_PIXEL > mHost1x.ArenaEnd)
+		return NULL;
+	return (UINT32 *)Address;
+}
+
+STATIC VOID Host1xModelExecute(VOID)
+{
+	VIC_BLT_CONFIG *Config = (VIC_BLT_CONFIG *)Host1xModelPixel(mHost1x.ConfigOffset, 0, 0, 0);
+	INTN X, Y;
+	BOOLEAN Up;
+
+	mHost1x.Executes++;
+
+	if (mHost1x.ApplicationId != VIC_APPLICATION_ID_COMPOSITOR)
+		return Host1xModelError("EXECUTE without application", mHost1x.ApplicationId);
+	if (Config == NULL || (UINT8 *)(Config + 1) > mHost1x.ArenaEnd)
+		return Host1xModelError("config struct outside the arena", mHost1x.ConfigOffset);
+	if (mHost1x.ControlParams != VIC_CONTROL_PARAMS_CONFIG_SIZE(sizeof(*Config)))
+		return Host1xModelError("control params", mHost1x.ControlParams);
+
+	// Check every pixel first, a rejected EXECUTE leaves memory as it was.
+	for (Y = 0; Y < (INTN)Config->Height; Y++)
+	{
+		if (!Host1xModelPixel(mHost1x.OutputOffset, Config->DestinationX, Y, Config->DestinationStride) ||
+			!Host1xModelPixel(mHost1x.OutputOffset, Config->DestinationX + Config->Width - 1, Y, Config->DestinationStride))
+			return Host1xModelError("output outside the arena", mHost1x.OutputOffset);
+		if (Config->Operation == VIC_BLT_COPY &&
+			(!Host1xModelPixel(mHost1x.SourceOffset, Config->SourceX, Y, Config->SourceStride) ||
+			 !Host1xModelPixel(mHost1x.SourceOffset, Config->SourceX + Config->Width - 1, Y, Config->SourceStride)))
+			return Host1xModelError("source outside the arena", mHost1x.SourceOffset);
+	}
+
+	switch (Config->Operation) {
+	case VIC_BLT_FILL:
+		for (Y = 0; Y < (INTN)Config->Height; Y++)
+			for (X = 0; X < (INTN)Config->Width; X++)
+				*Host1xModelPixel(mHost1x.OutputOffset, Config->DestinationX + X, Y,
+					Config->DestinationStride) = Config->Color;
+		break;
+
+	case VIC_BLT_COPY:
+		// Bottom-up and back to front when the destination is lower in memory
+		Up = (UINTN)mHost1x.OutputOffset * VIC_OFFSET_ALIGN + Config->DestinationX * BLT_BYTES_PER_PIXEL <
+			(UINTN)mHost1x.SourceOffset * VIC_OFFSET_ALIGN + Config->SourceX * BLT_BYTES_PER_PIXEL;
+		for (Y = Up ? (INTN)Config->Height - 1 : 0; Up ? Y >= 0 : Y < (INTN)Config->Height; Y += Up ? -1 : 1)
+			for (X = Up ? (INTN)Config->Width - 1 : 0; Up ? X >= 0 : X < (INTN)Config->Width; X += Up ? -1 : 1)
+				*Host1xModelPixel(mHost1x.OutputOffset, Config->DestinationX + X, Y, Config->DestinationStride) =
+					*Host1xModelPixel(mHost1x.SourceOffset, Config->SourceX + X, Y, Config->SourceStride);
+		break;
+
+	default:
+		Host1xModelError("operation", Config->Operation);
+		break;
+	}
+}
+
+STATIC VOID Host1xModelMethod(UINT32 Method, UINT32 Data)
+{
+	switch (Method) {
+	case VIC_SET_APPLICATION_ID:				mHost1x.ApplicationId = Data; break;
+	case VIC_SET_CONTROL_PARAMS:				mHost1x.ControlParams = Data; break;
+	case VIC_SET_CONFIG_STRUCT_OFFSET:			mHost1x.ConfigOffset = Data; break;
+	case VIC_SET_OUTPUT_SURFACE_LUMA_OFFSET:	mHost1x.OutputOffset = Data; break;
+	case VIC_SET_SURFACE0_SLOT0_LUMA_OFFSET:	mHost1x.SourceOffset = Data; break;
+	case VIC_EXECUTE:							Host1xModelExecute(); break;
+	default:									Host1xModelError("method", Method); break;
+	}
+}
+
+STATIC VOID Host1xModelWrite(UINT32 Offset, UINT32 Data)
+{
+	if (mHost1x.Class != VIC_CLASS_ID)
+		return Host1xModelError("write outside the VIC class", Offset);
+
+	switch (Offset) {
+	case HOST1X_INCR_SYNCPT:
+		// Rectangles run to completion as they are executed, OP_DONE holds.
+		if ((Data & ~0xffU) != HOST1X_INCR_SYNCPT_OP_DONE || (Data & 0xff) >= HOST1X_MODEL_SYNCPTS)
+			return Host1xModelError("syncpoint increment", Data);
+		mHost1x.Syncpt[Data & 0xff]++;
+		break;
+	case VIC_THI_METHOD0:
+		mHost1x.Method = Data;
+		break;
+	case VIC_THI_METHOD1:
+		if (mHost1x.Method == 0)
+			return Host1xModelError("METHOD1 without METHOD0", Data);
+		Host1xModelMethod(mHost1x.Method << 2, Data);
+		break;
+	default:
+		Host1xModelError("register", Offset);
+		break;
+	}
+}
+
+VOID Host1xModelReset(UINT8 *ArenaStart, UINTN ArenaSize)
+{
+	memset(&mHost1x, 0, sizeof(mHost1x));
+	mHost1x.ArenaStart = ArenaStart;
+	mHost1x.ArenaEnd = ArenaStart + ArenaSize;
+}
+
+VOID Host1xModelRun(CONST UINT32 *Words, UINTN Count)
+{
+	CONST UINT32 *End = Words + Count;
+
+	while (Words < End)
+	{
+		UINT32 Word = *Words++;
+		UINT32 Offset = HOST1X_OPCODE_OFFSET(Word);
+		UINT32 Mask = 0, Index;
+		UINTN Data;
+
+		// Offsets written in turn, as a bit mask relative to Offset
+		switch (HOST1X_OPCODE(Word)) {
+		case 0:		// SETCLASS
+			mHost1x.Class = HOST1X_OPCODE_CLASS(Word);
+			Mask = Word & 0x3f;
+			break;
+		case 1:		// INCR
+		case 2:		// NONINCR
+			break;
+		case 3:		// MASK
+			Mask = HOST1X_OPCODE_COUNT(Word);
+			break;
+		case 4:		// IMM
+			Host1xModelWrite(Offset, HOST1X_OPCODE_COUNT(Word));
+			continue;
+		default:
+			return Host1xModelError("opcode", Word);
+		}
+
+		Data = HOST1X_OPCODE(Word) == 1 || HOST1X_OPCODE(Word) == 2 ?
+			HOST1X_OPCODE_COUNT(Word) : (UINTN)__builtin_popcount(Mask);
+		if (Data > (UINTN)(End - Words))
+			return Host1xModelError("stream ends inside an opcode", Word);
+
+		for (Index = 0; Data != 0; Index++)
+		{
+			if (HOST1X_OPCODE(Word) == 1)
+				Host1xModelWrite(Offset + Index, *Words++);
+			else if (HOST1X_OPCODE(Word) == 2)
+				Host1xModelWrite(Offset, *Words++);
+			else if (Mask & (1U << Index))
+				Host1xModelWrite(Offset + Index, *Words++);
+			else
+				continue;
+			Data--;
+		}
+	}
+}
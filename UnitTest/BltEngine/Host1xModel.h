@@ -0,0 +1,40 @@
+/*
+ * Host model of a Host1x channel feeding VIC, for the streams VicStream.c
+ * builds. The model decodes the Host1x opcodes, passes THI METHOD0/METHOD1
+ * pairs on as VIC methods and runs each EXECUTE on host memory, reading
+ * its VIC_BLT_CONFIG through SET_CONFIG_STRUCT_OFFSET.
+ *
+ * VIC does not promise any order within a rectangle, so the model copies
+ * in the order that is wrong for the direction of the copy: an overlap
+ * between the source and destination of one EXECUTE shows up as a wrong
+ * result. Anything it does not understand or memory outside the arena
+ * counts as an error.
+ */
+#ifndef __HOST1X_MODEL_H__
+#define __HOST1X_MODEL_H__
+
+#include <Uefi.h>
+
+#define HOST1X_MODEL_SYNCPTS	32
+
+typedef struct {
+	UINT8 *ArenaStart;			// VIC can reach [ArenaStart, ArenaEnd)
+	UINT8 *ArenaEnd;
+	UINT32 Class;
+	UINT32 Method;				// Last METHOD0 value, 0 when none
+	UINT32 ApplicationId;
+	UINT32 ControlParams;
+	UINT32 ConfigOffset;
+	UINT32 OutputOffset;
+	UINT32 SourceOffset;
+	UINTN Executes;
+	UINT32 Syncpt[HOST1X_MODEL_SYNCPTS];
+	UINTN Errors;
+} HOST1X_MODEL;
+
+extern HOST1X_MODEL mHost1x;
+
+VOID Host1xModelReset(UINT8 *ArenaStart, UINTN ArenaSize);
+VOID Host1xModelRun(CONST UINT32 *Words, UINTN Count);
+
+#endif
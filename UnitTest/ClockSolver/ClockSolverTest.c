@@ -0,0 +1,295 @@
+/*
+ * Host sweep of clock_solver.c against brute force.
+ *
+ * Dividers: with 8-bit dividers, every rate at which some divider and
+ * second-stage shift lands exactly is solved, together with the rates one
+ * below and one above it, for several parents and with and without the
+ * second stage. 16-bit dividers have too many of those and take a log
+ * sweep plus random rates instead. The reference tries every divider and
+ * shift; the solver must reach the same rate, or both must give up.
+ *
+ * PLLs: PLLU is solved for every oscillator over a sweep of rates and
+ * compared with a search over every M, N and P inside its limits,
+ * tie-break included. The validated T210 USB table rows must come out as
+ * they are, and 13/26MHz must have no exact 240MHz setting.
+ */
+#include <stdio.h>
+
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Foundation/Types.h>
+
+#include "../../Drivers/ClockManagementDxe/Include/ClockSolver.h"
+
+#include <HostTest.h>
+
+/* Enough reports to see what broke, not a screenful per rate */
+#define MAX_REPORTS		20
+#define GIVE_UP()		(mHostTestFailures >= MAX_REPORTS)
+
+#define MHZ(x)			((u64)((x) * 1000000))
+#define T210_PLLU_RATE	MHZ(240)
+
+STATIC CONST u64 mParents[] = {
+	MHZ(12), MHZ(19.2), MHZ(38.4), MHZ(48), MHZ(216), MHZ(408), 589824000
+};
+
+STATIC CONST u64 mOscillators[] = {
+	MHZ(13), MHZ(19.2), MHZ(12), MHZ(26), MHZ(38.4), MHZ(48)
+};
+
+STATIC UINT32 mSeed = 0x9e3779b9;
+
+STATIC UINT32 Random(VOID)
+{
+	mSeed ^= mSeed << 13;
+	mSeed ^= mSeed >> 17;
+	mSeed ^= mSeed << 5;
+	return mSeed;
+}
+
+/* (n + 2) / 2 divider behind a 1 << shift second stage */
+STATIC u64 DividerRate(u64 Parent, u64 Divider, int Shift)
+{
+	return (Parent * 2) / ((Divider + 2) << Shift);
+}
+
+/*
+ * Highest rate not above Rate over every divider and shift. A fit must not
+ * overshoot before truncation either, as the hardware does not truncate.
+ * The rate only falls as the divider grows, so each shift stops at its
+ * first fit.
+ */
+STATIC BOOLEAN ReferenceDivider(unsigned Bits, u64 Parent, u64 Rate, int MaxShift, u64 *Best)
+{
+	BOOLEAN Found = FALSE;
+	u64 Divider;
+	int Shift;
+
+	*Best = 0;
+	for (Shift = 0; Shift <= MaxShift; Shift++)
+	{
+		for (Divider = 0; Divider < (1ULL << Bits); Divider++)
+		{
+			u64 Effective = DividerRate(Parent, Divider, Shift);
+
+			if (Parent * 2 <= Rate * ((Divider + 2) << Shift))
+			{
+				if (!Found || Effective > *Best)
+					*Best = Effective;
+				Found = TRUE;
+				break;
+			}
+		}
+	}
+
+	return Found;
+}
+
+STATIC VOID CheckDivider(unsigned Bits, u64 Parent, u64 Rate, BOOLEAN ExtraDivider)
+{
+	int MaxShift = ExtraDivider ? CLOCK_SOLVER_MAX_SHIFT : 0;
+	int ExtraDiv = 1;
+	u64 Best;
+	BOOLEAN Found = ReferenceDivider(Bits, Parent, Rate, MaxShift, &Best);
+	int Divider = clock_solve_divider(Bits, Parent, Rate, ExtraDivider ? &ExtraDiv : NULL);
+	int Shift;
+
+	if (!Found || Rate == 0)
+	{
+		if (Divider != -1)
+			fprintf(stderr, "parent %llu rate %llu bits %u\n", (unsigned long long)Parent,
+				(unsigned long long)Rate, Bits);
+		CHECK_EQ(Divider, -1);
+		return;
+	}
+
+	for (Shift = 0; Shift <= MaxShift && (1 << Shift) != ExtraDiv; Shift++)
+		;
+	CHECK(Shift <= MaxShift);
+	CHECK(Divider >= 0 && Divider < (1 << Bits));
+	if (DividerRate(Parent, Divider, Shift) != Best)
+		fprintf(stderr, "parent %llu rate %llu bits %u: n %d / %d\n", (unsigned long long)Parent,
+			(unsigned long long)Rate, Bits, Divider, ExtraDiv);
+	CHECK_EQ(DividerRate(Parent, Divider, Shift), Best);
+}
+
+STATIC VOID TestDividerBoundaries(VOID)
+{
+	UINTN Index;
+	u64 Divider;
+	int Shift, Extra;
+
+	for (Index = 0; Index < ARRAY_SIZE(mParents) && !GIVE_UP(); Index++)
+	{
+		for (Extra = 0; Extra <= 1; Extra++)
+		{
+			for (Shift = 0; Shift <= (Extra ? CLOCK_SOLVER_MAX_SHIFT : 0); Shift++)
+			{
+				for (Divider = 0; Divider < 256 && !GIVE_UP(); Divider++)
+				{
+					u64 Rate = DividerRate(mParents[Index], Divider, Shift);
+
+					CheckDivider(8, mParents[Index], Rate - 1, Extra);
+					CheckDivider(8, mParents[Index], Rate, Extra);
+					CheckDivider(8, mParents[Index], Rate + 1, Extra);
+				}
+			}
+		}
+	}
+
+	// Nothing fits at all, or there is nothing to divide.
+	CheckDivider(8, MHZ(408), 1, TRUE);
+	CHECK_EQ(clock_solve_divider(8, MHZ(408), 0, NULL), -1);
+	CHECK_EQ(clock_solve_divider(8, 0, MHZ(1), NULL), -1);
+}
+
+STATIC VOID TestDividerSweep(VOID)
+{
+	UINTN Index, Step;
+	int Extra;
+	u64 Rate;
+
+	for (Index = 0; Index < ARRAY_SIZE(mParents) && !GIVE_UP(); Index += 2)
+	{
+		for (Extra = 0; Extra <= 1; Extra++)
+		{
+			for (Rate = 1000; Rate < MHZ(600); Rate += Rate / 20 + 1)
+			{
+				CheckDivider(8, mParents[Index], Rate, Extra);
+				CheckDivider(16, mParents[Index], Rate, Extra);
+			}
+
+			for (Step = 0; Step < 50; Step++)
+			{
+				Rate = 1 + Random() % (mParents[Index] * 2);
+				CheckDivider(16, mParents[Index], Rate, Extra);
+			}
+		}
+	}
+}
+
+/* VCO >> P, as clock_get_rate() reads PLLU back */
+STATIC u64 PllRate(u64 Parent, unsigned M, unsigned N, unsigned P)
+{
+	return Parent * N / ((u64)M << P);
+}
+
+STATIC BOOLEAN PllFits(CONST struct clock_pll_limits *Limits, u64 Parent, unsigned M, unsigned N,
+	unsigned P)
+{
+	return M >= 1 && M <= Limits->max_m && N >= 1 && N <= Limits->max_n && P <= Limits->max_p &&
+		Parent >= Limits->min_input && Parent <= Limits->max_input &&
+		Parent >= (u64)Limits->min_cf * M && Parent <= (u64)Limits->max_cf * M &&
+		Parent * N >= (u64)Limits->min_vco * M && Parent * N <= (u64)Limits->max_vco * M;
+}
+
+/* Every M, P and N in the order of the tie-break, the first best wins */
+STATIC u64 ReferencePll(CONST struct clock_pll_limits *Limits, u64 Parent, u64 Rate,
+	unsigned *BestM, unsigned *BestN, unsigned *BestP)
+{
+	unsigned M, N, P;
+	u64 Best = 0;
+
+	for (M = 1; M <= Limits->max_m; M++)
+	{
+		for (P = 0; P <= Limits->max_p; P++)
+		{
+			for (N = 1; N <= Limits->max_n; N++)
+			{
+				u64 Effective = PllRate(Parent, M, N, P);
+
+				if (Parent * N <= Rate * ((u64)M << P) && Effective > Best &&
+				    PllFits(Limits, Parent, M, N, P))
+				{
+					Best = Effective;
+					*BestM = M;
+					*BestN = N;
+					*BestP = P;
+				}
+			}
+		}
+	}
+
+	return Best;
+}
+
+STATIC VOID CheckPll(u64 Parent, u64 Rate)
+{
+	unsigned M = 0, N = 0, P = 0, RefM = 0, RefN = 0, RefP = 0;
+	u64 Expected = ReferencePll(&clock_pllu_limits, Parent, Rate, &RefM, &RefN, &RefP);
+	u64 Solved = clock_solve_pll(&clock_pllu_limits, Parent, Rate, &M, &N, &P);
+
+	if (Solved != Expected || M != RefM || N != RefN || P != RefP)
+		fprintf(stderr, "osc %llu rate %llu: %u/%u/%u gives %llu, expected %u/%u/%u for %llu\n",
+			(unsigned long long)Parent, (unsigned long long)Rate, M, N, P,
+			(unsigned long long)Solved, RefM, RefN, RefP, (unsigned long long)Expected);
+	CHECK_EQ(Solved, Expected);
+	if (!Expected)
+		return;
+
+	CHECK_EQ(M, RefM);
+	CHECK_EQ(N, RefN);
+	CHECK_EQ(P, RefP);
+	CHECK_EQ(PllRate(Parent, M, N, P), Solved);
+	CHECK(PllFits(&clock_pllu_limits, Parent, M, N, P));
+}
+
+STATIC VOID TestPllSweep(VOID)
+{
+	UINTN Index;
+	u64 Rate;
+
+	for (Index = 0; Index < ARRAY_SIZE(mOscillators) && !GIVE_UP(); Index++)
+	{
+		for (Rate = MHZ(1); Rate <= MHZ(800); Rate += 3333333)
+			CheckPll(mOscillators[Index], Rate);
+		CheckPll(mOscillators[Index], T210_PLLU_RATE);
+		CheckPll(mOscillators[Index], T210_PLLU_RATE - 1);
+	}
+
+	// Reference clocks outside the input range.
+	CheckPll(MHZ(9.6) - 1, T210_PLLU_RATE);
+	CheckPll(MHZ(801), T210_PLLU_RATE);
+}
+
+/* T210_usb_pll in EhciPciEmulationDxe/TegraUsb.h */
+STATIC VOID TestPllUsbTable(VOID)
+{
+	STATIC CONST struct {
+		u64 Oscillator;
+		unsigned M, N, P;
+	} Rows[] = {
+		{ MHZ(12),   1, 40, 1 },
+		{ MHZ(19.2), 1, 25, 1 },
+		{ MHZ(38.4), 2, 25, 1 },
+	};
+	unsigned M, N, P;
+	UINTN Index;
+
+	for (Index = 0; Index < ARRAY_SIZE(Rows); Index++)
+	{
+		CHECK_EQ(clock_solve_pll(&clock_pllu_limits, Rows[Index].Oscillator, T210_PLLU_RATE,
+			&M, &N, &P), T210_PLLU_RATE);
+		CHECK_EQ(M, Rows[Index].M);
+		CHECK_EQ(N, Rows[Index].N);
+		CHECK_EQ(P, Rows[Index].P);
+	}
+
+	// 48MHz is exact too, with a higher comparison frequency than the table's M = 4.
+	CHECK_EQ(clock_solve_pll(&clock_pllu_limits, MHZ(48), T210_PLLU_RATE, &M, &N, &P), T210_PLLU_RATE);
+	CHECK_EQ(M, 3);
+
+	// 480 is not a multiple of 13MHz over any M the comparison range allows.
+	CHECK(clock_solve_pll(&clock_pllu_limits, MHZ(13), T210_PLLU_RATE, &M, &N, &P) < T210_PLLU_RATE);
+	CHECK(clock_solve_pll(&clock_pllu_limits, MHZ(26), T210_PLLU_RATE, &M, &N, &P) < T210_PLLU_RATE);
+}
+
+int main(void)
+{
+	TestDividerBoundaries();
+	TestDividerSweep();
+	TestPllSweep();
+	TestPllUsbTable();
+	return HOST_TEST_RESULT();
+}
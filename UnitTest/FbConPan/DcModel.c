@@ -0,0 +1,103 @@
+/*
+ * Host model of the display controller register latching, see DcModel.h.
+ */
+#include <string.h>
+
+#include "DcModel.h"
+
+DC_MODEL mDcModel;
+
+STATIC BOOLEAN DcModelIsWindow(UINTN Register)
+{
+	return Register >= 0x700 && Register < 0x900;
+}
+
+// Copy one register group (general or window A) from one stage to the next.
+STATIC VOID DcModelPromote(UINT32 *From, UINT32 *To, BOOLEAN Window)
+{
+	UINTN Register;
+
+	for (Register = 0; Register < DC_MODEL_REGISTERS; Register++)
+		if (DcModelIsWindow(Register) == Window)
+			To[Register] = From[Register];
+}
+
+STATIC VOID DcModelWrite(UINTN Register, UINT32 Value)
+{
+	if (Register == DC_CMD_STATE_CONTROL)
+	{
+		if (Value & GENERAL_UPDATE)
+			DcModelPromote(mDcModel.Assembly, mDcModel.Armed, FALSE);
+		if (Value & WIN_A_UPDATE)
+			DcModelPromote(mDcModel.Assembly, mDcModel.Armed, TRUE);
+		mDcModel.ActRequest |= Value & (GENERAL_ACT_REQ | WIN_A_ACT_REQ);
+		return;
+	}
+
+	if (Register == DC_CMD_DISPLAY_WINDOW_HEADER)
+	{
+		mDcModel.WindowHeader = Value;
+		return;
+	}
+
+	if (DcModelIsWindow(Register) && !(mDcModel.WindowHeader & WINDOW_A_SELECT))
+	{
+		mDcModel.Errors++;
+		return;
+	}
+
+	mDcModel.Assembly[Register] = Value;
+}
+
+VOID DcModelReset(VOID)
+{
+	memset(&mDcModel, 0, sizeof(mDcModel));
+	mDcModel.Pending = -1;
+}
+
+vu32 *DcModelAccess(UINTN Offset)
+{
+	DcModelSync();
+
+	// Registers are 32-bit and word aligned, offsets come from _DIREG().
+	if ((Offset & 3) || Offset / 4 >= DC_MODEL_REGISTERS)
+	{
+		mDcModel.Errors++;
+		Offset = 0;
+	}
+
+	mDcModel.Pending = Offset / 4;
+	mDcModel.Slot = mDcModel.Assembly[Offset / 4];
+	return &mDcModel.Slot;
+}
+
+VOID DcModelSync(VOID)
+{
+	if (mDcModel.Pending < 0) return;
+
+	DcModelWrite(mDcModel.Pending, mDcModel.Slot);
+	mDcModel.Pending = -1;
+}
+
+UINT32 DcModelRead(UINTN Register)
+{
+	DcModelSync();
+
+	if (Register == DC_CMD_STATE_CONTROL) return mDcModel.ActRequest;
+	if (Register == DC_CMD_DISPLAY_WINDOW_HEADER) return mDcModel.WindowHeader;
+	return mDcModel.Assembly[Register];
+}
+
+// Frame start: the requested groups take their armed values.
+VOID DcModelFrame(VOID)
+{
+	DcModelSync();
+
+	if (mDcModel.ActRequest & GENERAL_ACT_REQ)
+		DcModelPromote(mDcModel.Armed, mDcModel.Active, FALSE);
+	if (mDcModel.ActRequest & WIN_A_ACT_REQ)
+		DcModelPromote(mDcModel.Armed, mDcModel.Active, TRUE);
+
+	mDcModel.ActRequest = 0;
+	mDcModel.Frames++;
+}
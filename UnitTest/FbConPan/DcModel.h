@@ -0,0 +1,50 @@
+/*
+ * Host model of the display controller register latching, for code which
+ * programs DISPLAY_A directly. Including this header after Device/T210.h
+ * points DISPLAY_A at the model.
+ *
+ * Every register has three copies, as in the DC: software writes land in
+ * the assembly copy, a *_UPDATE bit in DC_CMD_STATE_CONTROL arms the
+ * assembly values of that group, and a *_ACT_REQ bit makes the armed values
+ * active at the start of the next frame (DcModelFrame). Only the active
+ * copy reaches the scanout. Window registers (0x700-0x8ff) go to window A
+ * when it is selected in DC_CMD_DISPLAY_WINDOW_HEADER; only window A is
+ * modelled, a window register written with it deselected is an error.
+ *
+ * A write is applied when the next register access starts, or by
+ * DcModelSync. Reads go through DcModelRead.
+ */
+#ifndef __DC_MODEL_H__
+#define __DC_MODEL_H__
+
+#include <Uefi.h>
+#include <Foundation/Types.h>
+#include <Device/T210.h>
+#include <Library/DisplayInitLib.h>
+
+#define DC_MODEL_REGISTERS	0x1000
+
+typedef struct {
+	UINT32 Assembly[DC_MODEL_REGISTERS];
+	UINT32 Armed[DC_MODEL_REGISTERS];
+	UINT32 Active[DC_MODEL_REGISTERS];
+	UINT32 WindowHeader;
+	UINT32 ActRequest;			// *_ACT_REQ bits waiting for the next frame
+	INTN Pending;				// Register of the write not applied yet, or -1
+	vu32 Slot;					// What DISPLAY_A() hands out to the caller
+	UINTN Frames;
+	UINTN Errors;
+} DC_MODEL;
+
+extern DC_MODEL mDcModel;
+
+VOID DcModelReset(VOID);
+vu32 *DcModelAccess(UINTN Offset);
+VOID DcModelSync(VOID);
+UINT32 DcModelRead(UINTN Offset);
+VOID DcModelFrame(VOID);
+
+#undef DISPLAY_A
+#define DISPLAY_A(off) (*DcModelAccess(off))
+
+#endif
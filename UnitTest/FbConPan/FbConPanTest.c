@@ -0,0 +1,164 @@
+/*
+ * Hardware-panned console: checks the pan/wrap arithmetic in FbConsole.h
+ * against PcdMipiFrameBufferVirtualHeight, and that FBCON_PAN_WINDOW makes
+ * the display controller scan out the new window from the next frame on.
+ *
+ * The scroll loop follows FbConScrollUp/FbConPanScroll: the shift is a
+ * whole number of text cells clamped to the text area, and the window wraps
+ * to the top when moving it would leave the virtual framebuffer.
+ */
+#include <Uefi.h>
+#include <Library/PcdLib.h>
+
+// NintendoSwitch.dsc
+#define _PCD_VALUE_PcdMipiFrameBufferAddress		0xdfb80000
+#define _PCD_VALUE_PcdMipiFrameBufferWidth			768
+#define _PCD_VALUE_PcdMipiFrameBufferHeight			1280
+#define _PCD_VALUE_PcdMipiFrameBufferPixelBpp		32
+#define _PCD_VALUE_PcdMipiFrameBufferVirtualHeight	1526
+
+#include <Resources/FbConsole.h>
+#include <Resources/font5x12.h>
+
+#include <HostTest.h>
+
+#include "DcModel.h"
+
+#define FB_BASE			FixedPcdGet32(PcdMipiFrameBufferAddress)
+#define FB_HEIGHT		FixedPcdGet32(PcdMipiFrameBufferHeight)
+#define VIRTUAL_HEIGHT	FixedPcdGet32(PcdMipiFrameBufferVirtualHeight)
+#define CELL_HEIGHT		(FONT_HEIGHT * SCALE_FACTOR)
+
+#define SCANOUT()		(mDcModel.Active[DC_X_WINBUF_XD_START_ADDR])
+
+STATIC UINT32 WindowAddress(UINTN PanRow)
+{
+	return (UINT32)(FB_BASE + PanRow * FBCON_ROW_BYTES);
+}
+
+STATIC VOID TestFitsBoundary(VOID)
+{
+	CHECK(FBCON_PAN_FITS(0, FB_HEIGHT));
+	CHECK(FBCON_PAN_FITS(VIRTUAL_HEIGHT - FB_HEIGHT, FB_HEIGHT));
+	CHECK(!FBCON_PAN_FITS(VIRTUAL_HEIGHT - FB_HEIGHT + 1, FB_HEIGHT));
+	CHECK(!FBCON_PAN_FITS(0, VIRTUAL_HEIGHT + 1));
+
+	// Must not wrap around for a PanRow left over from a corrupted block.
+	CHECK(!FBCON_PAN_FITS(0xffffffff, FB_HEIGHT));
+
+	// The control block and the grid sit right after the last line scanned out.
+	CHECK_EQ(FBCON_PAN_CONTROL_ADDRESS, WindowAddress(VIRTUAL_HEIGHT - FB_HEIGHT) + FB_HEIGHT * FBCON_ROW_BYTES);
+	CHECK_EQ(FBCON_PAN_CONTROL_ADDRESS % 4, 0);
+}
+
+STATIC VOID TestLatching(VOID)
+{
+	DcModelReset();
+	FBCON_PAN_WINDOW(WindowAddress(0));
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(0));
+
+	// A start address which is neither armed nor activated never shows.
+	DISPLAY_A(_DIREG(DC_X_WINBUF_XD_START_ADDR)) = WindowAddress(10);
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(0));
+
+	// Armed but not requested.
+	DISPLAY_A(_DIREG(DC_CMD_STATE_CONTROL)) = GENERAL_UPDATE | WIN_A_UPDATE;
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(0));
+
+	// Requested, it only becomes active with the next frame.
+	DISPLAY_A(_DIREG(DC_CMD_STATE_CONTROL)) = GENERAL_ACT_REQ | WIN_A_ACT_REQ;
+	DcModelSync();
+	CHECK_EQ(SCANOUT(), WindowAddress(0));
+	CHECK_EQ(DcModelRead(DC_CMD_STATE_CONTROL), GENERAL_ACT_REQ | WIN_A_ACT_REQ);
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(10));
+	CHECK_EQ(DcModelRead(DC_CMD_STATE_CONTROL), 0);
+
+	// Two pans within one frame: the frame shows the last one only.
+	FBCON_PAN_WINDOW(WindowAddress(20));
+	FBCON_PAN_WINDOW(WindowAddress(30));
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(30));
+
+	// With window A deselected the write goes nowhere.
+	DISPLAY_A(_DIREG(DC_CMD_DISPLAY_WINDOW_HEADER)) = 0;
+	DISPLAY_A(_DIREG(DC_X_WINBUF_XD_START_ADDR)) = WindowAddress(40);
+	DcModelSync();
+	CHECK_EQ(mDcModel.Errors, 1);
+	mDcModel.Errors = 0;
+
+	// FBCON_PAN_WINDOW selects the window itself.
+	FBCON_PAN_WINDOW(WindowAddress(50));
+	DcModelFrame();
+	CHECK_EQ(SCANOUT(), WindowAddress(50));
+	CHECK_EQ(mDcModel.Errors, 0);
+}
+
+STATIC VOID TestScroll(VOID)
+{
+	UINTN TextRows = (FB_HEIGHT / CELL_HEIGHT) * CELL_HEIGHT;
+	UINTN PanRow = 0;
+	UINTN SinceWrap = 0;
+	UINTN Wraps = 0;
+	UINT32 Seed = 1;
+	UINTN Step;
+
+	DcModelReset();
+	FBCON_PAN_WINDOW(WindowAddress(0));
+	DcModelFrame();
+
+	for (Step = 0; Step < 4000; Step++)
+	{
+		UINTN Lines;
+		UINTN Shift;
+		BOOLEAN Wrap;
+		UINT32 Previous = SCANOUT();
+
+		// Mostly single lines, sometimes a burst or a whole screen.
+		Seed = Seed * 1103515245 + 12345;
+		Lines = (Seed >> 16) % 16;
+		Lines = Lines < 12 ? 1 : Lines < 15 ? Lines - 10 : FB_HEIGHT;
+		Shift = Lines * CELL_HEIGHT;
+		if (Shift > TextRows) Shift = TextRows;
+
+		Wrap = PanRow + Shift + FB_HEIGHT > VIRTUAL_HEIGHT;
+		CHECK_EQ(FBCON_PAN_FITS(PanRow + Shift, FB_HEIGHT), !Wrap);
+
+		if (FBCON_PAN_FITS(PanRow + Shift, FB_HEIGHT))
+		{
+			PanRow += Shift;
+			SinceWrap += Shift;
+		}
+		else
+		{
+			// Only wrap when the window has really run out of room.
+			CHECK(SinceWrap + Shift > VIRTUAL_HEIGHT - FB_HEIGHT);
+			PanRow = 0;
+			SinceWrap = 0;
+			Wraps++;
+		}
+
+		CHECK(PanRow + FB_HEIGHT <= VIRTUAL_HEIGHT);
+		CHECK(WindowAddress(PanRow) + FB_HEIGHT * FBCON_ROW_BYTES <= FBCON_PAN_CONTROL_ADDRESS);
+
+		FBCON_PAN_WINDOW(WindowAddress(PanRow));
+		DcModelSync();
+		CHECK_EQ(SCANOUT(), Previous);
+		DcModelFrame();
+		CHECK_EQ(SCANOUT(), WindowAddress(PanRow));
+	}
+
+	CHECK(Wraps > 0);
+	CHECK_EQ(mDcModel.Errors, 0);
+}
+
+int main(void)
+{
+	TestFitsBoundary();
+	TestLatching();
+	TestScroll();
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,15 @@
+/*
+ * Host stand-in for ArmPkg AsmMacroIoLibV8.h, for AArch64 hosts building the
+ * package assembly kernels as they are.
+ */
+#ifndef __HOST_ASM_MACRO_IO_LIB_V8_H__
+#define __HOST_ASM_MACRO_IO_LIB_V8_H__
+
+#define ASM_FUNC(Name) \
+  .text ; \
+  .p2align 2 ; \
+  .global Name ; \
+  .type Name, %function ; \
+  Name:
+
+#endif
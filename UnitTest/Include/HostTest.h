@@ -0,0 +1,37 @@
+/*
+ * Minimal check helpers shared by the host unit tests. A failed check is
+ * reported with its location and makes the test exit non-zero, the run
+ * continues so that one report shows every failure.
+ */
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+
+static unsigned mHostTestFailures;
+
+#define CHECK(Expression) \
+	do { \
+		if (!(Expression)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", \
+				__FILE__, __LINE__, #Expression); \
+			mHostTestFailures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQ(Actual, Expected) \
+	do { \
+		unsigned long long _a = (unsigned long long)(Actual); \
+		unsigned long long _e = (unsigned long long)(Expected); \
+		if (_a != _e) { \
+			fprintf(stderr, "%s:%d: %s is 0x%llx, expected 0x%llx\n", \
+				__FILE__, __LINE__, #Actual, _a, _e); \
+			mHostTestFailures++; \
+		} \
+	} while (0)
+
+#define HOST_TEST_RESULT() \
+	(mHostTestFailures ? (fprintf(stderr, "%u check(s) failed\n", \
+		mHostTestFailures), 1) : 0)
+
+#endif
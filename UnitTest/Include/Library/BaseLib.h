@@ -0,0 +1,6 @@
+#ifndef __HOST_BASE_LIB_H__
+#define __HOST_BASE_LIB_H__
+
+#include <Uefi.h>
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __HOST_BASE_MEMORY_LIB_H__
+#define __HOST_BASE_MEMORY_LIB_H__
+
+#include <Uefi.h>
+
+static inline VOID *CopyMem(VOID *Destination, CONST VOID *Source, UINTN Length)
+{
+	return __builtin_memmove(Destination, Source, Length);
+}
+
+static inline VOID *SetMem(VOID *Buffer, UINTN Length, UINT8 Value)
+{
+	return __builtin_memset(Buffer, Value, Length);
+}
+
+static inline VOID *ZeroMem(VOID *Buffer, UINTN Length)
+{
+	return __builtin_memset(Buffer, 0, Length);
+}
+
+static inline INTN CompareMem(CONST VOID *Destination, CONST VOID *Source, UINTN Length)
+{
+	return __builtin_memcmp(Destination, Source, Length);
+}
+
+#endif
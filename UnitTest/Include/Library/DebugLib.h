@@ -0,0 +1,23 @@
+#ifndef __HOST_DEBUG_LIB_H__
+#define __HOST_DEBUG_LIB_H__
+
+#include <stdio.h>
+
+/*
+ * Not <assert.h>: the package's Shim/DebugLib.h maps assert() back onto
+ * ASSERT(). Not <stdlib.h> either, its lldiv() clashes with the one in
+ * Foundation/Types.h.
+ */
+void abort(void);
+
+#define ASSERT(Expression) \
+	do { \
+		if (!(Expression)) { \
+			fprintf(stderr, "%s:%d: ASSERT(%s)\n", __FILE__, __LINE__, \
+				#Expression); \
+			abort(); \
+		} \
+	} while (0)
+#define DEBUG(Expression)	do { } while (0)
+
+#endif
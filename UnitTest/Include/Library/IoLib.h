@@ -0,0 +1,15 @@
+/*
+ * Host stand-in for the MdePkg IoLib. Nothing is implemented here, a test
+ * which builds MMIO code defines the accessors it needs and records them.
+ */
+#ifndef __HOST_IO_LIB_H__
+#define __HOST_IO_LIB_H__
+
+UINT8 MmioRead8(UINTN Address);
+UINT8 MmioWrite8(UINTN Address, UINT8 Value);
+UINT16 MmioRead16(UINTN Address);
+UINT16 MmioWrite16(UINTN Address, UINT16 Value);
+UINT32 MmioRead32(UINTN Address);
+UINT32 MmioWrite32(UINTN Address, UINT32 Value);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for PcdLib. A test defines _PCD_VALUE_<Name> for every
+ * fixed or feature PCD the code under test reads, normally to the value
+ * NintendoSwitch.dsc sets.
+ */
+#ifndef __HOST_PCD_LIB_H__
+#define __HOST_PCD_LIB_H__
+
+#define FixedPcdGet32(TokenName)	_PCD_VALUE_##TokenName
+#define FixedPcdGet64(TokenName)	_PCD_VALUE_##TokenName
+#define FixedPcdGetBool(TokenName)	_PCD_VALUE_##TokenName
+#define FeaturePcdGet(TokenName)	_PCD_VALUE_##TokenName
+#define PcdGet32(TokenName)			_PCD_VALUE_##TokenName
+#define PcdGetBool(TokenName)		_PCD_VALUE_##TokenName
+
+#endif
@@ -0,0 +1,8 @@
+/*
+ * Host stand-in for the MdePkg UefiLib, only included for what the
+ * package shims pull in with it.
+ */
+#ifndef __HOST_UEFI_LIB_H__
+#define __HOST_UEFI_LIB_H__
+
+#endif
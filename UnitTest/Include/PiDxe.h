@@ -0,0 +1,6 @@
+#ifndef __HOST_PI_DXE_H__
+#define __HOST_PI_DXE_H__
+
+#include <Uefi.h>
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Host stand-in for the MdePkg base types, enough for the package sources
+ * built by the unit tests. Only LP64 hosts are supported.
+ */
+#ifndef __HOST_UEFI_H__
+#define __HOST_UEFI_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int8_t INT8;
+typedef int16_t INT16;
+typedef int32_t INT32;
+typedef int64_t INT64;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef intptr_t INTN;
+typedef uintptr_t UINTN;
+typedef unsigned char BOOLEAN;
+typedef char CHAR8;
+typedef uint16_t CHAR16;
+typedef void VOID;
+typedef UINTN EFI_STATUS;
+typedef UINT64 EFI_PHYSICAL_ADDRESS;
+
+_Static_assert(sizeof(UINTN) == 8, "Host tests expect an LP64 host");
+
+#define TRUE	((BOOLEAN)1)
+#define FALSE	((BOOLEAN)0)
+
+#define IN
+#define OUT
+#define OPTIONAL
+#define CONST	const
+#define STATIC	static
+#define EFIAPI
+
+#define MAX_UINTN	UINTN_MAX
+#define MAX_UINT32	UINT32_MAX
+
+#define BIT0	0x00000001
+#define BIT1	0x00000002
+#define BIT2	0x00000004
+#define BIT3	0x00000008
+
+#define SIGNATURE_16(A, B)	((A) | ((B) << 8))
+#define SIGNATURE_32(A, B, C, D) \
+	(SIGNATURE_16(A, B) | (SIGNATURE_16(C, D) << 16))
+
+#define MIN(a, b)	(((a) < (b)) ? (a) : (b))
+#define MAX(a, b)	(((a) > (b)) ? (a) : (b))
+
+#define STATIC_ASSERT	_Static_assert
+
+#define ARRAY_SIZE(Array)	(sizeof(Array) / sizeof((Array)[0]))
+
+#define ENCODE_ERROR(a)	((EFI_STATUS)(0x8000000000000000ULL | (a)))
+#define EFI_ERROR(a)	(((INTN)(EFI_STATUS)(a)) < 0)
+
+#define EFI_SUCCESS				0
+#define EFI_INVALID_PARAMETER	ENCODE_ERROR(2)
+#define EFI_UNSUPPORTED			ENCODE_ERROR(3)
+#define EFI_DEVICE_ERROR		ENCODE_ERROR(7)
+#define EFI_NOT_READY			ENCODE_ERROR(6)
+#define EFI_OUT_OF_RESOURCES	ENCODE_ERROR(9)
+#define EFI_TIMEOUT				ENCODE_ERROR(18)
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Host check of the Tegra210 clock enable and reset bank masks
+ * (Tegra210/periph_mask.c), used by HoldPeriphs and ReleasePeriphs.
+ *
+ * Every peripheral ID must land in exactly one bank, at bit ID % 32 of
+ * bank ID / 32, with the V/W words counted on from the L/H/U ones and X/Y
+ * after them. The masks must then reach the SET and CLR registers at the
+ * CLK_RST_CONTROLLER offsets from the TRM, once per bank, without reads.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <PiDxe.h>
+#include <Uefi.h>
+#include <Foundation/Types.h>
+#include <Protocol/Utc/Tegra210/Tegra.h>
+#include <Protocol/Utc/Tegra210/Clock.h>
+#include <Library/IoLib.h>
+
+#include <HostTest.h>
+
+#define MAX_WRITES		16
+
+typedef struct {
+	UINTN Offset;
+	UINT32 Value;
+} REG_WRITE;
+
+STATIC REG_WRITE mWrites[MAX_WRITES];
+STATIC UINTN mWriteCount;
+STATIC UINTN mReadCount;
+
+UINT32 MmioWrite32(UINTN Address, UINT32 Value)
+{
+	CHECK(mWriteCount < MAX_WRITES);
+	if (mWriteCount < MAX_WRITES)
+	{
+		mWrites[mWriteCount].Offset = Address - NV_PA_CLK_RST_BASE;
+		mWrites[mWriteCount].Value = Value;
+		mWriteCount++;
+	}
+	return Value;
+}
+
+UINT32 MmioRead32(UINTN Address)
+{
+	mReadCount++;
+	return 0;
+}
+
+/* CLK_RST_CONTROLLER_{CLK_ENB,RST_DEV}_<bank>_SET_0, CLR is the next word */
+STATIC CONST UINTN mEnableSet[PERIPH_BANK_COUNT] = {
+	0x320, 0x328, 0x330, 0x440, 0x448, 0x284, 0x29c
+};
+STATIC CONST UINTN mResetSet[PERIPH_BANK_COUNT] = {
+	0x300, 0x308, 0x310, 0x430, 0x438, 0x290, 0x2a8
+};
+
+STATIC VOID TestBanks(VOID)
+{
+	u32 Mask[PERIPH_BANK_COUNT];
+	int Id, Bank;
+
+	for (Id = PERIPH_ID_FIRST; Id < PERIPH_ID_COUNT; Id++)
+	{
+		memset(Mask, 0, sizeof(Mask));
+		periph_mask_add(Mask, Id);
+
+		for (Bank = 0; Bank < PERIPH_BANK_COUNT; Bank++)
+		{
+			if (Mask[Bank] != (Bank == Id / 32 ? 1u << (Id % 32) : 0))
+				fprintf(stderr, "peripheral %d: bank %d is 0x%x\n", Id, Bank, Mask[Bank]);
+			CHECK_EQ(Mask[Bank], Bank == Id / 32 ? 1u << (Id % 32) : 0);
+		}
+	}
+
+	// Named ones from the TRM, one per bank past U and the callers' own.
+	STATIC CONST struct {
+		int Id;
+		int Bank;
+		int Bit;
+	} Known[] = {
+		{ PERIPH_ID_SDMMC1,      PERIPH_BANK_L, 14 },
+		{ PERIPH_ID_USBD,        PERIPH_BANK_L, 22 },
+		{ PERIPH_ID_CPUG,        PERIPH_BANK_V, 0 },
+		{ PERIPH_ID_SATA,        PERIPH_BANK_V, 28 },
+		{ PERIPH_ID_XUSB_PADCTL, PERIPH_BANK_W, 14 },
+		{ PERIPH_ID_DVFS,        PERIPH_BANK_W, 27 },
+		{ PERIPH_ID_VIC,         PERIPH_BANK_X, 18 },
+		{ PERIPH_ID_GPU,         PERIPH_BANK_X, 24 },
+		{ PERIPH_ID_APE,         PERIPH_BANK_Y, 6 },
+		{ PERIPH_ID_QSPI,        PERIPH_BANK_Y, 19 },
+	};
+	UINTN Index;
+
+	for (Index = 0; Index < ARRAY_SIZE(Known); Index++)
+	{
+		memset(Mask, 0, sizeof(Mask));
+		periph_mask_add(Mask, Known[Index].Id);
+		CHECK_EQ(Mask[Known[Index].Bank], 1u << Known[Index].Bit);
+	}
+}
+
+STATIC REG_WRITE *FindWrite(UINTN Offset)
+{
+	UINTN Index;
+
+	for (Index = 0; Index < mWriteCount; Index++)
+		if (mWrites[Index].Offset == Offset)
+			return &mWrites[Index];
+	return NULL;
+}
+
+/* One bit per bank, each bank a different bit, through both directions */
+STATIC VOID TestRegisters(VOID)
+{
+	STATIC CONST struct {
+		VOID (*Write)(CONST UINT32 *Mask, int Enable);
+		CONST UINTN *Set;
+	} Kinds[] = {
+		{ clock_set_enable_mask, mEnableSet },
+		{ reset_set_enable_mask, mResetSet },
+	};
+	u32 Mask[PERIPH_BANK_COUNT];
+	UINTN Kind;
+	int Bank, Enable;
+
+	for (Bank = 0; Bank < PERIPH_BANK_COUNT; Bank++)
+	{
+		memset(Mask, 0, sizeof(Mask));
+		periph_mask_add(Mask, Bank * 32 + Bank + 3);
+
+		for (Kind = 0; Kind < ARRAY_SIZE(Kinds); Kind++)
+		{
+			for (Enable = 0; Enable <= 1; Enable++)
+			{
+				UINTN Offset = Kinds[Kind].Set[Bank] + (Enable ? 0 : 4);
+				REG_WRITE *Write;
+
+				mWriteCount = mReadCount = 0;
+				Kinds[Kind].Write(Mask, Enable);
+				Write = FindWrite(Offset);
+
+				CHECK_EQ(mWriteCount, 1);
+				CHECK_EQ(mReadCount, 0);
+				CHECK(Write != NULL);
+				if (Write == NULL)
+					fprintf(stderr, "bank %d: no write to 0x%lx\n", Bank, (unsigned long)Offset);
+				else
+					CHECK_EQ(Write->Value, 1u << (Bank + 3));
+			}
+		}
+	}
+
+	// A group: one write per bank it touches, nothing for the others.
+	STATIC CONST int Group[] = {
+		PERIPH_ID_SDMMC1, PERIPH_ID_USBD, PERIPH_ID_XUSB_PADCTL, PERIPH_ID_VIC, PERIPH_ID_QSPI
+	};
+	UINTN Index;
+
+	memset(Mask, 0, sizeof(Mask));
+	for (Index = 0; Index < ARRAY_SIZE(Group); Index++)
+		periph_mask_add(Mask, Group[Index]);
+
+	mWriteCount = mReadCount = 0;
+	reset_set_enable_mask(Mask, 1);
+	CHECK_EQ(mWriteCount, 4);
+	CHECK_EQ(mReadCount, 0);
+	CHECK(FindWrite(0x300) != NULL && FindWrite(0x300)->Value == (BIT(14) | BIT(22)));
+	CHECK(FindWrite(0x438) != NULL && FindWrite(0x438)->Value == BIT(14));
+	CHECK(FindWrite(0x290) != NULL && FindWrite(0x290)->Value == BIT(18));
+	CHECK(FindWrite(0x2a8) != NULL && FindWrite(0x2a8)->Value == BIT(19));
+
+	mWriteCount = 0;
+	memset(Mask, 0, sizeof(Mask));
+	clock_set_enable_mask(Mask, 1);
+	CHECK_EQ(mWriteCount, 0);
+}
+
+int main(void)
+{
+	TestBanks();
+	TestRegisters();
+	return HOST_TEST_RESULT();
+}